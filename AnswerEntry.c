@@ -0,0 +1,160 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Answer entry state machine and switch decoders. The decoders work on the switch bits
+ * directly (a power-of-two test and count-trailing-zeros, or a mask) instead of comparing
+ * against pow(2, i) for every switch.
+ */
+
+#include "AnswerEntry.h"
+
+#define SWITCH_MASK 0x3FFu   // SW0-SW9
+
+#define KEY_CONFIRM 0x01
+#define KEY_STEP    0x02
+#define KEY_NEXT    0x04
+#define KEY_SIGN    0x08
+
+// Active-high segments, gfedcba
+static const uint8_t digit_segments[10] = { 0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, 0x7F, 0x6F };
+#define SEGMENTS_MINUS 0x40
+#define SEGMENTS_E     0x79
+#define SEGMENTS_R     0x50
+
+/**
+ * Function: AnswerEntry_decodeOneHot
+ * Description: Decodes a single raised switch into its number
+ * Input(s): uint32_t switches - switch register value
+ * Return: int - 0 to 9, -1 unless exactly one switch is up
+ */
+int AnswerEntry_decodeOneHot(uint32_t switches) {
+    uint32_t bits = switches & SWITCH_MASK;
+    // Exactly one bit set: non-zero with no other bit left after clearing the lowest
+    int one_hot = (bits != 0) & ((bits & (bits - 1)) == 0);
+    return one_hot ? __builtin_ctz(bits | (1u << 31)) : -1;
+}
+
+/**
+ * Function: AnswerEntry_decodeBinary
+ * Description: Decodes SW0-SW9 as a binary number
+ * Input(s): uint32_t switches - switch register value
+ * Return: int - 0 to 1023
+ */
+int AnswerEntry_decodeBinary(uint32_t switches) {
+    return (int)(switches & SWITCH_MASK);
+}
+
+/**
+ * Function: AnswerEntry_maximum
+ * Description: Returns the largest answer a mode can enter
+ * Input(s): AnswerEntryMode mode
+ * Return: int - largest answer
+ */
+int AnswerEntry_maximum(AnswerEntryMode mode) {
+    return (mode == ANSWER_ENTRY_SWITCH) ? 9 : ANSWER_ENTRY_MAX;
+}
+
+/**
+ * Function: AnswerEntry_minimum
+ * Description: Returns the smallest answer a mode can enter
+ * Input(s): AnswerEntryMode mode
+ * Return: int - smallest answer
+ */
+int AnswerEntry_minimum(AnswerEntryMode mode) {
+    return (mode == ANSWER_ENTRY_SWITCH) ? 0 : ANSWER_ENTRY_MIN;
+}
+
+/**
+ * Function: AnswerEntry_begin
+ * Description: Clears the entry for a new question
+ * Input(s): AnswerEntry* entry, AnswerEntryMode mode
+ * Return: void
+ */
+void AnswerEntry_begin(AnswerEntry* entry, AnswerEntryMode mode) {
+    for (int i = 0; i < ANSWER_ENTRY_DIGIT_COUNT; i++) {
+        entry->digits[i] = 0;
+    }
+    entry->mode = mode;
+    entry->cursor = 0;
+    entry->negative = false;
+    entry->valid = (mode == ANSWER_ENTRY_DIGITS);
+    entry->blank = (mode == ANSWER_ENTRY_SWITCH);
+    entry->value = 0;
+}
+
+/**
+ * Function: AnswerEntry_update
+ * Description: Applies key presses and switches to the entry
+ * Input(s): AnswerEntry* entry, uint32_t pressed - keys newly pressed, uint32_t switches
+ * Return: bool - true when a valid answer has been confirmed
+ */
+bool AnswerEntry_update(AnswerEntry* entry, uint32_t pressed, uint32_t switches) {
+    int magnitude;
+
+    if (entry->mode != ANSWER_ENTRY_SWITCH && (pressed & KEY_SIGN)) {
+        entry->negative = !entry->negative;
+    }
+
+    switch (entry->mode) {
+        case ANSWER_ENTRY_SWITCH:
+            magnitude = AnswerEntry_decodeOneHot(switches);
+            break;
+        case ANSWER_ENTRY_BINARY:
+            magnitude = AnswerEntry_decodeBinary(switches);
+            break;
+        default:
+            if (pressed & KEY_STEP) {
+                entry->digits[entry->cursor] = (uint8_t)((entry->digits[entry->cursor] + 1) % 10);
+            }
+            if (pressed & KEY_NEXT) {
+                entry->cursor = (uint8_t)((entry->cursor + 1) % ANSWER_ENTRY_DIGIT_COUNT);
+            }
+            magnitude = entry->digits[0] + 10 * entry->digits[1] + 100 * entry->digits[2];
+            break;
+    }
+
+    entry->blank = (entry->mode == ANSWER_ENTRY_SWITCH) && (switches & SWITCH_MASK) == 0;
+    entry->value = entry->negative ? -magnitude : magnitude;
+    entry->valid = magnitude >= 0 &&
+                   entry->value >= AnswerEntry_minimum(entry->mode) &&
+                   entry->value <= AnswerEntry_maximum(entry->mode);
+    return entry->valid && (pressed & KEY_CONFIRM);
+}
+
+/**
+ * Function: AnswerEntry_preview
+ * Description: Builds the seven-segment preview: the number right aligned with its sign,
+ *              "Err" when it cannot be entered. While editing digits, the selected digit
+ *              is always shown, so the leading zero being edited is visible.
+ * Input(s): const AnswerEntry* entry, uint8_t segments[ANSWER_ENTRY_DISPLAYS] - filled in
+ * Return: void
+ */
+void AnswerEntry_preview(const AnswerEntry* entry, uint8_t segments[ANSWER_ENTRY_DISPLAYS]) {
+    int magnitude = entry->value < 0 ? -entry->value : entry->value;
+    int shown = 1;
+
+    for (int i = 0; i < ANSWER_ENTRY_DISPLAYS; i++) {
+        segments[i] = 0;
+    }
+    if (entry->blank) {
+        return;
+    }
+    if (!entry->valid) {
+        segments[2] = SEGMENTS_E;
+        segments[1] = SEGMENTS_R;
+        segments[0] = SEGMENTS_R;
+        return;
+    }
+
+    // Digits needed for the value, or up to the cursor when editing
+    for (int rest = magnitude / 10; rest; rest /= 10) shown++;
+    if (entry->mode == ANSWER_ENTRY_DIGITS && entry->cursor + 1 > shown) shown = entry->cursor + 1;
+
+    for (int i = 0; i < shown; i++) {
+        segments[i] = digit_segments[magnitude % 10];
+        magnitude /= 10;
+    }
+    if (entry->negative) {
+        segments[shown] = SEGMENTS_MINUS;
+    }
+}
@@ -0,0 +1,63 @@
+/*
+* AnswerEntry.h
+*
+* Numeric answer entry
+*
+* Turns the slide switches and push buttons into signed, multi-digit answers:
+*   ANSWER_ENTRY_SWITCH  - one switch up gives its number 0-9 (the original entry)
+*   ANSWER_ENTRY_BINARY  - SW0-SW9 are read as a binary number 0-1023, KEY3 toggles the sign
+*   ANSWER_ENTRY_DIGITS  - KEY1 steps the selected digit, KEY2 selects the next digit to
+*                          the left, KEY3 toggles the sign
+* In every mode KEY0 confirms. Answers outside ANSWER_ENTRY_MIN..ANSWER_ENTRY_MAX are
+* refused. The value being entered is previewed as seven-segment patterns for HEX0-HEX3.
+*/
+
+#ifndef ANSWERENTRY_H_
+#define ANSWERENTRY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum {
+    ANSWER_ENTRY_SWITCH,
+    ANSWER_ENTRY_BINARY,
+    ANSWER_ENTRY_DIGITS,
+    ANSWER_ENTRY_MODE_COUNT
+} AnswerEntryMode;
+
+// Range of answers that can be entered and previewed (sign plus three digits on HEX0-HEX3)
+#define ANSWER_ENTRY_MIN (-999)
+#define ANSWER_ENTRY_MAX 999
+
+#define ANSWER_ENTRY_DIGIT_COUNT 3
+#define ANSWER_ENTRY_DISPLAYS 4
+
+typedef struct {
+    AnswerEntryMode mode;
+    uint8_t digits[ANSWER_ENTRY_DIGIT_COUNT];  // Digit editing, least significant first
+    uint8_t cursor;                            // Digit being edited
+    bool negative;
+    bool valid;                                // value can be confirmed
+    bool blank;                                // Nothing entered yet (no switch up)
+    int value;                                 // Answer currently entered
+} AnswerEntry;
+
+// Start entering a new answer
+void AnswerEntry_begin(AnswerEntry* entry, AnswerEntryMode mode);
+
+// Apply newly pressed keys (bit n = KEYn) and the current switches. Returns true when
+// KEY0 confirms a valid answer, which is then in entry->value.
+bool AnswerEntry_update(AnswerEntry* entry, uint32_t pressed, uint32_t switches);
+
+// Seven-segment patterns previewing the entry, index 0 is HEX0
+void AnswerEntry_preview(const AnswerEntry* entry, uint8_t segments[ANSWER_ENTRY_DISPLAYS]);
+
+// Largest and smallest answers the mode can enter, for sizing questions
+int AnswerEntry_maximum(AnswerEntryMode mode);
+int AnswerEntry_minimum(AnswerEntryMode mode);
+
+// Switch decoders: branch-free bit logic, -1 when the pattern is not a valid answer
+int AnswerEntry_decodeOneHot(uint32_t switches);
+int AnswerEntry_decodeBinary(uint32_t switches);
+
+#endif
@@ -1,5 +1,7 @@
 #include "Images.h"
 
+#if !ASSETS_FROM_PACK // Otherwise read from the SD card asset pack
+
 const unsigned short zero[1600] ={
 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,   // 0x0010 (16) pixels
 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,   // 0x0020 (32) pixels
@@ -1061,3 +1063,5 @@ const unsigned short right[225] ={
 };
 
 const unsigned short *const Num[10] = {zero, one, two, three, four, five, six, seven, eight, nine};
+
+#endif
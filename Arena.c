@@ -0,0 +1,69 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Linear arena allocator. An allocation is an aligned bump of the used offset, so it is
+ * constant time and has no per-allocation header.
+ */
+
+#include "Arena.h"
+#include <string.h>
+
+/**
+ * Function: Arena_initialise
+ * Description: Sets up an empty arena over a block of memory
+ * Input(s): Arena* arena, void* memory, size_t size - bytes of memory
+ * Return: void
+ */
+void Arena_initialise(Arena* arena, void* memory, size_t size) {
+    arena->base = (uint8_t*)memory;
+    arena->size = memory ? size : 0;
+    arena->used = 0;
+    arena->peak = 0;
+}
+
+/**
+ * Function: Arena_alloc
+ * Description: Allocates zeroed, aligned memory from the arena
+ * Input(s): Arena* arena, size_t size - bytes wanted
+ * Return: void* - the memory, NULL if the arena is full
+ */
+void* Arena_alloc(Arena* arena, size_t size) {
+    size_t start = ARENA_ALIGN(arena->used);
+    if (start > arena->size || size > arena->size - start) {
+        return NULL;
+    }
+    arena->used = start + size;
+    if (arena->used > arena->peak) arena->peak = arena->used;
+    memset(arena->base + start, 0, size);
+    return arena->base + start;
+}
+
+/**
+ * Function: Arena_reset
+ * Description: Frees every allocation made from the arena
+ * Input(s): Arena* arena
+ * Return: void
+ */
+void Arena_reset(Arena* arena) {
+    arena->used = 0;
+}
+
+/**
+ * Function: Arena_used
+ * Description: Returns the bytes allocated from the arena
+ * Input(s): const Arena* arena
+ * Return: size_t - bytes used
+ */
+size_t Arena_used(const Arena* arena) {
+    return arena->used;
+}
+
+/**
+ * Function: Arena_peak
+ * Description: Returns the most bytes allocated from the arena at once
+ * Input(s): const Arena* arena
+ * Return: size_t - high-water mark in bytes
+ */
+size_t Arena_peak(const Arena* arena) {
+    return arena->peak;
+}
@@ -0,0 +1,46 @@
+/*
+* Arena.h
+*
+* Linear arena allocator
+*
+* Hands out memory from one block reserved at boot by bumping an offset. Individual
+* allocations are never freed; the whole arena is reset at once. Used for storage whose
+* size is only known from the configuration, so nothing is allocated from the heap
+* once the game is running.
+*/
+
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Alignment of every allocation
+#define ARENA_ALIGNMENT 8
+
+typedef struct {
+    uint8_t* base;
+    size_t size;
+    size_t used;
+    size_t peak;      // Most bytes ever allocated at once
+} Arena;
+
+// Round a size up to the arena alignment, for sizing an arena from its planned allocations
+#define ARENA_ALIGN(size) (((size) + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1))
+
+// Use size bytes of memory as an arena
+void Arena_initialise(Arena* arena, void* memory, size_t size);
+
+// Allocate zeroed memory, NULL if the arena is full
+void* Arena_alloc(Arena* arena, size_t size);
+
+// Release every allocation at once
+void Arena_reset(Arena* arena);
+
+// Bytes allocated so far
+size_t Arena_used(const Arena* arena);
+
+// Most bytes allocated at once since the arena was set up
+size_t Arena_peak(const Arena* arena);
+
+#endif
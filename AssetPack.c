@@ -0,0 +1,235 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Asset pack reader and its LRU cache. Cached assets are placed first-fit in one block
+ * of memory; when no gap is big enough the least recently used asset is evicted and the
+ * search repeated, so an asset no larger than the cache always finds room.
+ */
+
+#include "AssetPack.h"
+#include "Memory.h"
+#include "Worker.h"
+#include "Crc32.h"
+#include "FatFS/ff.h"
+#include <stdio.h>
+#include <string.h>
+
+#define ASSET_CACHE_BYTES MEMORY_ASSET_BYTES
+#define ASSET_CACHE_ALIGN 8
+
+typedef struct {
+    uint32_t offset;                // In the pack file
+    uint32_t size;
+    uint16_t format;
+    bool present;                   // Listed in the pack's index
+    bool cached;
+    uint32_t cache_offset;          // In the cache, while cached
+    uint32_t last_used;             // Use stamp for LRU replacement
+} AssetSlot;
+
+static const char* const asset_names[ASSET_COUNT] = {
+#define ASSET_NAME(name, width, height) #name,
+    ASSET_LIST(ASSET_NAME)
+#undef ASSET_NAME
+};
+
+static FIL* pack_file;
+static AssetSlot slots[ASSET_COUNT];
+static uint8_t* cache;
+static uint32_t cache_used;
+static uint32_t cache_peak;
+static uint32_t use_counter;
+static AssetPackStats stats;
+
+/*
+ * Function: gap_free
+ * Description: Tells whether size bytes at offset overlap no cached asset
+ */
+static bool gap_free(uint32_t offset, uint32_t size) {
+    if (offset > ASSET_CACHE_BYTES || size > ASSET_CACHE_BYTES - offset) return false;
+    for (int id = 0; id < ASSET_COUNT; id++) {
+        if (slots[id].cached && slots[id].cache_offset < offset + size &&
+            offset < slots[id].cache_offset + slots[id].size) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Function: find_space
+ * Description: First-fit search, trying the start of the cache and the end of each cached asset
+ */
+static bool find_space(uint32_t size, uint32_t* offset) {
+    uint32_t best = ASSET_CACHE_BYTES;
+
+    if (gap_free(0, size)) {
+        *offset = 0;
+        return true;
+    }
+    for (int id = 0; id < ASSET_COUNT; id++) {
+        if (!slots[id].cached) continue;
+        uint32_t candidate = (slots[id].cache_offset + slots[id].size + ASSET_CACHE_ALIGN - 1) & ~(uint32_t)(ASSET_CACHE_ALIGN - 1);
+        if (candidate < best && gap_free(candidate, size)) best = candidate;
+    }
+    *offset = best;
+    return best < ASSET_CACHE_BYTES;
+}
+
+/*
+ * Function: evict_oldest
+ * Description: Drops the least recently used asset from the cache, false if it is empty
+ */
+static bool evict_oldest(void) {
+    int oldest = -1;
+
+    for (int id = 0; id < ASSET_COUNT; id++) {
+        if (slots[id].cached && (oldest < 0 || slots[id].last_used < slots[oldest].last_used)) oldest = id;
+    }
+    if (oldest < 0) return false;
+    slots[oldest].cached = false;
+    cache_used -= slots[oldest].size;
+    stats.evictions++;
+    return true;
+}
+
+/**
+ * Function: AssetPack_open
+ * Description: Opens the pack, checks its header and index, and sets up the cache
+ * Input(s): const char* path
+ * Return: bool - true if the pack is usable
+ */
+bool AssetPack_open(const char* path) {
+    AssetPackHeader header;
+    AssetPackEntry entry;
+    UINT read_size = 0;
+    uint32_t crc = 0;
+    unsigned int found = 0;
+
+    memset(slots, 0, sizeof(slots));
+    if (!cache) cache = Memory_alloc(MEMORY_ASSETS, ASSET_CACHE_BYTES, "asset cache");
+    if (!pack_file) pack_file = Memory_fileAlloc(path);
+
+    if (f_open(pack_file, path, FA_READ) != FR_OK) {
+        printf("Asset pack %s not found, images will not be drawn\n", path);
+        return false;
+    }
+    if (f_read(pack_file, &header, sizeof(header), &read_size) != FR_OK || read_size != sizeof(header) ||
+        header.magic != ASSET_PACK_MAGIC || header.version != ASSET_PACK_VERSION) {
+        printf("Asset pack %s is not valid, ignoring it\n", path);
+        f_close(pack_file);
+        return false;
+    }
+
+    for (unsigned int i = 0; i < header.count; i++) {
+        if (f_read(pack_file, &entry, sizeof(entry), &read_size) != FR_OK || read_size != sizeof(entry)) break;
+        crc = Crc32_update(crc, &entry, sizeof(entry));
+        for (int id = 0; id < ASSET_COUNT; id++) {
+            if (strncmp(entry.name, asset_names[id], ASSET_NAME_LENGTH) == 0 && !slots[id].present &&
+                entry.size <= ASSET_CACHE_BYTES && entry.offset <= f_size(pack_file) &&
+                entry.size <= f_size(pack_file) - entry.offset) {
+                slots[id].offset = entry.offset;
+                slots[id].size = entry.size;
+                slots[id].format = entry.format;
+                slots[id].present = true;
+                found++;
+            }
+        }
+    }
+    if (crc != header.index_crc) {
+        printf("Asset pack %s index is corrupt, ignoring it\n", path);
+        memset(slots, 0, sizeof(slots));
+        f_close(pack_file);
+        return false;
+    }
+
+    printf("Asset pack: %u of %d images, %lu KB cache\n", found, ASSET_COUNT, (unsigned long)(ASSET_CACHE_BYTES / 1024));
+    return true;
+}
+
+/**
+ * Function: AssetPack_pixels
+ * Description: Returns an asset from the cache, reading it from the pack on a miss
+ * Input(s): AssetId id
+ * Return: const unsigned short* - pixels, NULL if the asset is missing or could not be read
+ */
+const unsigned short* AssetPack_pixels(AssetId id) {
+    AssetSlot* slot = &slots[id];
+    UINT read_size = 0;
+    uint32_t offset;
+    bool flushed = false;
+
+    stats.lookups++;
+    if (slot->cached) {
+        stats.hits++;
+        slot->last_used = ++use_counter;
+        return (const unsigned short*)(cache + slot->cache_offset);
+    }
+    stats.misses++;
+    if (!slot->present || (slot->format != ASSET_FORMAT_RGB565 && slot->format != ASSET_FORMAT_PIXELLZ)) {
+        stats.errors++;
+        return NULL;
+    }
+
+    while (!find_space(slot->size, &offset)) {
+        // The worker may still be drawing from an asset about to be overwritten
+        if (!flushed && Worker_running()) {
+            Worker_flushRender(NULL);
+            flushed = true;
+        }
+        if (!evict_oldest()) return NULL;
+    }
+    if (f_lseek(pack_file, slot->offset) != FR_OK ||
+        f_read(pack_file, cache + offset, slot->size, &read_size) != FR_OK || read_size != slot->size) {
+        stats.errors++;
+        return NULL;
+    }
+
+    stats.bytes_read += slot->size;
+    slot->cached = true;
+    slot->cache_offset = offset;
+    slot->last_used = ++use_counter;
+    cache_used += slot->size;
+    if (cache_used > cache_peak) cache_peak = cache_used;
+    return (const unsigned short*)(cache + offset);
+}
+
+/**
+ * Function: AssetPack_compressed
+ * Description: Finds the cached asset data points at and reports whether it is PixelLz compressed
+ * Input(s): const void* data - from AssetPack_pixels, uint32_t* size - set to the compressed bytes
+ * Return: bool - true for a compressed asset, false for raw pixels or data not from the cache
+ */
+bool AssetPack_compressed(const void* data, uint32_t* size) {
+    for (int id = 0; id < ASSET_COUNT; id++) {
+        if (slots[id].cached && (const uint8_t*)data == cache + slots[id].cache_offset) {
+            *size = slots[id].size;
+            return slots[id].format == ASSET_FORMAT_PIXELLZ;
+        }
+    }
+    return false;
+}
+
+/**
+ * Function: AssetPack_stats
+ * Description: Returns the cache counters
+ * Input(s): None
+ * Return: const AssetPackStats* - counters
+ */
+const AssetPackStats* AssetPack_stats(void) {
+    return &stats;
+}
+
+/**
+ * Function: AssetPack_report
+ * Description: Prints lookups, hits, misses, evictions and how full the cache has been
+ * Input(s): None
+ * Return: void
+ */
+void AssetPack_report(void) {
+    if (!cache) return;
+    printf("Assets: %lu lookups, %lu hits, %lu misses (%lu KB read), %lu evictions, %lu errors, cache %lu KB (peak %lu KB)\n",
+           (unsigned long)stats.lookups, (unsigned long)stats.hits, (unsigned long)stats.misses,
+           (unsigned long)(stats.bytes_read / 1024), (unsigned long)stats.evictions, (unsigned long)stats.errors,
+           (unsigned long)(cache_used / 1024), (unsigned long)(cache_peak / 1024));
+}
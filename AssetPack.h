@@ -0,0 +1,98 @@
+/*
+* AssetPack.h
+*
+* Image assets loaded from the SD card
+*
+* With ASSETS_FROM_PACK set (see Images.h), the screen, question and digit images are
+* not linked in but read from one pack file on the SD card when first drawn. The file
+* starts with a header and an index of name, offset, size, format and dimensions; each
+* asset is one f_lseek plus one f_read into a RAM cache carved from the asset memory
+* region. When an asset does not fit, the least recently used ones are evicted until it
+* does. A pointer from AssetPack_pixels stays valid until a later call misses the cache.
+*
+* Images are normally stored PixelLz compressed (PixelLz.h) and stay compressed in the
+* cache, so it holds several times more of them; AssetPack_compressed tells the drawing
+* code to decode such an image on its way to the LCD rather than copy it.
+*
+* File layout (little endian):
+*     AssetPackHeader
+*     AssetPackEntry[count]
+*     asset data, each at its entry's offset
+*
+* tools/make_asset_pack.c builds the file from the image sources.
+*/
+
+#ifndef ASSETPACK_H_
+#define ASSETPACK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ASSET_PACK_MAGIC   0x4B504147u  // "GAPK"
+#define ASSET_PACK_VERSION 2
+#define ASSET_NAME_LENGTH  16
+
+// Every image asset: name as in Images.h, width, height
+#define ASSET_LIST(X) \
+    X(StartScreenImg, 240, 320) X(SelectLevelImg, 240, 320) \
+    X(EasyQues_1, 208, 211) X(EasyQues_2, 208, 211) X(EasyQues_3, 208, 211) \
+    X(MedQues_1, 215, 120) X(MedQues_2, 215, 120) X(MedQues_3, 215, 121) \
+    X(HardQues_1, 215, 121) X(HardQues_2, 215, 121) X(HardQues_3, 215, 121) \
+    X(zero, 40, 40) X(one, 40, 40) X(two, 40, 40) X(three, 40, 40) X(four, 40, 40) \
+    X(five, 40, 40) X(six, 40, 40) X(seven, 40, 40) X(eight, 40, 40) X(nine, 40, 40) \
+    X(right, 15, 15) X(wrong, 15, 15) X(Contplaying, 214, 120) X(EndScreenImg, 170, 150)
+
+#define ASSET_ID(name, width, height) ASSET_##name,
+typedef enum { ASSET_LIST(ASSET_ID) ASSET_COUNT } AssetId;
+#undef ASSET_ID
+
+typedef enum { ASSET_FORMAT_RGB565, ASSET_FORMAT_PIXELLZ } AssetFormat;   // PixelLz.h
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;                 // Index entries
+    uint32_t index_crc;             // Crc32 of the index
+} AssetPackHeader;
+
+typedef struct {
+    char name[ASSET_NAME_LENGTH];   // Nul padded
+    uint32_t offset;                // From the start of the file
+    uint32_t size;                  // Bytes stored
+    uint16_t format;                // AssetFormat
+    uint16_t width;
+    uint16_t height;
+    uint16_t reserved;
+} AssetPackEntry;
+
+// Host tools define ASSETPACK_FORMAT_ONLY to use the file format without FatFS
+#ifndef ASSETPACK_FORMAT_ONLY
+
+typedef struct {
+    uint32_t lookups;
+    uint32_t hits;
+    uint32_t misses;                // Each one a read from the SD card
+    uint32_t evictions;
+    uint32_t bytes_read;
+    uint32_t errors;                // Missing assets, failed or short reads
+} AssetPackStats;
+
+// Open the pack and read its index; the cache takes the whole asset memory region
+bool AssetPack_open(const char* path);
+
+// Pixels of an asset, read into the cache on first use. NULL if the asset cannot be loaded.
+// For a compressed asset this is its PixelLz data, see AssetPack_compressed.
+const unsigned short* AssetPack_pixels(AssetId id);
+
+// True if data came from AssetPack_pixels for a compressed asset; size is set to its bytes
+bool AssetPack_compressed(const void* data, uint32_t* size);
+
+// Cache counters
+const AssetPackStats* AssetPack_stats(void);
+
+// Print the cache counters and fill
+void AssetPack_report(void);
+
+#endif
+
+#endif
@@ -0,0 +1,107 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Boot stage timing on the global timer, so the marks need nothing set up but the HAL.
+ */
+
+#include "Boot.h"
+#include "Trace.h"
+#include <stdio.h>
+
+typedef struct {
+    const char* name;
+    uint64_t end;        // Hal_globalCounts when the stage finished
+} BootStage;
+
+static BootStage stages[BOOT_STAGES_MAX];
+static unsigned int stage_count;
+static uint64_t boot_start;
+static uint64_t first_pixel;
+
+/*
+ * Function: counts_to_us
+ * Description: Converts global timer counts to microseconds
+ */
+static uint32_t counts_to_us(uint64_t counts) {
+    return (uint32_t)(counts * 1000000u / HAL_GLOBAL_HZ);
+}
+
+/*
+ * Function: print_ms
+ * Description: Prints microseconds as milliseconds with one decimal
+ */
+static void print_ms(uint32_t us) {
+    printf("%lu.%lums", (unsigned long)(us / 1000), (unsigned long)(us % 1000 / 100));
+}
+
+/**
+ * Function: Boot_start
+ * Description: Sets time zero of the boot and forgets any earlier marks
+ * Input(s): None
+ * Return: void
+ */
+void Boot_start(void) {
+    boot_start = Hal_globalCounts();
+    stage_count = 0;
+    first_pixel = 0;
+}
+
+/**
+ * Function: Boot_stage
+ * Description: Records the end of a stage and puts it on the trace
+ * Input(s): const char* name - what the stage did
+ * Return: void
+ */
+void Boot_stage(const char* name) {
+    uint64_t previous = stage_count ? stages[stage_count - 1].end : boot_start;
+
+    if (stage_count == BOOT_STAGES_MAX) return;
+    TRACE_SPAN(name, previous, stage_count);
+    stages[stage_count].name = name;
+    stages[stage_count].end = Hal_globalCounts();
+    stage_count++;
+}
+
+/**
+ * Function: Boot_firstPixel
+ * Description: Ends a "start screen" stage and records it as the time to first pixel
+ * Input(s): None
+ * Return: void
+ */
+void Boot_firstPixel(void) {
+    first_pixel = Hal_globalCounts();
+    Boot_stage("start screen");
+}
+
+/**
+ * Function: Boot_elapsedUs
+ * Description: Returns the time since Boot_start
+ * Input(s): None
+ * Return: uint32_t - microseconds
+ */
+uint32_t Boot_elapsedUs(void) {
+    return counts_to_us(Hal_globalCounts() - boot_start);
+}
+
+/**
+ * Function: Boot_report
+ * Description: Prints the duration of each stage, the time to first pixel and the boot total
+ * Input(s): None
+ * Return: void
+ */
+void Boot_report(void) {
+    uint64_t previous = boot_start;
+
+    printf("Boot:");
+    for (unsigned int i = 0; i < stage_count; i++) {
+        printf(" %s ", stages[i].name);
+        print_ms(counts_to_us(stages[i].end - previous));
+        printf(",");
+        previous = stages[i].end;
+    }
+    printf(" first pixel at ");
+    if (first_pixel) print_ms(counts_to_us(first_pixel - boot_start)); else printf("-");
+    printf(", ready at ");
+    print_ms(counts_to_us(previous - boot_start));
+    printf("\n");
+}
@@ -0,0 +1,34 @@
+/*
+* Boot.h
+*
+* Boot stage timing
+*
+* main marks the end of each start-up stage with Boot_stage and the moment the start
+* screen is on the LCD with Boot_firstPixel. Boot_report prints how long each stage
+* took and the time to first pixel, counted from Boot_start just after the timers come
+* up. Each stage is also recorded as a span on the event trace.
+*/
+
+#ifndef BOOT_H_
+#define BOOT_H_
+
+#include <stdint.h>
+
+#define BOOT_STAGES_MAX 12
+
+// Start counting, right after Hal_initialise
+void Boot_start(void);
+
+// End the stage running since the previous mark, name must be a string literal
+void Boot_stage(const char* name);
+
+// Mark the start screen as drawn
+void Boot_firstPixel(void);
+
+// Microseconds since Boot_start
+uint32_t Boot_elapsedUs(void);
+
+// Print every stage, the time to first pixel and the total
+void Boot_report(void);
+
+#endif
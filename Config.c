@@ -0,0 +1,154 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Configuration file reader. The whole file is read into a small buffer with one f_read
+ * and parsed in place; it is only used at boot.
+ */
+
+#include "Config.h"
+#include "FatFS/ff.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+// Largest configuration file read, the rest is ignored
+#define CONFIG_FILE_SIZE 1024
+
+typedef struct {
+    const char* key;
+    size_t offset;           // Field within GameConfig
+    uint32_t minimum;
+    uint32_t maximum;
+} ConfigKey;
+
+static const ConfigKey config_keys[] = {
+    { "easy_questions",     offsetof(GameConfig, questions_per_level[EASY]),   1, CONFIG_MAX_LEVEL_QUESTIONS },
+    { "medium_questions",   offsetof(GameConfig, questions_per_level[MEDIUM]), 1, CONFIG_MAX_LEVEL_QUESTIONS },
+    { "hard_questions",     offsetof(GameConfig, questions_per_level[HARD]),   1, CONFIG_MAX_LEVEL_QUESTIONS },
+    { "practice_questions", offsetof(GameConfig, practice_questions),          1, CONFIG_MAX_LEVEL_QUESTIONS },
+    { "countdown_seconds",  offsetof(GameConfig, countdown_seconds),           1, CONFIG_MAX_COUNTDOWN_SECONDS },
+    { "session_questions",  offsetof(GameConfig, session_questions),           0, 0xFFFFFFFFu },
+    { "answer_entry",       offsetof(GameConfig, answer_entry),                0, ANSWER_ENTRY_MODE_COUNT - 1 },
+    { "max_answer",         offsetof(GameConfig, max_answer),                  9, ANSWER_ENTRY_MAX },
+    { "input_trace",        offsetof(GameConfig, input_trace),                 0, REPLAY_MODE_COUNT - 1 },
+    { "trace_export",       offsetof(GameConfig, trace_export),                0, 1 },
+};
+
+#define CONFIG_KEY_COUNT (sizeof(config_keys) / sizeof(config_keys[0]))
+
+// Strip leading and trailing spaces and tabs in place
+static char* trim(char* text) {
+    char* end;
+    while (*text == ' ' || *text == '\t') text++;
+    end = text + strlen(text);
+    while (end > text && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) end--;
+    *end = '\0';
+    return text;
+}
+
+/*
+ * Function: parse_line
+ * Description: Applies one key=value line, returns false if it is malformed
+ */
+static bool parse_line(GameConfig* config, char* line) {
+    char* comment = strchr(line, '#');
+    char* equals;
+    char* key;
+    char* digits;
+    uint64_t value = 0;
+
+    if (comment) *comment = '\0';
+    line = trim(line);
+    if (*line == '\0') return true;
+
+    equals = strchr(line, '=');
+    if (!equals) return false;
+    *equals = '\0';
+    key = trim(line);
+    digits = trim(equals + 1);
+    if (*digits == '\0') return false;
+
+    for (char* c = digits; *c; c++) {
+        if (*c < '0' || *c > '9') return false;
+        if (value <= 0xFFFFFFFFu) value = value * 10 + (uint64_t)(*c - '0');
+    }
+
+    for (unsigned int i = 0; i < CONFIG_KEY_COUNT; i++) {
+        const ConfigKey* entry = &config_keys[i];
+        if (strcmp(key, entry->key) == 0) {
+            if (value < entry->minimum) value = entry->minimum;
+            if (value > entry->maximum) value = entry->maximum;
+            *(uint32_t*)((uint8_t*)config + entry->offset) = (uint32_t)value;
+            return true;
+        }
+    }
+    printf("Config: ignoring unknown key %s\n", key);
+    return true;
+}
+
+/**
+ * Function: Config_defaults
+ * Description: Sets the values the game used before it was configurable
+ * Input(s): GameConfig* config
+ * Return: void
+ */
+void Config_defaults(GameConfig* config) {
+    for (int i = 0; i < DIFFICULTY_COUNT; i++) {
+        config->questions_per_level[i] = 3;
+    }
+    config->practice_questions = 3;
+    config->countdown_seconds = 20;
+    config->session_questions = 0;
+    config->answer_entry = ANSWER_ENTRY_BINARY;
+    config->max_answer = 99;
+    config->input_trace = REPLAY_OFF;
+    config->trace_export = 0;
+}
+
+/**
+ * Function: Config_load
+ * Description: Reads key=value settings from a file on the SD card
+ * Input(s): GameConfig* config - updated, const char* path
+ * Return: bool - true if the file was read
+ */
+bool Config_load(GameConfig* config, const char* path) {
+    FIL file;
+    char text[CONFIG_FILE_SIZE + 1];
+    UINT read_size = 0;
+    int line_number = 1;
+
+    if (f_open(&file, path, FA_READ) != FR_OK) return false;
+    if (f_read(&file, text, CONFIG_FILE_SIZE, &read_size) != FR_OK) {
+        f_close(&file);
+        return false;
+    }
+    f_close(&file);
+    text[read_size] = '\0';
+
+    for (char* line = text; line; line_number++) {
+        char* next = strchr(line, '\n');
+        if (next) *next++ = '\0';
+        if (!parse_line(config, line)) {
+            printf("Config: %s line %d is not key=number, ignored\n", path, line_number);
+        }
+        line = next;
+    }
+    return true;
+}
+
+/**
+ * Function: Config_report
+ * Description: Prints the configuration in use
+ * Input(s): const GameConfig* config
+ * Return: void
+ */
+void Config_report(const GameConfig* config) {
+    static const char* const entry_names[ANSWER_ENTRY_MODE_COUNT] = { "one switch", "binary switches", "digit keys" };
+    printf("Config: %lu/%lu/%lu questions per level, %lu practice, %lus per question, session %lu questions%s\n",
+           (unsigned long)config->questions_per_level[EASY], (unsigned long)config->questions_per_level[MEDIUM],
+           (unsigned long)config->questions_per_level[HARD], (unsigned long)config->practice_questions,
+           (unsigned long)config->countdown_seconds, (unsigned long)config->session_questions,
+           config->session_questions ? "" : " (no limit)");
+    printf("Config: answers entered with %s, up to %lu\n", entry_names[config->answer_entry],
+           (unsigned long)config->max_answer);
+}
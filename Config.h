@@ -0,0 +1,56 @@
+/*
+* Config.h
+*
+* Game configuration
+*
+* Session length, answer time and question counts are read from a text file on the SD
+* card at boot, so they can be changed without recompiling. The file holds key=value
+* lines; '#' starts a comment and unknown keys are ignored. Example game.cfg:
+*
+*     # Exam style session
+*     easy_questions=50
+*     medium_questions=100
+*     hard_questions=100
+*     practice_questions=10
+*     countdown_seconds=30
+*     session_questions=250
+*     answer_entry=2
+*     max_answer=200
+*     input_trace=1
+*     trace_export=1
+*/
+
+#ifndef CONFIG_H_
+#define CONFIG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "Questions.h"
+#include "AnswerEntry.h"
+#include "Replay.h"
+
+// Limits; values outside them are clamped
+#define CONFIG_MAX_LEVEL_QUESTIONS 1000
+#define CONFIG_MAX_COUNTDOWN_SECONDS 99   // Two seven-segment digits
+
+typedef struct {
+    uint32_t questions_per_level[DIFFICULTY_COUNT];  // Questions in one level of each difficulty
+    uint32_t practice_questions;                     // Questions in one practice level
+    uint32_t countdown_seconds;                      // Time allowed per question
+    uint32_t session_questions;                      // Questions before the game ends, 0 for no limit
+    uint32_t answer_entry;                           // AnswerEntryMode for Medium and Hard answers
+    uint32_t max_answer;                             // Largest generated answer, if the entry mode allows it
+    uint32_t input_trace;                            // ReplayMode: record inputs, or replay a recorded session
+    uint32_t trace_export;                           // 1 writes the event trace as Chrome JSON at game over
+} GameConfig;
+
+// Fill in the built-in defaults
+void Config_defaults(GameConfig* config);
+
+// Read a configuration file over the current values. Returns false if it could not be read.
+bool Config_load(GameConfig* config, const char* path);
+
+// Print the configuration
+void Config_report(const GameConfig* config);
+
+#endif
@@ -0,0 +1,30 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Reflected CRC-32, polynomial 0xEDB88320, processed a nibble at a time.
+ */
+
+#include "Crc32.h"
+
+static const uint32_t crc_nibble[16] = {
+    0x00000000u, 0x1DB71064u, 0x3B6E20C8u, 0x26D930ACu, 0x76DC4190u, 0x6B6B51F4u, 0x4DB26158u, 0x5005713Cu,
+    0xEDB88320u, 0xF00F9344u, 0xD6D6A3E8u, 0xCB61B38Cu, 0x9B64C2B0u, 0x86D3D2D4u, 0xA00AE278u, 0xBDBDF21Cu
+};
+
+/**
+ * Function: Crc32_update
+ * Description: Adds data to a running CRC
+ * Input(s): uint32_t crc - 0 or the result of a previous call, const void* data, size_t length
+ * Return: uint32_t - CRC of everything so far
+ */
+uint32_t Crc32_update(uint32_t crc, const void* data, size_t length) {
+    const uint8_t* bytes = (const uint8_t*)data;
+
+    crc = ~crc;
+    while (length--) {
+        crc ^= *bytes++;
+        crc = (crc >> 4) ^ crc_nibble[crc & 0x0F];
+        crc = (crc >> 4) ^ crc_nibble[crc & 0x0F];
+    }
+    return ~crc;
+}
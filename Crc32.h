@@ -0,0 +1,19 @@
+/*
+* Crc32.h
+*
+* CRC-32 (IEEE 802.3, as used by zip and PNG)
+*
+* Detects torn or corrupted records in files written to the SD card. A 16 entry table
+* is used, trading some speed for 64 bytes of constants instead of 1KB.
+*/
+
+#ifndef CRC32_H_
+#define CRC32_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Continue a CRC over more data. Start with crc = 0; the result of one call can be passed to the next.
+uint32_t Crc32_update(uint32_t crc, const void* data, size_t length);
+
+#endif
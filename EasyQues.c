@@ -1,5 +1,7 @@
 #include "Images.h"
 
+#if !ASSETS_FROM_PACK // Otherwise read from the SD card asset pack
+
 const unsigned short EasyQues_1[43888] = {
 		0xFE2E, 0xFE2E, 0xFE2E, 0xFE2E, 0xFE2E, 0xFE2E, 0xEDEF, 0xEDEF, 0xEDEF, 0xE5CF, 0xE5CF, 0xE5CF, 0xE5CF, 0xE5CF, 0xE5CF, 0xE5CF,   // 0x0010 (16) pixels
 		0xE5CF, 0xE5CF, 0xE5CF, 0xE5CF, 0xE5CF, 0xE5CF, 0xE5CF, 0xE5CF, 0xE5CF, 0xE5CF, 0xE5CF, 0xE5CF, 0xE5CF, 0xE5CF, 0xE5CF, 0xE5CF,   // 0x0020 (32) pixels
@@ -8238,3 +8240,5 @@ const unsigned short EasyQues_3[43888] = {
 		0xDDCF, 0xEDEF, 0xD56E, 0xE611, 0xEDEF, 0xD56E, 0xE611, 0xEDEF, 0xD56E, 0xE611, 0xD56E, 0xEDEF, 0xE611, 0xEDEF, 0xD56E, 0xE611,   // 0xAB60 (43872) pixels
 		0xEDEF, 0xD56E, 0xE5CF, 0xEDEF, 0xE5CF, 0xEDEF, 0xE611, 0xD56E, 0xEDEF, 0xFE2E, 0xFE2E, 0xFE2E, 0xFE2E, 0xFE2E, 0xFE2E, 0xFE2E,   // 0xAB70 (43888) pixels
 		};
+
+#endif
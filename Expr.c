@@ -0,0 +1,452 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Formula compiler and evaluator. A recursive descent parser emits postfix bytecode: one
+ * byte per operator, two for a constant (opcode and constant pool index). The evaluator
+ * is a single loop over the bytecode with a fixed stack of dual numbers (value and
+ * derivative with respect to x), so d() needs no symbolic differentiation: x carries a
+ * derivative of one inside d() and every operator applies its derivative rule alongside
+ * its value. Integer and fixed-point evaluation share the loop and differ only in how
+ * constants are scaled and how multiply and divide are done.
+ */
+
+#include "Expr.h"
+#include <string.h>
+
+#define EXPR_MAX_NESTING 16   // Bracket depth accepted by the parser
+
+typedef enum {
+    OP_CONST,    // Followed by a constant pool index
+    OP_X,
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_MOD,
+    OP_POW,
+    OP_NEG,
+    OP_SETX,     // Pop the point of a d(), x = point with derivative one
+    OP_DERIV     // Replace the top value by its derivative and restore x
+} ExprOp;
+
+typedef struct {
+    const char* start;
+    const char* p;
+    ExprProgram* program;
+    ExprStatus status;
+    int depth;            // Values on the stack at this point of the program
+    int nesting;
+    bool in_derivative;
+} ExprParser;
+
+typedef struct {
+    int64_t value;
+    int64_t slope;        // Derivative with respect to x
+} ExprValue;
+
+/*
+ * Compiler
+ */
+static void skip_spaces(ExprParser* parser) {
+    while (*parser->p == ' ' || *parser->p == '\t') parser->p++;
+}
+
+static bool fail(ExprParser* parser, ExprStatus status) {
+    if (parser->status == EXPR_OK) parser->status = status;
+    return false;
+}
+
+/*
+ * Function: emit
+ * Description: Appends an opcode and tracks how deep the stack gets
+ */
+static bool emit(ExprParser* parser, ExprOp op, int stack_change) {
+    ExprProgram* program = parser->program;
+
+    if (program->length >= EXPR_MAX_CODE) return fail(parser, EXPR_TOO_COMPLEX);
+    program->code[program->length++] = (uint8_t)op;
+    parser->depth += stack_change;
+    if (parser->depth > EXPR_MAX_STACK) return fail(parser, EXPR_TOO_COMPLEX);
+    if (parser->depth > program->max_stack) program->max_stack = (uint8_t)parser->depth;
+    return true;
+}
+
+static bool emit_constant(ExprParser* parser, int32_t value) {
+    ExprProgram* program = parser->program;
+    int index = 0;
+
+    while (index < program->constant_count && program->constants[index] != value) index++;
+    if (index == program->constant_count) {
+        if (program->constant_count >= EXPR_MAX_CONSTANTS) return fail(parser, EXPR_TOO_COMPLEX);
+        program->constants[program->constant_count++] = value;
+    }
+    if (!emit(parser, OP_CONST, 1)) return false;
+    if (program->length >= EXPR_MAX_CODE) return fail(parser, EXPR_TOO_COMPLEX);
+    program->code[program->length++] = (uint8_t)index;
+    return true;
+}
+
+static bool parse_sum(ExprParser* parser);
+static bool parse_unary(ExprParser* parser);
+
+/*
+ * Function: parse_derivative
+ * Description: d(expression, point). The point is compiled after the expression, then
+ *              moved in front of it so x is set before the expression runs.
+ */
+static bool parse_derivative(ExprParser* parser) {
+    ExprProgram* program = parser->program;
+    uint8_t expression[EXPR_MAX_CODE];
+    uint8_t expression_start, expression_length, point_length;
+
+    if (parser->in_derivative) return fail(parser, EXPR_SYNTAX);
+    parser->in_derivative = true;
+    expression_start = program->length;
+    if (!parse_sum(parser)) return false;
+    skip_spaces(parser);
+    if (*parser->p != ',') return fail(parser, EXPR_SYNTAX);
+    parser->p++;
+    parser->in_derivative = false;
+    expression_length = program->length - expression_start;
+
+    if (!parse_sum(parser)) return false;
+    skip_spaces(parser);
+    if (*parser->p != ')') return fail(parser, EXPR_SYNTAX);
+    parser->p++;
+    point_length = program->length - expression_start - expression_length;
+
+    // [expression][point] becomes [point] SETX [expression] DERIV
+    if (program->length + 2 > EXPR_MAX_CODE) return fail(parser, EXPR_TOO_COMPLEX);
+    memcpy(expression, &program->code[expression_start], expression_length);
+    memmove(&program->code[expression_start], &program->code[expression_start + expression_length], point_length);
+    program->code[expression_start + point_length] = OP_SETX;
+    memcpy(&program->code[expression_start + point_length + 1], expression, expression_length);
+    program->length += 1;
+    parser->depth -= 1;
+    return emit(parser, OP_DERIV, 0);
+}
+
+/*
+ * Function: parse_primary
+ * Description: number | x | ( sum ) | d( sum , sum )
+ */
+static bool parse_primary(ExprParser* parser) {
+    skip_spaces(parser);
+
+    if (*parser->p >= '0' && *parser->p <= '9') {
+        int64_t value = 0;
+        while (*parser->p >= '0' && *parser->p <= '9') {
+            value = value * 10 + (*parser->p++ - '0');
+            if (value > INT32_MAX) return fail(parser, EXPR_OVERFLOW);
+        }
+        return emit_constant(parser, (int32_t)value);
+    }
+    if (*parser->p == 'x') {
+        parser->p++;
+        return emit(parser, OP_X, 1);
+    }
+    if (*parser->p == 'd' && parser->p[1] == '(') {
+        parser->p += 2;
+        return parse_derivative(parser);
+    }
+    if (*parser->p == '(') {
+        if (++parser->nesting > EXPR_MAX_NESTING) return fail(parser, EXPR_TOO_COMPLEX);
+        parser->p++;
+        if (!parse_sum(parser)) return false;
+        skip_spaces(parser);
+        if (*parser->p != ')') return fail(parser, EXPR_SYNTAX);
+        parser->p++;
+        parser->nesting--;
+        return true;
+    }
+    return fail(parser, EXPR_SYNTAX);
+}
+
+// power := primary [ '^' unary ], right associative
+static bool parse_power(ExprParser* parser) {
+    if (!parse_primary(parser)) return false;
+    skip_spaces(parser);
+    if (*parser->p != '^') return true;
+    parser->p++;
+    return parse_unary(parser) && emit(parser, OP_POW, -1);
+}
+
+// unary := '-' unary | '+' unary | power
+static bool parse_unary(ExprParser* parser) {
+    skip_spaces(parser);
+    if (*parser->p == '-' || *parser->p == '+') {
+        bool negate = (*parser->p == '-');
+        if (++parser->nesting > EXPR_MAX_NESTING) return fail(parser, EXPR_TOO_COMPLEX);
+        parser->p++;
+        if (!parse_unary(parser)) return false;
+        parser->nesting--;
+        return !negate || emit(parser, OP_NEG, 0);
+    }
+    return parse_power(parser);
+}
+
+// product := unary { ('*' | '/' | '%' | implicit) unary }
+static bool parse_product(ExprParser* parser) {
+    if (!parse_unary(parser)) return false;
+    for (;;) {
+        ExprOp op;
+        skip_spaces(parser);
+        switch (*parser->p) {
+        case '*': op = OP_MUL; parser->p++; break;
+        case '/': op = OP_DIV; parser->p++; parser->program->divides = true; break;
+        case '%': op = OP_MOD; parser->p++; break;
+        case 'x': case '(': case 'd': op = OP_MUL; break;   // 3x, 2(x + 1)
+        default: return true;
+        }
+        if (!parse_unary(parser) || !emit(parser, op, -1)) return false;
+    }
+}
+
+// sum := product { ('+' | '-') product }
+static bool parse_sum(ExprParser* parser) {
+    if (!parse_product(parser)) return false;
+    for (;;) {
+        ExprOp op;
+        skip_spaces(parser);
+        if (*parser->p == '+') op = OP_ADD;
+        else if (*parser->p == '-') op = OP_SUB;
+        else return true;
+        parser->p++;
+        if (!parse_product(parser) || !emit(parser, op, -1)) return false;
+    }
+}
+
+/**
+ * Function: Expr_compile
+ * Description: Compiles a formula into bytecode
+ * Input(s): const char* text, ExprProgram* program - filled in, int* error_position - may be NULL
+ * Return: ExprStatus - EXPR_OK if the formula compiled
+ */
+ExprStatus Expr_compile(const char* text, ExprProgram* program, int* error_position) {
+    ExprParser parser = { text, text, program, EXPR_OK, 0, 0, false };
+
+    memset(program, 0, sizeof(*program));
+    if (parse_sum(&parser)) {
+        skip_spaces(&parser);
+        if (*parser.p == '=') {
+            parser.p++;
+            program->equation = true;
+            if (parse_sum(&parser)) emit(&parser, OP_SUB, -1);
+            skip_spaces(&parser);
+        }
+        if (parser.status == EXPR_OK && *parser.p != '\0') fail(&parser, EXPR_SYNTAX);
+    }
+
+    // Without an equation x has no value, so it may only appear inside d()
+    if (parser.status == EXPR_OK && !program->equation) {
+        bool in_derivative = false;
+        for (int i = 0; i < program->length; i++) {
+            if (program->code[i] == OP_CONST) i++;
+            else if (program->code[i] == OP_SETX) in_derivative = true;
+            else if (program->code[i] == OP_DERIV) in_derivative = false;
+            else if (program->code[i] == OP_X && !in_derivative) fail(&parser, EXPR_SYNTAX);
+        }
+    }
+
+    if (error_position) *error_position = (int)(parser.p - parser.start);
+    if (parser.status != EXPR_OK) program->length = 0;
+    return parser.status;
+}
+
+/*
+ * Evaluator
+ */
+static ExprStatus multiply(int64_t a, int64_t b, bool fixed, int64_t* result) {
+    if (__builtin_mul_overflow(a, b, result)) return EXPR_OVERFLOW;
+    if (fixed) *result >>= EXPR_FIXED_SHIFT;
+    return EXPR_OK;
+}
+
+static ExprStatus divide(int64_t a, int64_t b, bool fixed, int64_t* result) {
+    if (b == 0) return EXPR_DIV_ZERO;
+    if (b == -1 && a == INT64_MIN) return EXPR_OVERFLOW;
+    if (fixed) {
+        if (__builtin_mul_overflow(a, EXPR_FIXED_ONE, &a)) return EXPR_OVERFLOW;
+    } else if (a % b != 0) {
+        return EXPR_INEXACT;
+    }
+    *result = a / b;
+    return EXPR_OK;
+}
+
+/*
+ * Function: power
+ * Description: base^exponent with the derivative n * base^(n-1) * base'
+ */
+static ExprStatus power(ExprValue* base, const ExprValue* exponent, bool fixed) {
+    int64_t one = fixed ? EXPR_FIXED_ONE : 1;
+    int64_t n = exponent->value;
+    int64_t value = one, below = 0;   // base^n and base^(n-1)
+    ExprStatus status = EXPR_OK;
+
+    if (exponent->slope != 0) return EXPR_DOMAIN;
+    if (fixed) {
+        if (n & (EXPR_FIXED_ONE - 1)) return EXPR_DOMAIN;
+        n >>= EXPR_FIXED_SHIFT;
+    }
+    if (n < 0 || n > EXPR_MAX_POWER) return EXPR_DOMAIN;
+
+    for (int64_t i = 0; i < n && status == EXPR_OK; i++) {
+        below = value;
+        status = multiply(value, base->value, fixed, &value);
+    }
+    if (status == EXPR_OK && n > 0) {
+        status = multiply(below, base->slope, fixed, &below);
+        if (status == EXPR_OK && __builtin_mul_overflow(below, n, &below)) status = EXPR_OVERFLOW;
+    }
+    base->value = value;
+    base->slope = (n > 0) ? below : 0;
+    return status;
+}
+
+/*
+ * Function: evaluate
+ * Description: Runs the bytecode in integer or fixed-point arithmetic
+ */
+static ExprStatus evaluate(const ExprProgram* program, int64_t x, bool fixed, int64_t* result) {
+    ExprValue stack[EXPR_MAX_STACK];
+    unsigned int depth = 0;           // Values on the stack; the compiler bounds it by max_stack
+    int64_t one = fixed ? EXPR_FIXED_ONE : 1;
+    int64_t x_slope = 0, saved_x = x;
+    ExprStatus status = EXPR_OK;
+
+    if (program->length == 0) return EXPR_SYNTAX;
+
+    for (const uint8_t* pc = program->code; pc < program->code + program->length && status == EXPR_OK; pc++) {
+        // Top two values, formed only from valid indices so no pointer leaves the array
+        ExprValue* b = &stack[(depth > 0) ? depth - 1 : 0];
+        ExprValue* a = &stack[(depth > 1) ? depth - 2 : 0];
+        ExprValue* top;
+        int64_t t1, t2;
+
+        switch ((ExprOp)*pc) {
+        case OP_CONST:
+            top = &stack[depth++];
+            top->value = fixed ? (int64_t)program->constants[*++pc] * EXPR_FIXED_ONE : program->constants[*++pc];
+            top->slope = 0;
+            break;
+        case OP_X:
+            top = &stack[depth++];
+            top->value = x;
+            top->slope = x_slope;
+            break;
+        case OP_ADD:
+            if (__builtin_add_overflow(a->value, b->value, &a->value) ||
+                __builtin_add_overflow(a->slope, b->slope, &a->slope)) status = EXPR_OVERFLOW;
+            depth--;
+            break;
+        case OP_SUB:
+            if (__builtin_sub_overflow(a->value, b->value, &a->value) ||
+                __builtin_sub_overflow(a->slope, b->slope, &a->slope)) status = EXPR_OVERFLOW;
+            depth--;
+            break;
+        case OP_MUL:
+            // (ab)' = a'b + ab'
+            if ((status = multiply(a->slope, b->value, fixed, &t1)) != EXPR_OK ||
+                (status = multiply(a->value, b->slope, fixed, &t2)) != EXPR_OK ||
+                (status = multiply(a->value, b->value, fixed, &a->value)) != EXPR_OK) break;
+            if (__builtin_add_overflow(t1, t2, &a->slope)) status = EXPR_OVERFLOW;
+            depth--;
+            break;
+        case OP_DIV:
+            // (a/b)' = (a' - (a/b)b') / b
+            if ((status = divide(a->value, b->value, fixed, &a->value)) != EXPR_OK ||
+                (status = multiply(a->value, b->slope, fixed, &t1)) != EXPR_OK) break;
+            if (__builtin_sub_overflow(a->slope, t1, &t2)) status = EXPR_OVERFLOW;
+            else status = divide(t2, b->value, fixed, &a->slope);
+            depth--;
+            break;
+        case OP_MOD:
+            if (a->slope || b->slope) status = EXPR_DOMAIN;
+            else if (fixed && ((a->value | b->value) & (EXPR_FIXED_ONE - 1))) status = EXPR_DOMAIN;
+            else if (b->value == 0) status = EXPR_DIV_ZERO;
+            else a->value = (b->value == -one) ? 0 : a->value % b->value;
+            depth--;
+            break;
+        case OP_POW:
+            status = power(a, b, fixed);
+            depth--;
+            break;
+        case OP_NEG:
+            if (__builtin_sub_overflow((int64_t)0, b->value, &b->value) ||
+                __builtin_sub_overflow((int64_t)0, b->slope, &b->slope)) status = EXPR_OVERFLOW;
+            break;
+        case OP_SETX:
+            saved_x = x;
+            x = b->value;
+            x_slope = one;
+            depth--;
+            break;
+        case OP_DERIV:
+            b->value = b->slope;
+            b->slope = 0;
+            x = saved_x;
+            x_slope = 0;
+            break;
+        default:
+            status = EXPR_SYNTAX;
+            break;
+        }
+    }
+
+    if (status == EXPR_OK) *result = stack[0].value;
+    return status;
+}
+
+/**
+ * Function: Expr_evalInt
+ * Description: Evaluates a compiled formula with 64-bit integers
+ * Input(s): const ExprProgram* program, int64_t x, int64_t* result - filled in
+ * Return: ExprStatus - EXPR_OK, or why the formula has no integer value
+ */
+ExprStatus Expr_evalInt(const ExprProgram* program, int64_t x, int64_t* result) {
+    return evaluate(program, x, false, result);
+}
+
+/**
+ * Function: Expr_evalFixed
+ * Description: Evaluates a compiled formula in fixed point with 16 fractional bits
+ * Input(s): const ExprProgram* program, int64_t x - fixed point, int64_t* result - fixed point, filled in
+ * Return: ExprStatus - EXPR_OK, or why the formula has no value
+ */
+ExprStatus Expr_evalFixed(const ExprProgram* program, int64_t x, int64_t* result) {
+    return evaluate(program, x, true, result);
+}
+
+/**
+ * Function: Expr_verify
+ * Description: Checks an answer against a formula
+ * Input(s): const ExprProgram* program, int32_t answer, bool* correct - filled in
+ * Return: ExprStatus - EXPR_OK if the formula could be evaluated
+ */
+ExprStatus Expr_verify(const ExprProgram* program, int32_t answer, bool* correct) {
+    int64_t x = program->equation ? answer : 0;
+    int64_t expected = program->equation ? 0 : answer;
+    int64_t value = 0;
+    ExprStatus status = Expr_evalInt(program, x, &value);
+
+    if (status == EXPR_INEXACT) {
+        status = Expr_evalFixed(program, x * EXPR_FIXED_ONE, &value);
+        expected *= EXPR_FIXED_ONE;
+    }
+    *correct = (status == EXPR_OK) && value == expected;
+    return status;
+}
+
+/**
+ * Function: Expr_statusText
+ * Description: Describes a status for error messages
+ * Input(s): ExprStatus status
+ * Return: const char* - description
+ */
+const char* Expr_statusText(ExprStatus status) {
+    static const char* const text[] = {
+        "ok", "syntax error", "too complex", "division by zero", "overflow", "inexact division", "domain error"
+    };
+    return ((unsigned)status < sizeof(text) / sizeof(text[0])) ? text[status] : "unknown";
+}
@@ -0,0 +1,71 @@
+/*
+* Expr.h
+*
+* Question formula compiler and evaluator
+*
+* Question answers are checked against a small formula instead of being trusted as
+* typed. A formula is compiled once into stack bytecode and can then be evaluated many
+* times in 64-bit integer or fixed-point arithmetic (Q16.16 scaling held in 64 bits, so
+* large intermediate values do not overflow).
+*
+* Formula syntax:
+*     6*7 + 2            integers, + - * / % ^, unary minus, brackets
+*     3x^2 - 2x          x is the unknown, a number before x or '(' multiplies
+*     3x + 2 = 17        an equation: the answer is the value of x that satisfies it
+*     d(4x^3, 2)         derivative with respect to x, evaluated at x = 2
+* Without '=' the formula's value is the answer. '^' takes a non-negative integer
+* exponent and binds tighter than unary minus, so -x^2 is -(x^2).
+*/
+
+#ifndef EXPR_H_
+#define EXPR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define EXPR_MAX_CODE      64    // Bytecode bytes
+#define EXPR_MAX_CONSTANTS 16
+#define EXPR_MAX_STACK     16
+#define EXPR_MAX_POWER     63    // Largest exponent of '^'
+
+// Q16.16 fixed point
+#define EXPR_FIXED_SHIFT 16
+#define EXPR_FIXED_ONE   ((int64_t)1 << EXPR_FIXED_SHIFT)
+
+typedef enum {
+    EXPR_OK,
+    EXPR_SYNTAX,        // Not a valid formula
+    EXPR_TOO_COMPLEX,   // Bytecode, constants or stack would overflow
+    EXPR_DIV_ZERO,
+    EXPR_OVERFLOW,
+    EXPR_INEXACT,       // Integer division with a remainder (evaluate in fixed point instead)
+    EXPR_DOMAIN         // Negative or non-integer exponent, or % of non-integers
+} ExprStatus;
+
+typedef struct {
+    uint8_t code[EXPR_MAX_CODE];
+    int32_t constants[EXPR_MAX_CONSTANTS];
+    uint8_t length;
+    uint8_t constant_count;
+    uint8_t max_stack;
+    bool equation;       // Formula is lhs = rhs, compiled as lhs - rhs
+    bool divides;        // Contains '/' (integer evaluation may be inexact)
+} ExprProgram;
+
+// Compile a formula. On a syntax error *error_position (if not NULL) is set to the offending character.
+ExprStatus Expr_compile(const char* text, ExprProgram* program, int* error_position);
+
+// Evaluate with 64-bit integers, x as given
+ExprStatus Expr_evalInt(const ExprProgram* program, int64_t x, int64_t* result);
+
+// Evaluate in Q16.16 fixed point, x and the result are Q16.16
+ExprStatus Expr_evalFixed(const ExprProgram* program, int64_t x, int64_t* result);
+
+// Check that answer is the formula's value, or for an equation that x = answer satisfies it.
+// Uses integer arithmetic, falling back to fixed point when a division is inexact.
+ExprStatus Expr_verify(const ExprProgram* program, int32_t answer, bool* correct);
+
+// Text for a status
+const char* Expr_statusText(ExprStatus status);
+
+#endif
@@ -0,0 +1,21 @@
+/*
+* Font.h
+*
+* 5x7 bitmap font
+*
+* Used to draw generated question text on the LT24. Glyphs are drawn in cells of
+* FONT_CELL_WIDTH x FONT_CELL_HEIGHT pixels (glyph plus one pixel of spacing),
+* optionally scaled up by an integer factor.
+*/
+
+#ifndef FONT_H_
+#define FONT_H_
+
+#define FONT_CELL_WIDTH  6
+#define FONT_CELL_HEIGHT 8
+
+// Colour of one pixel of a glyph cell. index runs row by row over a
+// (FONT_CELL_WIDTH * scale) x (FONT_CELL_HEIGHT * scale) window.
+unsigned short Font_pixel(char c, unsigned int index, unsigned int scale, unsigned short colour, unsigned short background);
+
+#endif
@@ -5,30 +5,36 @@
  */
 
 #include "GameLib.h"
+#include "Worker.h"
+#include "Font.h"
+#include "Profile.h"
+#include "Trace.h"
+#if ASSETS_FROM_PACK
+#include "PixelLz.h"
 
-// Copy frame buffer to display
-// - returns 0 if successful
-HpsErr_t LT24_copyFrameColour(PLT24Ctx_t ctx, unsigned short Colour, unsigned int xleft, unsigned int ytop, unsigned int width, unsigned int height ) {
+// Decoder state and one chunk of pixels for drawing compressed images on this core
+static PixelLzStream DecodeStream;
+static unsigned short DecodeChunk[WORKER_RENDER_CHUNK];
+#endif
 
-	//Define Window (setWindow validates context for us)
-	HpsErr_t status = LT24_setWindow(ctx, xleft, ytop, width, height);
-    if (IS_ERROR(status)) return status;
+// Fill a window of the display with one colour
+static void FillColour(unsigned short Colour, unsigned int xleft, unsigned int ytop, unsigned int width, unsigned int height) {
+
+	//Define Window (the HAL validates it for us)
+	if (!Hal_lcdWindow(xleft, ytop, width, height)) return;
 
     //And copy the required number of pixels
     unsigned int cnt = (height * width);
     while (cnt--) {
         // Write the specified color to each pixel in the window
-        LT24_write(ctx, true, Colour);
+        Hal_lcdWrite(Colour);
     }
-    return ERR_SUCCESS;
 }
 
-//Copy frame buffer to display
-// - returns 0 if successful
-HpsErr_t LT24_copyFrameBufferAnswer(int result, PLT24Ctx_t ctx, const unsigned short* framebuffer, unsigned int xleft, unsigned int ytop, unsigned int width, unsigned int height ) {
-    //Define Window (setWindow validates context for us)
-    HpsErr_t status = LT24_setWindow(ctx, xleft, ytop, width, height);
-    if (IS_ERROR(status)) return status;
+//Copy an answer image to the display, recoloured for the result
+static void CopyFrameBufferAnswer(int result, const unsigned short* framebuffer, unsigned int xleft, unsigned int ytop, unsigned int width, unsigned int height) {
+    //Define Window (the HAL validates it for us)
+    if (!Hal_lcdWindow(xleft, ytop, width, height)) return;
     //And copy the required number of pixels
     unsigned int cnt = (height * width);
     unsigned short colour;
@@ -44,100 +50,251 @@ HpsErr_t LT24_copyFrameBufferAnswer(int result, PLT24Ctx_t ctx, const unsigned s
     		}
     	}
         // Write the color to the display
-        LT24_write(ctx, true, colour);
+        Hal_lcdWrite(colour);
+    }
+}
+
+#if ASSETS_FROM_PACK
+//Decode a compressed image to the display a chunk at a time; result >= 0 recolours it as an answer
+static void CopyCompressed(int result, const void* data, uint32_t size, unsigned int xleft, unsigned int ytop, unsigned int width, unsigned int height) {
+    //Define Window (the HAL validates it for us)
+    if (!Hal_lcdWindow(xleft, ytop, width, height)) return;
+    PixelLz_begin(&DecodeStream, data, size, height * width);
+    unsigned int cnt;
+    while ((cnt = PixelLz_read(&DecodeStream, DecodeChunk, sizeof(DecodeChunk) / sizeof(DecodeChunk[0]))) > 0) {
+        for (unsigned int i = 0; i < cnt; i++) {
+            unsigned short colour = DecodeChunk[i];
+            if (result >= 0 && colour == 0x0000) {
+                colour = (result == 1) ? 0x4E4E : 0xEA64;
+            }
+            Hal_lcdWrite(colour);
+        }
     }
-    return ERR_SUCCESS;
+}
+
+// Draw a compressed image from the asset pack, true if framebuffer was one
+static bool DrawCompressed(int result, const unsigned short* framebuffer, unsigned int xleft, unsigned int ytop, unsigned int width, unsigned int height) {
+	uint32_t size;
+	if (!AssetPack_compressed(framebuffer, &size)) return false;
+	if (Worker_running()) {
+		Worker_blitCompressed(result, framebuffer, size, xleft, ytop, width, height);
+	} else {
+		CopyCompressed(result, framebuffer, size, xleft, ytop, width, height);
+	}
+	return true;
+}
+#endif
+
+// Draw helpers: hand the drawing to the render worker when it is running, otherwise draw directly
+static void DrawColour(unsigned short Colour, unsigned int xleft, unsigned int ytop, unsigned int width, unsigned int height) {
+	if (Worker_running()) {
+		Worker_fill(Colour, xleft, ytop, width, height);
+	} else {
+		FillColour(Colour, xleft, ytop, width, height);
+	}
+}
+
+static void DrawImage(const unsigned short* framebuffer, unsigned int xleft, unsigned int ytop, unsigned int width, unsigned int height) {
+	if (!framebuffer) return; // Image missing from the asset pack
+#if ASSETS_FROM_PACK
+	if (DrawCompressed(-1, framebuffer, xleft, ytop, width, height)) return;
+#endif
+	if (Worker_running()) {
+		Worker_blit(framebuffer, xleft, ytop, width, height);
+	} else {
+		Hal_lcdCopy(framebuffer, xleft, ytop, width, height);
+	}
+}
+
+static void DrawAnswer(int result, const unsigned short* framebuffer, unsigned int xleft, unsigned int ytop, unsigned int width, unsigned int height) {
+	if (!framebuffer) return; // Image missing from the asset pack
+#if ASSETS_FROM_PACK
+	if (DrawCompressed(result != 0, framebuffer, xleft, ytop, width, height)) return;
+#endif
+	if (Worker_running()) {
+		Worker_blitAnswer(result, framebuffer, xleft, ytop, width, height);
+	} else {
+		CopyFrameBufferAnswer(result, framebuffer, xleft, ytop, width, height);
+	}
+}
+
+static void DrawGlyph(char c, unsigned int scale, unsigned short colour, unsigned short background, unsigned int xleft, unsigned int ytop) {
+	if (Worker_running()) {
+		Worker_glyph(c, scale, colour, background, xleft, ytop);
+	} else {
+		unsigned int width = FONT_CELL_WIDTH * scale;
+		unsigned int height = FONT_CELL_HEIGHT * scale;
+		if (!Hal_lcdWindow(xleft, ytop, width, height)) return;
+		for (unsigned int i = 0; i < width * height; i++) {
+			Hal_lcdWrite(Font_pixel(c, i, scale, colour, background));
+		}
+	}
+}
+
+// Draw a single line of text, clipped at the right edge of the screen
+void ShowText(const char* text, unsigned int xleft, unsigned int ytop, unsigned int scale, unsigned short colour, unsigned short background) {
+	unsigned int x = xleft;
+	while (*text && x + FONT_CELL_WIDTH * scale <= LCD_WIDTH) {
+		DrawGlyph(*text++, scale, colour, background, x, ytop);
+		x += FONT_CELL_WIDTH * scale;
+	}
+}
+
+// Draw text word-wrapped to lines of at most max_chars characters, returns the y below the last line
+static unsigned int ShowWrappedText(const char* text, unsigned int xleft, unsigned int ytop, unsigned int scale, unsigned int max_chars) {
+	char line[QUESTION_TEXT_LENGTH];
+	while (*text) {
+		unsigned int length = 0;
+		unsigned int wrap = 0;
+		// Find the last space that still fits on this line
+		while (text[length] && length < max_chars) {
+			if (text[length] == ' ') wrap = length;
+			length++;
+		}
+		if (text[length] && wrap) length = wrap;
+		for (unsigned int i = 0; i < length && i < sizeof(line) - 1; i++) {
+			line[i] = text[i];
+		}
+		line[length < sizeof(line) - 1 ? length : sizeof(line) - 1] = '\0';
+		ShowText(line, xleft, ytop, scale, 0x0000, 0xFE2E);
+		ytop += (FONT_CELL_HEIGHT + 2) * scale;
+		text += length;
+		while (*text == ' ') text++;
+	}
+	return ytop;
+}
+
+// Display a question: its image if it has one, otherwise its text (and choices for easy)
+void ShowQuestion(int difficulty, const MathQuestion* question) {
+	static const char* const ChoiceLabels[4] = { "A) ", "B) ", "C) ", "D) " };
+
+	if (question->screen) {
+		ShowScreen(question->screen);
+		return;
+	}
+
+	DrawColour(0xFE2E, 0, 0, LCD_WIDTH, LCD_HEIGHT);
+	if (difficulty == 0) {
+		ShowWrappedText(question->question, 16, 59, 2, 17);
+		// Choices line up with the tick and cross positions used by ShowAnswer
+		for (int i = 0; i < 4; i++) {
+			ShowText(ChoiceLabels[i], 40, 147 + i*30, 2, 0x0000, 0xFE2E);
+			ShowText(question->choices[i], 76, 147 + i*30, 2, 0x0000, 0xFE2E);
+		}
+		ShowText("KEY0-KEY3 select A-D", 60, 280, 1, 0x0000, 0xFE2E);
+	} else {
+		ShowWrappedText(question->question, 12, 100, 2, 18);
+		ShowText("Enter the answer, KEY0 to confirm", 21, 300, 1, 0x0000, 0xFE2E);
+	}
+}
+
+// Draw a numeric answer: single digits use the digit images, other values the font.
+// Text is placed from xleft, or right aligned to end at xright when xright is non-zero.
+static void DrawAnswerNumber(int result, int value, unsigned int xleft, unsigned int xright) {
+	char text[12];
+	char digits[11];
+	int length = 0;
+	int count = 0;
+	unsigned int magnitude = (value < 0) ? 0u - (unsigned int)value : (unsigned int)value;
+
+	if (value >= 0 && value <= 9) {
+		DrawAnswer(result, DigitImg(value), xleft, 250, 40, 40);
+		return;
+	}
+
+	do {
+		digits[count++] = (char)('0' + magnitude % 10);
+		magnitude /= 10;
+	} while (magnitude);
+	if (value < 0) text[length++] = '-';
+	while (count) text[length++] = digits[--count];
+	text[length] = '\0';
+
+	if (xright) xleft = xright - length * FONT_CELL_WIDTH * 3;
+	ShowText(text, xleft, 258, 3, result ? 0x4E4E : 0xEA64, 0xFE2E);
 }
 
 // Display the answer feedback based on difficulty and correctness
-void ShowAnswer(int difficulty, int current_question, int user_answer, int correct_answer, PLT24Ctx_t lt24) {
+void ShowAnswer(int difficulty, int current_question, int user_answer, int correct_answer) {
 
     // Get the image data for the correct answer and user's answer
-	const unsigned short *correct_answer_img = &Num[correct_answer][0];
-	const unsigned short *user_answer_img = &Num[user_answer][0];
-
 	// If difficulty level is not easy
 	if(difficulty != 0) {
-		if(user_answer != correct_answer) {
-            // Display the correct answer in green
-			LT24_copyFrameBufferAnswer(1, lt24, correct_answer_img, 12, 250, 40, 40); // 1- Green
-            // Display the user's incorrect answer in red
-			LT24_copyFrameBufferAnswer(0, lt24, user_answer_img, 188, 250, 40, 40); // 0- Red
-		} else {
-            // Display both the correct and user's correct answer in green
-			LT24_copyFrameBufferAnswer(1, lt24, correct_answer_img, 12, 250, 40, 40); // 1- Green
-			LT24_copyFrameBufferAnswer(1, lt24, user_answer_img, 188, 250, 40, 40); // 1- Green
-		}
+		// Correct answer in green on the left, the user's answer on the right in green or red
+		DrawAnswerNumber(1, correct_answer, 12, 0);
+		DrawAnswerNumber(user_answer == correct_answer, user_answer, 188, 228);
 	}
 	// for easy
 	else {
         // Display a small green tick for the correct answer
-		LT24_copyFrameBuffer(lt24, right, 176, 147 + correct_answer*30, 15, 15);
+		DrawImage(right, 176, 147 + correct_answer*30, 15, 15);
 		if(user_answer != correct_answer) {
             // Display a small red x for the incorrect user's answer
-			LT24_copyFrameBuffer(lt24, wrong, 176, 147 + user_answer*30, 15, 15);
+			DrawImage(wrong, 176, 147 + user_answer*30, 15, 15);
 		}
 	}
 }
 // Display different screens based on the provided screen identifier
-void ShowScreen(uint8_t ScreenNum, PLT24Ctx_t lt24) {
+void ShowScreen(uint8_t ScreenNum) {
+	PROFILE_SCOPE("ShowScreen");
+	TRACE_SCOPE("ShowScreen");
 
 	//Switch case to display different images on the LCD
 	switch(ScreenNum) {
 		case START_SCREEN:  	// Display the start screen image
-			LT24_copyFrameBuffer(lt24, StartScreenImg, 0, 0, LCD_WIDTH, LCD_HEIGHT);
+			DrawImage(StartScreenImg, 0, 0, LCD_WIDTH, LCD_HEIGHT);
 			break;
 		case LEVEL_SCREEN:       // Display the level selection screen image
-			LT24_copyFrameBuffer(lt24, SelectLevelImg, 0, 0, LCD_WIDTH, LCD_HEIGHT);
+			DrawImage(SelectLevelImg, 0, 0, LCD_WIDTH, LCD_HEIGHT);
 			break;
 		// Clear the screen with a background colour and display the easy questions
 		case EASY_1:
-			LT24_copyFrameColour(lt24, 0xFE2E, 0, 0, LCD_WIDTH, LCD_HEIGHT);
-			LT24_copyFrameBuffer(lt24, EasyQues_1, 16, 59, 208, 211);
+			DrawColour(0xFE2E, 0, 0, LCD_WIDTH, LCD_HEIGHT);
+			DrawImage(EasyQues_1, 16, 59, 208, 211);
 			break;
 		case EASY_2:
-			LT24_copyFrameColour(lt24, 0xFE2E, 0, 0, LCD_WIDTH, LCD_HEIGHT);
-			LT24_copyFrameBuffer(lt24, EasyQues_2, 16, 59, 208, 211);
+			DrawColour(0xFE2E, 0, 0, LCD_WIDTH, LCD_HEIGHT);
+			DrawImage(EasyQues_2, 16, 59, 208, 211);
 			break;
 		case EASY_3:
-			LT24_copyFrameColour(lt24, 0xFE2E, 0, 0, LCD_WIDTH, LCD_HEIGHT);
-			LT24_copyFrameBuffer(lt24, EasyQues_3, 16, 59, 208, 211);
+			DrawColour(0xFE2E, 0, 0, LCD_WIDTH, LCD_HEIGHT);
+			DrawImage(EasyQues_3, 16, 59, 208, 211);
 			break;
         // Clear the screen with a background colour and display the medium questions
 		case MED_1:
-			LT24_copyFrameColour(lt24, 0xFE2E, 0, 0, LCD_WIDTH, LCD_HEIGHT);
-			LT24_copyFrameBuffer(lt24, MedQues_1, 12, 100, 215, 120);
+			DrawColour(0xFE2E, 0, 0, LCD_WIDTH, LCD_HEIGHT);
+			DrawImage(MedQues_1, 12, 100, 215, 120);
 			break;
 		case MED_2:
-			LT24_copyFrameColour(lt24, 0xFE2E, 0, 0, LCD_WIDTH, LCD_HEIGHT);
-			LT24_copyFrameBuffer(lt24, MedQues_2, 12, 100, 215, 120);
+			DrawColour(0xFE2E, 0, 0, LCD_WIDTH, LCD_HEIGHT);
+			DrawImage(MedQues_2, 12, 100, 215, 120);
 			break;
 		case MED_3:
-			LT24_copyFrameColour(lt24, 0xFE2E, 0, 0, LCD_WIDTH, LCD_HEIGHT);
-			LT24_copyFrameBuffer(lt24, MedQues_3, 12, 100, 215, 121);
+			DrawColour(0xFE2E, 0, 0, LCD_WIDTH, LCD_HEIGHT);
+			DrawImage(MedQues_3, 12, 100, 215, 121);
 			break;
 	    // Clear the screen with a background colour and display the hard questions
 		case HARD_1:
-			LT24_copyFrameColour(lt24, 0xFE2E, 0, 0, LCD_WIDTH, LCD_HEIGHT);
-			LT24_copyFrameBuffer(lt24, HardQues_1, 12, 100, 215, 121);
+			DrawColour(0xFE2E, 0, 0, LCD_WIDTH, LCD_HEIGHT);
+			DrawImage(HardQues_1, 12, 100, 215, 121);
 			break;
 		case HARD_2:
-			LT24_copyFrameColour(lt24, 0xFE2E, 0, 0, LCD_WIDTH, LCD_HEIGHT);
-			LT24_copyFrameBuffer(lt24, HardQues_2, 12, 100, 215, 121);
+			DrawColour(0xFE2E, 0, 0, LCD_WIDTH, LCD_HEIGHT);
+			DrawImage(HardQues_2, 12, 100, 215, 121);
 			break;
 		case HARD_3:
-			LT24_copyFrameColour(lt24, 0xFE2E, 0, 0, LCD_WIDTH, LCD_HEIGHT);
-			LT24_copyFrameBuffer(lt24, HardQues_3, 12, 100, 215, 121);
+			DrawColour(0xFE2E, 0, 0, LCD_WIDTH, LCD_HEIGHT);
+			DrawImage(HardQues_3, 12, 100, 215, 121);
 			break;
         // Clear the screen with a background colour and display the "continue playing" screen
 		case CONTPLAY:
-			LT24_copyFrameColour(lt24, 0xFE2E, 0, 0, LCD_WIDTH, LCD_HEIGHT);
-			LT24_copyFrameBuffer(lt24, Contplaying, 12, 100, 214, 120);
+			DrawColour(0xFE2E, 0, 0, LCD_WIDTH, LCD_HEIGHT);
+			DrawImage(Contplaying, 12, 100, 214, 120);
 			break;
 		case END_SCREEN:
         // Clear the screen with a background colour and display the end screen
-			LT24_copyFrameColour(lt24, 0xFE2D, 0, 0, LCD_WIDTH, LCD_HEIGHT);
-			LT24_copyFrameBuffer(lt24, EndScreenImg, 35, 85, 170, 150);
+			DrawColour(0xFE2D, 0, 0, LCD_WIDTH, LCD_HEIGHT);
+			DrawImage(EndScreenImg, 35, 85, 170, 150);
 			break;
 		default: break;
 	}
@@ -10,19 +10,15 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <math.h>
-// Include HPS Watchdog for functionality
-#include "HPS_Watchdog/HPS_Watchdog.h"
-//Include LT24 display controller
-#include "DE1SoC_LT24/DE1SoC_LT24.h"
+// Drawing goes through the hardware abstraction layer
+#include "Hal.h"
 
 #include "Images.h"
+#include "Questions.h"
 // Define the dimensions of the LCD display
 #define LCD_WIDTH 240
 #define LCD_HEIGHT 320
 
-// Define the base address for the key inputs
-#define KEY_BASE 0xFF200050
-
 // Define screen identifiers for different game states
 #define START_SCREEN 1
 #define LEVEL_SCREEN 2
@@ -44,26 +40,17 @@
 #define HARD_2 31
 #define HARD_3 32
 
-// Function prototype to check for a specific key press
-void CheckKeyPress(uint8_t KeyNum);
-
-// Function prototype to get the key that has been pressed
-uint8_t GetKeyPressed();
-
-// Function prototype to handle the game logic for easy level
-uint8_t EasyLevel(PLT24Ctx_t lt24);
-
-// Function prototype to handle the game logic for medium level
-uint8_t MediumLevel(PLT24Ctx_t lt24);
+// Function prototype to display different screens based on the screen identifier
+void ShowScreen(uint8_t ScreenNum);
 
-// Function prototype to handle the game logic for hard level
-uint8_t HardLevel(PLT24Ctx_t lt24);
+// Function prototype to draw a line of text in the 5x7 font at an integer scale
+void ShowText(const char* text, unsigned int xleft, unsigned int ytop, unsigned int scale, unsigned short colour, unsigned short background);
 
-// Function prototype to display different screens based on the screen identifier
-void ShowScreen(uint8_t ScreenNum, PLT24Ctx_t lt24);
+// Function prototype to display a question, drawing its text if it has no question image
+void ShowQuestion(int difficulty, const MathQuestion* question);
 
 // Function prototype to show the answer feedback based on the user's answer
-void ShowAnswer(int difficulty, int current_question, int user_answer, int correct_answer, PLT24Ctx_t lt24);
+void ShowAnswer(int difficulty, int current_question, int user_answer, int correct_answer);
 
 
 #endif
@@ -0,0 +1,126 @@
+/*
+* Hal.h
+*
+* Hardware abstraction layer
+*
+* Everything the game touches on the board goes through these functions: keys, slide
+* switches, the private timer and idle sleep, the CPU cycle counter, the watchdog, the seven-segment displays,
+* the LT24 LCD and the audio codec FIFO. There are two backends, selected at compile time
+* the same way Worker.c picks core 1 or a pthread:
+*
+* HalDe1SoC.c - the board. Thin wrappers over the DE1-SoC drivers and registers.
+*
+* HalLinux.c - a headless Linux host build, so the unchanged game loop can run in CI,
+*     under a profiler or under sanitizers:
+*       - time is virtual: it advances by HAL_POLL_COUNTS on every timer read and jumps
+*         forward on sleeps, so a run is deterministic and never waits in real time
+*       - keys and switches are driven by a script of timed events (HAL_INPUT)
+*       - the LCD is an in-memory RGB565 framebuffer, written as a PPM on request (HAL_FRAME)
+*       - audio samples are drained from a FIFO at the codec rate and appended to a WAV (HAL_AUDIO)
+*       - FatFS runs unmodified on top of a disk image file (HAL_SD_IMAGE), through its diskio layer
+*
+* Input script, one event per line, '#' starts a comment:
+*     <ms> keys <mask>        set the push button levels (bit 0 is KEY0)
+*     <ms> press <key>        press KEY<key> for HAL_PRESS_MS
+*     <ms> switches <mask>    set the slide switch levels
+*     <ms> snapshot <file>    write the LCD to a PPM file
+*     <ms> quit               end the run
+* Times are milliseconds since boot, or since the previous event when written as +<ms>.
+*
+* Bulk simulation (see tools/simulate.c) adds:
+*     HAL_RANDOM_SEED   a random player presses keys and sets switches once the script is used up
+*     HAL_GAMES         exit after this many games
+*     HAL_REPORT_FD     write a one line summary (games, peak RSS, stuck state) to this descriptor at exit
+* A state the game does not leave for HAL_STUCK_S virtual seconds while input keeps coming
+* ends the run with status 4.
+*/
+
+#ifndef HAL_H_
+#define HAL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Private timer rate. The host backend keeps the same rate so tick arithmetic is unchanged.
+#define HAL_TIMER_HZ 225000000u
+
+// Hal_cycles rate. The board counts CPU cycles (four per private timer count) in steps of 64,
+// so a 32-bit count covers minutes; the host counts wall clock nanoseconds.
+#if defined(__linux__)
+#define HAL_CYCLE_HZ 1000000000u
+#else
+#define HAL_CYCLE_HZ (HAL_TIMER_HZ * 4u / 64u)
+#endif
+
+// Hal_globalCounts rate: the A9 global timer runs off the same clock as the private timer,
+// the host counts wall clock nanoseconds
+#if defined(__linux__)
+#define HAL_GLOBAL_HZ 1000000000u
+#else
+#define HAL_GLOBAL_HZ HAL_TIMER_HZ
+#endif
+
+// Seven-segment displays HEX0-HEX5
+#define HAL_SEVEN_SEG_DISPLAYS 6
+
+// Host backend: virtual counts that pass on each timer read, and how long a scripted press lasts
+#define HAL_POLL_COUNTS  (HAL_TIMER_HZ / 1000000)
+#define HAL_PRESS_MS     100
+// Host backend: virtual seconds without input after the script ends before the run is abandoned
+#define HAL_IDLE_LIMIT_S 600
+// Host backend: virtual seconds in one game state, with input arriving, before the game counts as stuck
+#define HAL_STUCK_S      600
+
+// Bring up the timers, LCD and idle wake-up. Exits if a device fails to start.
+void Hal_initialise(void);
+
+// Bring up the audio codec, after Hal_initialise so the LCD can be drawn first. Exits if it fails to start.
+void Hal_audioInitialise(void);
+
+// Flush host outputs (framebuffer, WAV). Nothing to do on the board.
+void Hal_shutdown(void);
+
+// Report the game state machine's state once per pass, 0 being the start menu. The host
+// backend counts games and spots a stuck state from it; nothing to do on the board.
+void Hal_gameState(unsigned int state);
+
+// Push button and slide switch levels, bit 0 is KEY0 / SW0
+unsigned int Hal_readKeys(void);
+unsigned int Hal_readSwitches(void);
+
+// Free running up-counter at HAL_TIMER_HZ, wraps at 2^32
+uint32_t Hal_timerCounts(void);
+
+// Sleep for up to counts, waking early on a key press. Returns the counts that passed.
+uint32_t Hal_sleep(uint32_t counts);
+
+// Free running cycle counter at HAL_CYCLE_HZ for profiling, wraps at 2^32. Core 0 only on the board.
+uint32_t Hal_cycles(void);
+
+// 64-bit counter at HAL_GLOBAL_HZ shared by both cores, for timestamps compared across cores
+uint64_t Hal_globalCounts(void);
+
+// Core running the caller: 0 for the game, 1 for the render/audio worker (core 1 or its thread)
+unsigned int Hal_coreId(void);
+
+// Feed the hardware watchdog
+void Hal_feedWatchdog(void);
+
+// Seven-segment displays: raw active-high segments (gfedcba), a hex digit, or two decimal digits on display and display + 1
+void Hal_sevenSegWrite(unsigned int display, uint8_t segments);
+void Hal_sevenSegSetSingle(unsigned int display, unsigned int value);
+void Hal_sevenSegSetDoubleDec(unsigned int display, unsigned int value);
+
+// LCD: set the drawing window, then write its pixels left to right, top to bottom.
+// Returns false, drawing nothing, if the window is off the screen.
+bool Hal_lcdWindow(unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+void Hal_lcdWrite(unsigned short colour);
+
+// LCD: copy a whole image into a window
+void Hal_lcdCopy(const unsigned short* pixels, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+
+// Audio codec FIFO: free slots, and write one sample to both channels
+unsigned int Hal_audioSpace(void);
+void Hal_audioWrite(signed int sample);
+
+#endif
@@ -0,0 +1,359 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * DE1-SoC backend of the hardware abstraction layer. Keys and switches are read from the
+ * FPGA PIO registers, time comes from the ARM A9 private timer, and the seven-segment,
+ * LT24 and WM8731 drivers do the rest.
+ */
+
+#include "Hal.h"
+
+#if !defined(__linux__)
+
+#include "DE1SoC_Addresses/DE1SoC_Addresses.h"
+#include "DE1SoC_SevenSeg/DE1SoC_SevenSeg.h"
+#include "DE1SoC_LT24/DE1SoC_LT24.h"
+#include "DE1SoC_WM8731/DE1SoC_WM8731.h"
+#include "HPS_Watchdog/HPS_Watchdog.h"
+#include "HPS_GPIO/HPS_GPIO.h"
+#include "HPS_I2C/HPS_I2C.h"
+#include "Util/macros.h"
+#include <stdlib.h>
+
+// Memory-mapped switches and buttons
+#define SW_BASE  0xFF200040
+#define KEY_BASE 0xFF200050
+
+// ARM A9 MPCore interrupt controller registers, used only to let timer and key interrupts wake WFI
+#define GIC_CPU_BASE  0xFFFEC100
+#define GIC_DIST_BASE 0xFFFED000
+#define PRIVATE_TIMER_IRQ 29
+#define KEYS_IRQ 73
+
+static volatile unsigned int *KEY_ptr = (unsigned int *)KEY_BASE;
+
+// ARM A9 global timer, one 64-bit counter shared by both cores
+#define GLOBAL_TIMER_BASE 0xFFFEC200
+static volatile unsigned int *global_timer = (unsigned int *)GLOBAL_TIMER_BASE;
+
+// ARM A9 Private Timer related addresses.
+static volatile unsigned int *private_timer_load = (unsigned int *)(LSC_BASE_PRIV_TIM + 0x0);
+static volatile unsigned int *private_timer_value = (unsigned int *)(LSC_BASE_PRIV_TIM + 0x4);
+static volatile unsigned int *private_timer_control = (unsigned int *)(LSC_BASE_PRIV_TIM + 0x8);
+static volatile unsigned int *private_timer_interrupt = (unsigned int *)(LSC_BASE_PRIV_TIM + 0xC);
+
+// Counts before the current free running period. The timer reloads from 0xFFFFFFFF, so
+// its complement is an up-counter that stays continuous across the wrap.
+static uint32_t counts_base;
+
+// Context structures for the peripherals
+static PLT24Ctx_t lt24;
+static PWM8731Ctx_t audio;
+static PHPSGPIOCtx_t gpio;
+static PHPSI2CCtx_t i2c;
+
+// Status function to exit on failure of a driver
+void exitOnFail(signed int status, signed int successStatus) {
+    if (status != successStatus) {
+        exit((int) status); //Add breakpoint here to catch failure
+    }
+}
+
+/*
+ * Function: timer_free_run
+ * Description: Starts the private timer counting down from 0xFFFFFFFF with auto reload
+ */
+static void timer_free_run(void) {
+    *private_timer_control   = 0;
+    *private_timer_load      = 0xFFFFFFFF;
+    *private_timer_interrupt = 0x1;
+    *private_timer_control   = (1 << 1) | (1 << 0); // Auto reload, enabled
+}
+
+/*
+ * Function: cycle_counter_start
+ * Description: Starts the PMU cycle counter from zero, counting every 64 CPU cycles
+ */
+static void cycle_counter_start(void) {
+    unsigned int pmcr;
+
+    __asm__ volatile ("mrc p15, 0, %0, c9, c12, 0" : "=r"(pmcr));
+    pmcr |= (1 << 3) | (1 << 2) | (1 << 0);                       // Divide by 64, reset, enable
+    __asm__ volatile ("mcr p15, 0, %0, c9, c12, 0" :: "r"(pmcr));
+    __asm__ volatile ("mcr p15, 0, %0, c9, c12, 1" :: "r"(1u << 31)); // PMCNTENSET: cycle counter
+}
+
+/*
+ * Function: initialise_idle_wakeup
+ * Description: Routes the private timer and push button interrupts to this core so they can wake it
+ *              from WFI. IRQs stay masked in the CPSR, the interrupts are only used as wake-up events.
+ */
+static void initialise_idle_wakeup(void) {
+    volatile unsigned int *gic_cpu = (unsigned int *)GIC_CPU_BASE;
+    volatile unsigned int *gic_dist = (unsigned int *)GIC_DIST_BASE;
+    volatile unsigned char *gic_targets = (unsigned char *)(GIC_DIST_BASE + 0x800);
+
+    __asm__ volatile ("cpsid i" ::: "memory");
+    gic_dist[0x100/4 + PRIVATE_TIMER_IRQ/32] = 1u << (PRIVATE_TIMER_IRQ % 32); // Set-enable
+    gic_dist[0x100/4 + KEYS_IRQ/32] = 1u << (KEYS_IRQ % 32);
+    gic_targets[KEYS_IRQ] = 0x01; // Keys go to CPU0
+    gic_cpu[1] = 0xFFFF;          // Priority mask: allow all priorities
+    gic_cpu[0] = 1;               // Enable CPU interface
+    gic_dist[0] = 1;              // Enable distributor
+
+    KEY_ptr[2] = 0xF;             // Interrupt on any key edge
+    KEY_ptr[3] = 0xF;             // Clear pending edges
+}
+
+/**
+ * Function: Hal_initialise
+ * Description: Starts the free running private timer, the cycle counter and the LCD, and lets
+ *              timer and key interrupts wake the idle loop
+ * Input(s): None
+ * Return: void
+ */
+void Hal_initialise(void) {
+    counts_base = 0;
+    timer_free_run();
+    cycle_counter_start();
+    global_timer[2] = 1; // Global timer control: enabled, no prescaler
+
+    exitOnFail(LT24_initialise(LSC_BASE_GPIO_JP1, LSC_BASE_LT24HWDATA, &lt24), ERR_SUCCESS);
+    initialise_idle_wakeup();
+    HPS_ResetWatchdog();
+}
+
+/**
+ * Function: Hal_audioInitialise
+ * Description: Brings up the I2C bus and the audio codec, and empties its FIFOs
+ * Input(s): None
+ * Return: void
+ */
+void Hal_audioInitialise(void) {
+    exitOnFail(HPS_GPIO_initialise(LSC_BASE_ARM_GPIO, ARM_GPIO_DIR, ARM_GPIO_I2C_GENERAL_MUX, 0, &gpio), ERR_SUCCESS);
+    exitOnFail(HPS_I2C_initialise(LSC_BASE_I2C_GENERAL, I2C_SPEED_STANDARD, &i2c), ERR_SUCCESS);
+    exitOnFail(WM8731_initialise(LSC_BASE_AUDIOCODEC, i2c, &audio), ERR_SUCCESS);
+    WM8731_clearFIFO(audio, true, true);
+    HPS_ResetWatchdog();
+}
+
+/**
+ * Function: Hal_shutdown
+ * Description: Nothing to flush on the board
+ * Input(s): None
+ * Return: void
+ */
+void Hal_shutdown(void) {
+}
+
+/**
+ * Function: Hal_gameState
+ * Description: Game progress is only followed by the host backend
+ * Input(s): unsigned int state
+ * Return: void
+ */
+void Hal_gameState(unsigned int state) {
+    (void)state;
+}
+
+/**
+ * Function: Hal_readKeys
+ * Description: Reads the push button levels
+ * Input(s): None
+ * Return: unsigned int - KEY0-KEY3 in bits 0-3
+ */
+unsigned int Hal_readKeys(void) {
+    return KEY_ptr[0];
+}
+
+/**
+ * Function: Hal_readSwitches
+ * Description: Reads the slide switch levels
+ * Input(s): None
+ * Return: unsigned int - SW0-SW9 in bits 0-9
+ */
+unsigned int Hal_readSwitches(void) {
+    volatile unsigned int *sw_ptr = (unsigned int *)SW_BASE;
+    return *sw_ptr;
+}
+
+/**
+ * Function: Hal_timerCounts
+ * Description: Reads the private timer as an up-counter
+ * Input(s): None
+ * Return: uint32_t - counts at HAL_TIMER_HZ
+ */
+uint32_t Hal_timerCounts(void) {
+    return counts_base + ~(*private_timer_value);
+}
+
+/**
+ * Function: Hal_sleep
+ * Description: Reprograms the private timer as a one-shot and waits for it (or a key press)
+ *              in WFI. The free running time base is restored afterwards, with the time slept
+ *              added so Hal_timerCounts carries on from where it would have been.
+ * Input(s): uint32_t counts - counts to sleep for
+ * Return: uint32_t - counts actually slept
+ */
+uint32_t Hal_sleep(uint32_t counts) {
+    volatile unsigned int *gic_cpu = (unsigned int *)GIC_CPU_BASE;
+    uint32_t before;
+    unsigned int value;
+
+    if (counts == 0) return 0;
+    before = Hal_timerCounts();
+
+    *private_timer_control   = 0;
+    *private_timer_load      = counts;
+    *private_timer_interrupt = 0x1;
+    *private_timer_control   = (1 << 2) | (1 << 0); // One-shot, interrupt enabled
+
+    __asm__ volatile ("cpsid i\n\twfi" ::: "memory");
+
+    value = *private_timer_value;
+    timer_free_run();
+    counts_base = before + (counts - value);
+
+    // Acknowledge whatever woke us and clear the key edges
+    KEY_ptr[3] = 0xF;
+    unsigned int irq = gic_cpu[3];
+    if ((irq & 0x3FF) != 1023) {
+        gic_cpu[4] = irq;
+    }
+
+    return counts - value;
+}
+
+/**
+ * Function: Hal_cycles
+ * Description: Reads the PMU cycle counter of the calling core
+ * Input(s): None
+ * Return: uint32_t - counts at HAL_CYCLE_HZ
+ */
+uint32_t Hal_cycles(void) {
+    unsigned int cycles;
+    __asm__ volatile ("mrc p15, 0, %0, c9, c13, 0" : "=r"(cycles));
+    return cycles;
+}
+
+/**
+ * Function: Hal_globalCounts
+ * Description: Reads the global timer, high word twice so a carry between the reads is caught
+ * Input(s): None
+ * Return: uint64_t - counts at HAL_GLOBAL_HZ
+ */
+uint64_t Hal_globalCounts(void) {
+    unsigned int high, low;
+
+    do {
+        high = global_timer[1];
+        low = global_timer[0];
+    } while (global_timer[1] != high);
+    return ((uint64_t)high << 32) | low;
+}
+
+/**
+ * Function: Hal_coreId
+ * Description: Reads the CPU number from MPIDR
+ * Input(s): None
+ * Return: unsigned int - 0 or 1
+ */
+unsigned int Hal_coreId(void) {
+    unsigned int mpidr;
+    __asm__ volatile ("mrc p15, 0, %0, c0, c0, 5" : "=r"(mpidr));
+    return mpidr & 0x3;
+}
+
+/**
+ * Function: Hal_feedWatchdog
+ * Description: Feeds the HPS watchdog
+ * Input(s): None
+ * Return: void
+ */
+void Hal_feedWatchdog(void) {
+    HPS_ResetWatchdog();
+}
+
+/**
+ * Function: Hal_sevenSegWrite
+ * Description: Writes raw segments to one display
+ * Input(s): unsigned int display, uint8_t segments - active high, gfedcba
+ * Return: void
+ */
+void Hal_sevenSegWrite(unsigned int display, uint8_t segments) {
+    DE1SoC_SevenSeg_Write(display, segments);
+}
+
+/**
+ * Function: Hal_sevenSegSetSingle
+ * Description: Shows a hex digit on one display
+ * Input(s): unsigned int display, unsigned int value
+ * Return: void
+ */
+void Hal_sevenSegSetSingle(unsigned int display, unsigned int value) {
+    DE1SoC_SevenSeg_SetSingle(display, value);
+}
+
+/**
+ * Function: Hal_sevenSegSetDoubleDec
+ * Description: Shows a two digit decimal number on a pair of displays
+ * Input(s): unsigned int display - lower display of the pair, unsigned int value
+ * Return: void
+ */
+void Hal_sevenSegSetDoubleDec(unsigned int display, unsigned int value) {
+    DE1SoC_SevenSeg_SetDoubleDec(display, value);
+}
+
+/**
+ * Function: Hal_lcdWindow
+ * Description: Sets the LT24 drawing window
+ * Input(s): unsigned int x, y, width, height
+ * Return: bool - false if the driver rejected the window
+ */
+bool Hal_lcdWindow(unsigned int x, unsigned int y, unsigned int width, unsigned int height) {
+    return !IS_ERROR(LT24_setWindow(lt24, x, y, width, height));
+}
+
+/**
+ * Function: Hal_lcdWrite
+ * Description: Writes the next pixel of the window
+ * Input(s): unsigned short colour - RGB565
+ * Return: void
+ */
+void Hal_lcdWrite(unsigned short colour) {
+    LT24_write(lt24, true, colour);
+}
+
+/**
+ * Function: Hal_lcdCopy
+ * Description: Copies an image to the LT24
+ * Input(s): const unsigned short* pixels, unsigned int x, y, width, height
+ * Return: void
+ */
+void Hal_lcdCopy(const unsigned short* pixels, unsigned int x, unsigned int y, unsigned int width, unsigned int height) {
+    LT24_copyFrameBuffer(lt24, pixels, x, y, width, height);
+}
+
+/**
+ * Function: Hal_audioSpace
+ * Description: Reads the free space in the codec's output FIFO
+ * Input(s): None
+ * Return: unsigned int - samples that can be written
+ */
+unsigned int Hal_audioSpace(void) {
+    unsigned int space = 0;
+    WM8731_getFIFOSpace(audio, &space);
+    return space;
+}
+
+/**
+ * Function: Hal_audioWrite
+ * Description: Writes one sample to both codec channels
+ * Input(s): signed int sample
+ * Return: void
+ */
+void Hal_audioWrite(signed int sample) {
+    WM8731_writeSample(audio, sample, sample);
+}
+
+#endif
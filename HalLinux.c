@@ -0,0 +1,730 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Linux host backend of the hardware abstraction layer. Time is virtual and only moves
+ * when the game reads or sleeps on it, input comes from a script of timed events, the LCD
+ * is a framebuffer in memory and audio goes to a WAV file, so a run is fully deterministic.
+ * FatFS is given a disk image file through its diskio interface.
+ *
+ * For bulk simulation a seeded random player takes over once the script (if any) is
+ * used up, games are counted from the state changes main reports, and a state that never
+ * changes is reported as stuck. tools/simulate.c runs many such instances in parallel.
+ *
+ * Host builds draw and play sound on the game thread by default. With RENDER_WORKER=1 the
+ * worker thread also writes the framebuffer and the audio FIFO; the clock is atomic for
+ * that case, but the run is then no longer deterministic.
+ */
+
+#if defined(__linux__)
+#define _POSIX_C_SOURCE 200809L  // fseeko, strdup
+#define _FILE_OFFSET_BITS 64     // SD images over 2GB
+#endif
+
+#include "Hal.h"
+
+#if defined(__linux__)
+
+#include "FatFS/ff.h"
+#include "FatFS/diskio.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/resource.h>
+
+#define HAL_LCD_WIDTH  240
+#define HAL_LCD_HEIGHT 320
+
+#define AUDIO_RATE        48000
+#define AUDIO_FIFO_SIZE   128
+#define COUNTS_PER_SAMPLE ((HAL_TIMER_HZ + AUDIO_RATE / 2) / AUDIO_RATE)
+#define COUNTS_PER_MS     (HAL_TIMER_HZ / 1000)
+
+#define SD_SECTOR_SIZE 512
+#define SCRIPT_LINE_LENGTH 256
+
+// Random player: gaps between actions, at least a whole press apart
+#define RANDOM_GAP_MIN_MS (HAL_PRESS_MS + 50)
+#define RANDOM_GAP_SPAN_MS 1500
+
+#define NO_STATE 0xFFFFFFFFu
+
+// Sector numbers became LBA_t in FatFS R0.14
+#if defined(FF_DEFINED) && FF_DEFINED >= 86606
+typedef LBA_t HalSector;
+#else
+typedef DWORD HalSector;
+#endif
+
+typedef enum { EVENT_KEYS, EVENT_KEY_DOWN, EVENT_KEY_UP, EVENT_SWITCHES, EVENT_SNAPSHOT, EVENT_QUIT } HalEventType;
+
+typedef struct {
+    uint64_t time;           // Virtual counts since boot
+    unsigned int order;      // Script order, keeps events at the same time in sequence
+    HalEventType type;
+    unsigned int value;
+    char* file;              // Snapshot file
+} HalEvent;
+
+static uint64_t virtual_counts;
+static HalEvent* events;
+static unsigned int event_count;
+static unsigned int next_event;
+static uint64_t last_event_time;
+
+static unsigned int key_levels;
+static unsigned int switch_levels;
+static uint8_t seven_seg[HAL_SEVEN_SEG_DISPLAYS];
+
+static unsigned short framebuffer[HAL_LCD_WIDTH * HAL_LCD_HEIGHT];
+static unsigned int window_left, window_top, window_right, window_bottom;  // Right and bottom are exclusive
+static unsigned int cursor_x, cursor_y;
+
+static FILE* audio_file;
+static uint32_t audio_samples;
+static uint64_t audio_empty_at;  // Virtual time the FIFO runs dry
+
+static FILE* sd_image;
+static bool hal_started;
+static pthread_t game_thread;     // Hal_coreId 0, the thread that called Hal_initialise
+
+static bool random_input;
+static uint64_t random_state;
+
+// Game progress from Hal_gameState
+static unsigned int game_state = NO_STATE;
+static uint64_t state_since;
+static unsigned int state_changes;
+static unsigned int games_played;
+static unsigned int games_limit;      // Stop after this many games, 0 for no limit
+static unsigned int stuck_state = NO_STATE;
+static long rss_first_game_kb;
+static int report_fd = -1;
+
+// Active-high segments, gfedcba
+static const uint8_t hex_segments[16] = {
+    0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, 0x7F, 0x6F, 0x77, 0x7C, 0x39, 0x5E, 0x79, 0x71
+};
+
+/*
+ * Function: clock_now
+ * Description: Reads virtual time without letting it pass
+ */
+static uint64_t clock_now(void) {
+    return __atomic_load_n(&virtual_counts, __ATOMIC_RELAXED);
+}
+
+/*
+ * Function: clock_advance_to
+ * Description: Moves virtual time forward to time, never backwards
+ */
+static void clock_advance_to(uint64_t time) {
+    uint64_t now = clock_now();
+    while (now < time && !__atomic_compare_exchange_n(&virtual_counts, &now, time, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+/*
+ * Function: script_fail
+ * Description: Reports a bad input script line and stops the run
+ */
+static void script_fail(const char* path, unsigned int line, const char* message) {
+    fprintf(stderr, "%s:%u: %s\n", path, line, message);
+    exit(2);
+}
+
+/*
+ * Function: add_event
+ * Description: Appends an event to the script, growing the array as needed
+ */
+static HalEvent* add_event(uint64_t time, HalEventType type, unsigned int value) {
+    static unsigned int capacity;
+    if (event_count == capacity) {
+        capacity = capacity ? capacity * 2 : 64;
+        events = realloc(events, capacity * sizeof(HalEvent));
+        if (!events) {
+            fprintf(stderr, "hal: out of memory for the input script\n");
+            exit(2);
+        }
+    }
+    HalEvent* event = &events[event_count];
+    event->time = time;
+    event->order = event_count++;
+    event->type = type;
+    event->value = value;
+    event->file = 0;
+    return event;
+}
+
+static int compare_events(const void* a, const void* b) {
+    const HalEvent* first = (const HalEvent*)a;
+    const HalEvent* second = (const HalEvent*)b;
+    if (first->time != second->time) return (first->time < second->time) ? -1 : 1;
+    return (first->order < second->order) ? -1 : (first->order > second->order);
+}
+
+/*
+ * Function: load_script
+ * Description: Reads the input script into a time ordered event list
+ */
+static void load_script(const char* path) {
+    char text[SCRIPT_LINE_LENGTH];
+    unsigned int line = 0;
+    uint64_t previous = 0;
+    FILE* file = fopen(path, "r");
+
+    if (!file) {
+        fprintf(stderr, "hal: cannot open input script %s\n", path);
+        exit(2);
+    }
+    while (fgets(text, sizeof(text), file)) {
+        char time_text[32], command[32], argument[SCRIPT_LINE_LENGTH];
+        char* comment = strchr(text, '#');
+        char* end;
+        uint64_t time;
+        int fields;
+
+        line++;
+        if (comment) *comment = '\0';
+        argument[0] = '\0';
+        fields = sscanf(text, "%31s %31s %255s", time_text, command, argument);
+        if (fields <= 0) continue;
+        if (fields < 2) script_fail(path, line, "expected <ms> <command>");
+
+        time = strtoull(time_text + (time_text[0] == '+'), &end, 10) * COUNTS_PER_MS;
+        if (*end != '\0') script_fail(path, line, "bad time");
+        if (time_text[0] == '+') time += previous;
+        if (time < previous) script_fail(path, line, "events must be in time order");
+        previous = time;
+
+        unsigned long value = strtoul(argument, &end, 0);
+        bool numeric = fields == 3 && *end == '\0';
+        if (strcmp(command, "keys") == 0 && numeric) {
+            add_event(time, EVENT_KEYS, (unsigned int)value & 0xF);
+        } else if (strcmp(command, "press") == 0 && numeric && value < 4) {
+            add_event(time, EVENT_KEY_DOWN, 1u << value);
+            add_event(time + HAL_PRESS_MS * COUNTS_PER_MS, EVENT_KEY_UP, 1u << value);
+        } else if (strcmp(command, "switches") == 0 && numeric) {
+            add_event(time, EVENT_SWITCHES, (unsigned int)value & 0x3FF);
+        } else if (strcmp(command, "snapshot") == 0 && fields == 3) {
+            HalEvent* event = add_event(time, EVENT_SNAPSHOT, 0);
+            event->file = strdup(argument);
+        } else if (strcmp(command, "quit") == 0) {
+            add_event(time, EVENT_QUIT, 0);
+        } else {
+            script_fail(path, line, "unknown command or bad argument");
+        }
+    }
+    fclose(file);
+
+    // A press may release after later events
+    if (event_count) qsort(events, event_count, sizeof(HalEvent), compare_events);
+    for (unsigned int i = 0; i < event_count; i++) {
+        if (events[i].time > last_event_time) last_event_time = events[i].time;
+    }
+}
+
+/*
+ * Function: random_next
+ * Description: xorshift64* step of the random player
+ */
+static uint32_t random_next(void) {
+    random_state ^= random_state >> 12;
+    random_state ^= random_state << 25;
+    random_state ^= random_state >> 27;
+    return (uint32_t)((random_state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+/*
+ * Function: next_pending_event
+ * Description: Returns the next event not yet applied, making up a random action when the
+ *              script is used up and the random player is on. NULL if there is none.
+ */
+static const HalEvent* next_pending_event(void) {
+    if (next_event == event_count && random_input) {
+        uint64_t time = (clock_now() > last_event_time) ? clock_now() : last_event_time;
+        uint32_t action = random_next() % 8;
+
+        // Every event so far has been applied, so the array is reused
+        event_count = next_event = 0;
+        time += (RANDOM_GAP_MIN_MS + random_next() % RANDOM_GAP_SPAN_MS) * (uint64_t)COUNTS_PER_MS;
+        if (action < 6) {
+            unsigned int key = random_next() % 4;
+            add_event(time, EVENT_KEY_DOWN, 1u << key);
+            add_event(time + HAL_PRESS_MS * COUNTS_PER_MS, EVENT_KEY_UP, 1u << key);
+            last_event_time = time + HAL_PRESS_MS * COUNTS_PER_MS;
+        } else {
+            // Mostly small numbers, so some entered answers are right
+            add_event(time, EVENT_SWITCHES, (action == 6) ? random_next() % 16 : random_next() & 0x3FF);
+            last_event_time = time;
+        }
+    }
+    return (next_event < event_count) ? &events[next_event] : 0;
+}
+
+/*
+ * Function: peak_rss_kb
+ * Description: Peak resident set size of the process
+ */
+static long peak_rss_kb(void) {
+    struct rusage usage;
+    return (getrusage(RUSAGE_SELF, &usage) == 0) ? usage.ru_maxrss : 0;
+}
+
+/*
+ * Function: write_frame
+ * Description: Writes the framebuffer as a binary PPM
+ */
+static bool write_frame(const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (!file) return false;
+    fprintf(file, "P6\n%d %d\n255\n", HAL_LCD_WIDTH, HAL_LCD_HEIGHT);
+    for (unsigned int i = 0; i < HAL_LCD_WIDTH * HAL_LCD_HEIGHT; i++) {
+        unsigned short colour = framebuffer[i];
+        unsigned char rgb[3] = {
+            (unsigned char)(((colour >> 11) & 0x1F) * 255 / 31),
+            (unsigned char)(((colour >> 5) & 0x3F) * 255 / 63),
+            (unsigned char)((colour & 0x1F) * 255 / 31)
+        };
+        fwrite(rgb, 1, sizeof(rgb), file);
+    }
+    return fclose(file) == 0;
+}
+
+/*
+ * Function: write_wav_header
+ * Description: Writes the header of a mono 32-bit PCM WAV holding audio_samples samples
+ */
+static void write_wav_header(FILE* file) {
+    uint32_t data_bytes = audio_samples * 4;
+    uint32_t header[11] = {
+        0x46464952u, 36 + data_bytes, 0x45564157u,          // "RIFF", length, "WAVE"
+        0x20746D66u, 16, 1u | (1u << 16),                     // "fmt ", PCM, mono
+        AUDIO_RATE, AUDIO_RATE * 4, 4u | (32u << 16),         // rate, bytes per second, block size, bits
+        0x61746164u, data_bytes                               // "data", length
+    };
+    fseek(file, 0, SEEK_SET);
+    fwrite(header, sizeof(header), 1, file);
+    fseek(file, 0, SEEK_END);
+}
+
+/*
+ * Function: run_events
+ * Description: Applies every scripted event that is due. Returns true if the key levels changed.
+ */
+static bool run_events(void) {
+    bool keys_changed = false;
+
+    const HalEvent* pending;
+
+    while ((pending = next_pending_event()) != 0 && pending->time <= clock_now()) {
+        HalEvent* event = &events[next_event++];
+        unsigned int previous_keys = key_levels;
+        switch (event->type) {
+            case EVENT_KEYS:     key_levels = event->value; break;
+            case EVENT_KEY_DOWN: key_levels |= event->value; break;
+            case EVENT_KEY_UP:   key_levels &= ~event->value; break;
+            case EVENT_SWITCHES: switch_levels = event->value; break;
+            case EVENT_SNAPSHOT:
+                if (!write_frame(event->file)) fprintf(stderr, "hal: cannot write %s\n", event->file);
+                break;
+            case EVENT_QUIT:
+                printf("hal: input script quit at %llu ms\n", (unsigned long long)(clock_now() / COUNTS_PER_MS));
+                exit(0);
+        }
+        keys_changed |= key_levels != previous_keys;
+    }
+
+    if (!random_input && next_event == event_count && clock_now() - last_event_time > (uint64_t)HAL_IDLE_LIMIT_S * HAL_TIMER_HZ) {
+        fprintf(stderr, "hal: no input for %d s after the end of the script, stopping\n", HAL_IDLE_LIMIT_S);
+        exit(3);
+    }
+    // Only while input keeps coming: a script that has run out is caught by the idle limit above
+    if (game_state != NO_STATE && (random_input || next_event < event_count) && clock_now() - state_since > (uint64_t)HAL_STUCK_S * HAL_TIMER_HZ) {
+        fprintf(stderr, "hal: game stuck in state %u for %d s (keys %X, switches %03X)\n", game_state, HAL_STUCK_S,
+                key_levels, switch_levels);
+        stuck_state = game_state;
+        exit(4);
+    }
+    return keys_changed;
+}
+
+/**
+ * Function: Hal_initialise
+ * Description: Starts virtual time at zero, loads the input script (HAL_INPUT), sets up the
+ *              random player (HAL_RANDOM_SEED). Outputs are flushed when the process exits.
+ * Input(s): None
+ * Return: void
+ */
+void Hal_initialise(void) {
+    const char* input = getenv("HAL_INPUT");
+    const char* seed = getenv("HAL_RANDOM_SEED");
+    const char* games = getenv("HAL_GAMES");
+    const char* report = getenv("HAL_REPORT_FD");
+
+    if (hal_started) return;
+    hal_started = true;
+    virtual_counts = 0;
+    game_thread = pthread_self();
+
+    if (input) load_script(input);
+    if (seed) {
+        random_input = true;
+        random_state = strtoull(seed, 0, 0) * 0x9E3779B97F4A7C15ULL + 1; // Never zero
+    }
+    if (!input && !seed) {
+        printf("hal: no HAL_INPUT script, the keys stay released\n");
+    }
+    if (games) games_limit = (unsigned int)strtoul(games, 0, 0);
+    if (report) report_fd = atoi(report);
+    atexit(Hal_shutdown);
+}
+
+/**
+ * Function: Hal_audioInitialise
+ * Description: Creates the WAV file that stands in for the codec (HAL_AUDIO)
+ * Input(s): None
+ * Return: void
+ */
+void Hal_audioInitialise(void) {
+    const char* audio = getenv("HAL_AUDIO");
+
+    if (!audio || audio_file) return;
+    audio_file = fopen(audio, "wb");
+    if (!audio_file) {
+        fprintf(stderr, "hal: cannot create %s\n", audio);
+        exit(2);
+    }
+    write_wav_header(audio_file);
+}
+
+/**
+ * Function: Hal_shutdown
+ * Description: Writes the final frame (HAL_FRAME) and completes the WAV file
+ * Input(s): None
+ * Return: void
+ */
+void Hal_shutdown(void) {
+    const char* frame = getenv("HAL_FRAME");
+
+    if (!hal_started) return;
+    hal_started = false;
+    if (frame && !write_frame(frame)) {
+        fprintf(stderr, "hal: cannot write %s\n", frame);
+    }
+    if (audio_file) {
+        write_wav_header(audio_file);
+        fclose(audio_file);
+        audio_file = 0;
+    }
+    if (sd_image) {
+        fclose(sd_image);
+        sd_image = 0;
+    }
+    printf("hal: %llu ms virtual time, HEX5-HEX0 %02X %02X %02X %02X %02X %02X, %lu audio samples, %u games\n",
+           (unsigned long long)(clock_now() / COUNTS_PER_MS), seven_seg[5], seven_seg[4], seven_seg[3],
+           seven_seg[2], seven_seg[1], seven_seg[0], (unsigned long)audio_samples, games_played);
+    if (report_fd >= 0) {
+        // One line for tools/simulate.c
+        char line[160];
+        long rss = peak_rss_kb();
+        int length = snprintf(line, sizeof(line), "games=%u changes=%u virtual_ms=%llu rss_kb=%ld growth_kb=%ld stuck=%d\n",
+                              games_played, state_changes, (unsigned long long)(clock_now() / COUNTS_PER_MS), rss,
+                              games_played ? rss - rss_first_game_kb : 0,
+                              (stuck_state == NO_STATE) ? -1 : (int)stuck_state);
+        if (write(report_fd, line, length) != length) fprintf(stderr, "hal: report not written\n");
+        close(report_fd);
+        report_fd = -1;
+    }
+}
+
+/**
+ * Function: Hal_gameState
+ * Description: Follows the game state machine: a return to the first state after another
+ *              state counts as a game played, and the run ends once HAL_GAMES have been played
+ * Input(s): unsigned int state - current state, the first state is 0
+ * Return: void
+ */
+void Hal_gameState(unsigned int state) {
+    if (state == game_state) return;
+    if (state == 0 && game_state != NO_STATE) {
+        games_played++;
+        if (games_played == 1) rss_first_game_kb = peak_rss_kb();
+        if (games_limit && games_played >= games_limit) exit(0);
+    }
+    game_state = state;
+    state_since = clock_now();
+    state_changes++;
+}
+
+/**
+ * Function: Hal_readKeys
+ * Description: Reads the scripted push button levels
+ * Input(s): None
+ * Return: unsigned int - KEY0-KEY3 in bits 0-3
+ */
+unsigned int Hal_readKeys(void) {
+    run_events();
+    return key_levels;
+}
+
+/**
+ * Function: Hal_readSwitches
+ * Description: Reads the scripted slide switch levels
+ * Input(s): None
+ * Return: unsigned int - SW0-SW9 in bits 0-9
+ */
+unsigned int Hal_readSwitches(void) {
+    run_events();
+    return switch_levels;
+}
+
+/**
+ * Function: Hal_timerCounts
+ * Description: Reads virtual time. Every read costs HAL_POLL_COUNTS, so polling loops make progress.
+ * Input(s): None
+ * Return: uint32_t - counts at HAL_TIMER_HZ
+ */
+uint32_t Hal_timerCounts(void) {
+    uint64_t now = __atomic_add_fetch(&virtual_counts, HAL_POLL_COUNTS, __ATOMIC_RELAXED);
+    run_events();
+    return (uint32_t)now;
+}
+
+/**
+ * Function: Hal_cycles
+ * Description: Reads the wall clock, so profiles measure the host's real work rather than virtual time
+ * Input(s): None
+ * Return: uint32_t - nanoseconds
+ */
+uint32_t Hal_cycles(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec);
+}
+
+/**
+ * Function: Hal_globalCounts
+ * Description: Reads the wall clock, like Hal_cycles but without wrapping
+ * Input(s): None
+ * Return: uint64_t - nanoseconds
+ */
+uint64_t Hal_globalCounts(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * Function: Hal_coreId
+ * Description: Tells the game thread (the one that called Hal_initialise) from the worker thread
+ * Input(s): None
+ * Return: unsigned int - 0 for the game thread, 1 otherwise
+ */
+unsigned int Hal_coreId(void) {
+    return pthread_equal(pthread_self(), game_thread) ? 0 : 1;
+}
+
+/**
+ * Function: Hal_sleep
+ * Description: Jumps virtual time to the deadline, or to the first scripted key change before it
+ * Input(s): uint32_t counts - counts to sleep for
+ * Return: uint32_t - counts that passed
+ */
+uint32_t Hal_sleep(uint32_t counts) {
+    uint64_t start = clock_now();
+    uint64_t deadline = start + counts;
+
+    const HalEvent* pending;
+
+    while ((pending = next_pending_event()) != 0 && pending->time <= deadline) {
+        clock_advance_to(pending->time);
+        if (run_events()) return (uint32_t)(clock_now() - start); // Woken by a key
+    }
+    clock_advance_to(deadline);
+    run_events();
+    return (uint32_t)(clock_now() - start);
+}
+
+/**
+ * Function: Hal_feedWatchdog
+ * Description: There is no watchdog on the host
+ * Input(s): None
+ * Return: void
+ */
+void Hal_feedWatchdog(void) {
+}
+
+/**
+ * Function: Hal_sevenSegWrite
+ * Description: Records the segments of one display
+ * Input(s): unsigned int display, uint8_t segments - active high, gfedcba
+ * Return: void
+ */
+void Hal_sevenSegWrite(unsigned int display, uint8_t segments) {
+    if (display < HAL_SEVEN_SEG_DISPLAYS) seven_seg[display] = segments;
+}
+
+/**
+ * Function: Hal_sevenSegSetSingle
+ * Description: Shows a hex digit on one display
+ * Input(s): unsigned int display, unsigned int value
+ * Return: void
+ */
+void Hal_sevenSegSetSingle(unsigned int display, unsigned int value) {
+    Hal_sevenSegWrite(display, hex_segments[value & 0xF]);
+}
+
+/**
+ * Function: Hal_sevenSegSetDoubleDec
+ * Description: Shows a two digit decimal number on a pair of displays
+ * Input(s): unsigned int display - lower display of the pair, unsigned int value
+ * Return: void
+ */
+void Hal_sevenSegSetDoubleDec(unsigned int display, unsigned int value) {
+    Hal_sevenSegWrite(display, hex_segments[value % 10]);
+    Hal_sevenSegWrite(display + 1, hex_segments[(value / 10) % 10]);
+}
+
+/**
+ * Function: Hal_lcdWindow
+ * Description: Sets the framebuffer window and moves to its top left pixel
+ * Input(s): unsigned int x, y, width, height
+ * Return: bool - false if the window is empty or off the screen
+ */
+bool Hal_lcdWindow(unsigned int x, unsigned int y, unsigned int width, unsigned int height) {
+    if (width == 0 || height == 0 || x >= HAL_LCD_WIDTH || y >= HAL_LCD_HEIGHT ||
+        width > HAL_LCD_WIDTH - x || height > HAL_LCD_HEIGHT - y) {
+        return false;
+    }
+    window_left = cursor_x = x;
+    window_top = cursor_y = y;
+    window_right = x + width;
+    window_bottom = y + height;
+    return true;
+}
+
+/**
+ * Function: Hal_lcdWrite
+ * Description: Writes the next pixel of the window, wrapping back to its top left at the end
+ * Input(s): unsigned short colour - RGB565
+ * Return: void
+ */
+void Hal_lcdWrite(unsigned short colour) {
+    if (window_right == 0) return;
+    framebuffer[cursor_y * HAL_LCD_WIDTH + cursor_x] = colour;
+    if (++cursor_x == window_right) {
+        cursor_x = window_left;
+        if (++cursor_y == window_bottom) cursor_y = window_top;
+    }
+}
+
+/**
+ * Function: Hal_lcdCopy
+ * Description: Copies an image into the framebuffer
+ * Input(s): const unsigned short* pixels, unsigned int x, y, width, height
+ * Return: void
+ */
+void Hal_lcdCopy(const unsigned short* pixels, unsigned int x, unsigned int y, unsigned int width, unsigned int height) {
+    if (!Hal_lcdWindow(x, y, width, height)) return;
+    for (unsigned int row = 0; row < height; row++) {
+        memcpy(&framebuffer[(y + row) * HAL_LCD_WIDTH + x], &pixels[row * width], width * sizeof(unsigned short));
+    }
+}
+
+/**
+ * Function: Hal_audioSpace
+ * Description: Free FIFO slots, draining one sample per codec period of virtual time. The game
+ *              thread finding the FIFO full is waiting for the codec, so time moves on until a
+ *              slot frees. The render worker plays sounds alongside the game, so it only gets
+ *              the slots core 0's time has freed; otherwise a sound would pass in an instant of
+ *              virtual time and be charged to whatever core 0 was timing.
+ * Input(s): None
+ * Return: unsigned int - samples that can be written
+ */
+unsigned int Hal_audioSpace(void) {
+    uint64_t now = clock_now();
+    uint64_t queued;
+
+    if (audio_empty_at <= now) return AUDIO_FIFO_SIZE;
+    queued = (audio_empty_at - now + COUNTS_PER_SAMPLE - 1) / COUNTS_PER_SAMPLE;
+    if (queued >= AUDIO_FIFO_SIZE) {
+        if (Hal_coreId() != 0) return 0;
+        clock_advance_to(audio_empty_at - (uint64_t)(AUDIO_FIFO_SIZE - 1) * COUNTS_PER_SAMPLE);
+        return 1;
+    }
+    return AUDIO_FIFO_SIZE - (unsigned int)queued;
+}
+
+/**
+ * Function: Hal_audioWrite
+ * Description: Queues a sample in the virtual FIFO and appends it to the WAV output
+ * Input(s): signed int sample
+ * Return: void
+ */
+void Hal_audioWrite(signed int sample) {
+    int32_t pcm = sample;
+    uint64_t now = clock_now();
+
+    if (audio_empty_at < now) audio_empty_at = now;
+    audio_empty_at += COUNTS_PER_SAMPLE;
+    audio_samples++;
+    if (audio_file) fwrite(&pcm, sizeof(pcm), 1, audio_file);
+}
+
+/*
+ * FatFS disk interface: drive 0 is the image file named by HAL_SD_IMAGE (sd.img by default)
+ */
+DSTATUS disk_initialize(BYTE pdrv) {
+    const char* path = getenv("HAL_SD_IMAGE");
+
+    if (pdrv != 0) return STA_NOINIT;
+    if (!sd_image) sd_image = fopen(path ? path : "sd.img", "r+b");
+    return sd_image ? 0 : STA_NOINIT;
+}
+
+DSTATUS disk_status(BYTE pdrv) {
+    return (pdrv == 0 && sd_image) ? 0 : STA_NOINIT;
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE* buff, HalSector sector, UINT count) {
+    if (pdrv != 0 || !sd_image) return RES_NOTRDY;
+    if (fseeko(sd_image, (off_t)sector * SD_SECTOR_SIZE, SEEK_SET) != 0) return RES_ERROR;
+    return (fread(buff, SD_SECTOR_SIZE, count, sd_image) == count) ? RES_OK : RES_ERROR;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE* buff, HalSector sector, UINT count) {
+    if (pdrv != 0 || !sd_image) return RES_NOTRDY;
+    if (fseeko(sd_image, (off_t)sector * SD_SECTOR_SIZE, SEEK_SET) != 0) return RES_ERROR;
+    return (fwrite(buff, SD_SECTOR_SIZE, count, sd_image) == count) ? RES_OK : RES_ERROR;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void* buff) {
+    if (pdrv != 0 || !sd_image) return RES_NOTRDY;
+    switch (cmd) {
+        case CTRL_SYNC:
+            return (fflush(sd_image) == 0) ? RES_OK : RES_ERROR;
+        case GET_SECTOR_COUNT:
+            if (fseeko(sd_image, 0, SEEK_END) != 0) return RES_ERROR;
+            *(HalSector*)buff = (HalSector)(ftello(sd_image) / SD_SECTOR_SIZE);
+            return RES_OK;
+        case GET_SECTOR_SIZE:
+            *(WORD*)buff = SD_SECTOR_SIZE;
+            return RES_OK;
+        case GET_BLOCK_SIZE:
+            *(DWORD*)buff = 1;
+            return RES_OK;
+        default:
+            return RES_PARERR;
+    }
+}
+
+// Fixed timestamp, 2024-01-01 00:00, so runs produce identical images
+DWORD get_fattime(void) {
+    return ((DWORD)(2024 - 1980) << 25) | ((DWORD)1 << 21) | ((DWORD)1 << 16);
+}
+
+#endif
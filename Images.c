@@ -7,6 +7,8 @@
 
 
 #include "Images.h"
+
+#if !ASSETS_FROM_PACK // Otherwise read from the SD card asset pack
 //"EndScreenImg" Image Data
 // This array stores pixel data for a 170 x 150 pixel image used to display the end screen.
 // Each element in the array represents a pixel value, and the total number of pixels
@@ -12830,3 +12832,5 @@ const unsigned short StartScreenImg[76800] ={
 		0xFF13, 0xFEF3, 0xFEF3, 0xFEF3, 0xFEF3, 0xFEF2, 0xFED2, 0xFED2, 0xFED2, 0xFED2, 0xFED2, 0xFEB1, 0xFEB1, 0xFEB1, 0xFEB1, 0xFEB1,   // 0x12BF0 (76784) pixels
 		0xFE90, 0xFE90, 0xFE90, 0xFE90, 0xFE90, 0xFE70, 0xFE6F, 0xFE6F, 0xFE6F, 0xFE4F, 0xFE4F, 0xFE4E, 0xFE4E, 0xFE4E, 0xFE2E, 0xFE2E,   // 0x12C00 (76800) pixels
 		};
+
+#endif
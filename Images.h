@@ -11,6 +11,36 @@
 
 #ifndef IMAGES_H_
 #define IMAGES_H_
+
+// Set to 1 to read the images from the SD card asset pack (see AssetPack.h) instead of
+// linking them in. The names below then stand for AssetPack accessor calls.
+#ifndef ASSETS_FROM_PACK
+#define ASSETS_FROM_PACK 0
+#endif
+
+#if ASSETS_FROM_PACK
+#include "AssetPack.h"
+
+#define StartScreenImg AssetPack_pixels(ASSET_StartScreenImg)
+#define SelectLevelImg AssetPack_pixels(ASSET_SelectLevelImg)
+#define EasyQues_1 AssetPack_pixels(ASSET_EasyQues_1)
+#define EasyQues_2 AssetPack_pixels(ASSET_EasyQues_2)
+#define EasyQues_3 AssetPack_pixels(ASSET_EasyQues_3)
+#define MedQues_1 AssetPack_pixels(ASSET_MedQues_1)
+#define MedQues_2 AssetPack_pixels(ASSET_MedQues_2)
+#define MedQues_3 AssetPack_pixels(ASSET_MedQues_3)
+#define HardQues_1 AssetPack_pixels(ASSET_HardQues_1)
+#define HardQues_2 AssetPack_pixels(ASSET_HardQues_2)
+#define HardQues_3 AssetPack_pixels(ASSET_HardQues_3)
+#define right AssetPack_pixels(ASSET_right)
+#define wrong AssetPack_pixels(ASSET_wrong)
+#define Contplaying AssetPack_pixels(ASSET_Contplaying)
+#define EndScreenImg AssetPack_pixels(ASSET_EndScreenImg)
+// The digit images are only reached through DigitImg, their one-word names are left free.
+// Only the digit drawn is looked up, so a cold cache reads one image, not all ten.
+#define DigitImg(digit) AssetPack_pixels((AssetId)(ASSET_zero + (digit)))
+
+#else
 // Image data for the start screen, dimension: 320 x 240 (width x height)
 extern const unsigned short StartScreenImg[76800];
 
@@ -56,5 +86,8 @@ extern const unsigned short EndScreenImg[25500];
 
 // Array of pointers to the digit images, facilitating easy access to any digit image
 extern const unsigned short *const Num[10];
+#define DigitImg(digit) Num[digit]
+
+#endif
 
 #endif
@@ -0,0 +1,84 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Fixed-bucket latency histogram. Adding a sample is a division and an increment, so it
+ * can sit in the path being measured; percentiles walk the 64 cumulative counts.
+ */
+
+#include "LatencyHistogram.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * Function: LatencyHistogram_initialise
+ * Description: Clears the histogram and sets its bucket width
+ * Input(s): LatencyHistogram* histogram, uint32_t bucket_us - bucket width in microseconds
+ * Return: void
+ */
+void LatencyHistogram_initialise(LatencyHistogram* histogram, uint32_t bucket_us) {
+    memset(histogram, 0, sizeof(*histogram));
+    histogram->bucket_us = bucket_us ? bucket_us : 1;
+    histogram->min_us = UINT32_MAX;
+}
+
+/**
+ * Function: LatencyHistogram_add
+ * Description: Records one duration
+ * Input(s): LatencyHistogram* histogram, uint32_t us - duration in microseconds
+ * Return: void
+ */
+void LatencyHistogram_add(LatencyHistogram* histogram, uint32_t us) {
+    uint32_t bucket = us / histogram->bucket_us;
+    if (bucket >= LATENCY_BUCKETS) bucket = LATENCY_BUCKETS - 1;
+
+    histogram->counts[bucket]++;
+    histogram->samples++;
+    histogram->total_us += us;
+    if (us < histogram->min_us) histogram->min_us = us;
+    if (us > histogram->max_us) histogram->max_us = us;
+}
+
+/**
+ * Function: LatencyHistogram_percentile
+ * Description: Returns an upper bound on the given percentile
+ * Input(s): const LatencyHistogram* histogram, uint32_t percent - 0 to 100
+ * Return: uint32_t - microseconds, 0 if there are no samples
+ */
+uint32_t LatencyHistogram_percentile(const LatencyHistogram* histogram, uint32_t percent) {
+    // Smallest rank that covers the percentile, rounded up
+    uint64_t rank = ((uint64_t)histogram->samples * percent + 99) / 100;
+    uint64_t seen = 0;
+
+    if (histogram->samples == 0) return 0;
+    if (rank == 0) rank = 1;
+    for (uint32_t i = 0; i < LATENCY_BUCKETS - 1; i++) {
+        seen += histogram->counts[i];
+        if (seen >= rank) {
+            uint32_t upper = (i + 1) * histogram->bucket_us;
+            return (upper < histogram->max_us) ? upper : histogram->max_us;
+        }
+    }
+    return histogram->max_us;
+}
+
+/**
+ * Function: LatencyHistogram_report
+ * Description: Prints the latency distribution and whether p99 meets the budget
+ * Input(s): const LatencyHistogram* histogram, const char* name, uint32_t budget_us
+ * Return: bool - true if p99 is within budget (or there were no samples)
+ */
+bool LatencyHistogram_report(const LatencyHistogram* histogram, const char* name, uint32_t budget_us) {
+    uint32_t p99 = LatencyHistogram_percentile(histogram, 99);
+    bool within = p99 <= budget_us;
+
+    if (histogram->samples == 0) {
+        printf("%s: no samples\n", name);
+        return true;
+    }
+    printf("%s: %lu samples, min %luus, mean %luus, p50 %luus, p99 %luus, max %luus, budget %luus: %s\n",
+           name, (unsigned long)histogram->samples, (unsigned long)histogram->min_us,
+           (unsigned long)(histogram->total_us / histogram->samples),
+           (unsigned long)LatencyHistogram_percentile(histogram, 50), (unsigned long)p99,
+           (unsigned long)histogram->max_us, (unsigned long)budget_us, within ? "PASS" : "FAIL");
+    return within;
+}
@@ -0,0 +1,40 @@
+/*
+* LatencyHistogram.h
+*
+* Fixed-bucket latency histogram
+*
+* Records durations in microseconds into linear buckets without allocating, and answers
+* percentile queries from the cumulative counts. Used to check that time-critical paths
+* (e.g. the blitz question transition) stay within their budget.
+*/
+
+#ifndef LATENCYHISTOGRAM_H_
+#define LATENCYHISTOGRAM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LATENCY_BUCKETS 64
+
+typedef struct {
+    uint32_t bucket_us;                 // Width of each bucket
+    uint32_t counts[LATENCY_BUCKETS];   // The last bucket also holds everything beyond it
+    uint32_t samples;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t total_us;
+} LatencyHistogram;
+
+// Start an empty histogram covering LATENCY_BUCKETS * bucket_us microseconds
+void LatencyHistogram_initialise(LatencyHistogram* histogram, uint32_t bucket_us);
+
+// Record one duration
+void LatencyHistogram_add(LatencyHistogram* histogram, uint32_t us);
+
+// Upper bound of the bucket holding the given percentile (0-100), the maximum for the top bucket
+uint32_t LatencyHistogram_percentile(const LatencyHistogram* histogram, uint32_t percent);
+
+// Print min/mean/p50/p99/max against a budget. Returns true if p99 is within the budget.
+bool LatencyHistogram_report(const LatencyHistogram* histogram, const char* name, uint32_t budget_us);
+
+#endif
@@ -0,0 +1,183 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Deferred logger. Log_write copies six words into a ring slot; all formatting happens
+ * in Log_drain, which walks each format itself so every argument is passed to printf
+ * with the type its conversion expects.
+ */
+
+#include "Log.h"
+#include "Hal.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SPEC_MAX 16   // Longest conversion specification, e.g. "%-08lx"
+
+typedef char log_ring_size_must_be_power_of_two[(LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0 ? 1 : -1];
+
+typedef struct {
+    const char* format;
+    unsigned int count;
+    uintptr_t args[LOG_MAX_ARGS];
+} LogMessage;
+
+// Written and drained on core 0 only, so plain indices are enough
+static LogMessage log_ring[LOG_RING_SIZE];
+static uint32_t log_head;
+static uint32_t log_tail;
+static LogStats log_stats;
+
+/**
+ * Function: Log_write
+ * Description: Stores a format and its raw arguments for the next drain
+ * Input(s): const char* format, unsigned int count - arguments used, uintptr_t a, b, c, d
+ * Return: void
+ */
+void Log_write(const char* format, unsigned int count, uintptr_t a, uintptr_t b, uintptr_t c, uintptr_t d) {
+    uint32_t waiting = log_head - log_tail;
+    LogMessage* message;
+
+    if (waiting >= LOG_RING_SIZE) {
+        log_stats.dropped++;
+        return;
+    }
+    message = &log_ring[log_head & (LOG_RING_SIZE - 1)];
+    message->format = format;
+    message->count = count;
+    message->args[0] = a;
+    message->args[1] = b;
+    message->args[2] = c;
+    message->args[3] = d;
+    log_head++;
+    log_stats.written++;
+    if (waiting + 1 > log_stats.high_water) log_stats.high_water = waiting + 1;
+}
+
+/*
+ * Function: print_message
+ * Description: Prints one message, handing each conversion to printf with its own argument type
+ */
+static void print_message(const LogMessage* message) {
+    const char* text = message->format;
+    unsigned int next = 0;
+
+    while (*text) {
+        const char* percent = strchr(text, '%');
+        char spec[SPEC_MAX + 1];
+        size_t length;
+        uintptr_t arg;
+        bool is_long;
+
+        if (!percent) {
+            fputs(text, stdout);
+            return;
+        }
+        if (percent > text) printf("%.*s", (int)(percent - text), text);
+        if (percent[1] == '%') {
+            putchar('%');
+            text = percent + 2;
+            continue;
+        }
+
+        // Flags, width, precision and length up to the conversion character
+        length = strspn(percent + 1, "-+ #0123456789.l") + 1;
+        if (length > SPEC_MAX - 1 || percent[length] == '\0') {
+            fputs(percent, stdout); // Malformed, print it as it is
+            return;
+        }
+        memcpy(spec, percent, length + 1);
+        spec[length + 1] = '\0';
+        is_long = memchr(spec, 'l', length) != 0;
+        arg = (next < message->count) ? message->args[next] : 0;
+        next++;
+
+        switch (percent[length]) {
+            case 'd': case 'i':
+                if (is_long) printf(spec, (long)(intptr_t)arg); else printf(spec, (int)(intptr_t)arg);
+                break;
+            case 'u': case 'x': case 'X': case 'o':
+                if (is_long) printf(spec, (unsigned long)arg); else printf(spec, (unsigned int)arg);
+                break;
+            case 'c':
+                printf(spec, (int)arg);
+                break;
+            case 's':
+                printf(spec, arg ? (const char*)arg : "(null)");
+                break;
+            case 'p':
+                printf(spec, (void*)arg);
+                break;
+            default:
+                fputs(spec, stdout); // Unsupported conversion, e.g. floating point
+                break;
+        }
+        text = percent + length + 1;
+    }
+}
+
+/**
+ * Function: Log_drain
+ * Description: Formats and prints every stored message, oldest first, then any drop count
+ * Input(s): None
+ * Return: unsigned int - messages printed
+ */
+unsigned int Log_drain(void) {
+    static uint32_t dropped_reported;
+    unsigned int printed = 0;
+
+    while (log_tail != log_head) {
+        print_message(&log_ring[log_tail & (LOG_RING_SIZE - 1)]);
+        log_tail++;
+        printed++;
+    }
+    if (log_stats.dropped != dropped_reported) {
+        printf("Log: %lu messages dropped, the ring was full\n", (unsigned long)(log_stats.dropped - dropped_reported));
+        dropped_reported = log_stats.dropped;
+    }
+    return printed;
+}
+
+/**
+ * Function: Log_benchmark
+ * Description: Times printf and Log_write on the same message with the cycle counter. The
+ *              benchmark's own messages are taken back out of the ring afterwards.
+ * Input(s): unsigned int calls - messages of each kind, at most the free space in the ring
+ * Return: void
+ */
+void Log_benchmark(unsigned int calls) {
+    uint32_t free_slots = LOG_RING_SIZE - (log_head - log_tail);
+    uint32_t head = log_head, written = log_stats.written, high_water = log_stats.high_water;
+    uint32_t start, printf_counts, log_counts;
+
+    if (calls > free_slots) calls = free_slots;
+    if (calls == 0) return;
+
+    start = Hal_cycles();
+    for (unsigned int i = 0; i < calls; i++) {
+        printf("Log benchmark %u of %u, score %d\n", i, calls, -1);
+    }
+    printf_counts = Hal_cycles() - start;
+
+    start = Hal_cycles();
+    for (unsigned int i = 0; i < calls; i++) {
+        Log_write("Log benchmark %u of %u, score %d\n", 3, (uintptr_t)i, (uintptr_t)calls, (uintptr_t)-1, 0);
+    }
+    log_counts = Hal_cycles() - start;
+
+    log_head = head;
+    log_stats.written = written;
+    log_stats.high_water = high_water;
+    printf("Log: printf %lu ns per call, Log_write %lu ns per call (%u calls each)\n",
+           (unsigned long)((uint64_t)printf_counts * 1000000000u / HAL_CYCLE_HZ / calls),
+           (unsigned long)((uint64_t)log_counts * 1000000000u / HAL_CYCLE_HZ / calls), calls);
+}
+
+/**
+ * Function: Log_stats
+ * Description: Returns the logger counters
+ * Input(s): None
+ * Return: const LogStats* - counters
+ */
+const LogStats* Log_stats(void) {
+    return &log_stats;
+}
@@ -0,0 +1,81 @@
+/*
+* Log.h
+*
+* Deferred binary logger
+*
+* printf on the board goes out over the UART and can block for milliseconds per line.
+* LOG_ERROR/LOG_INFO/LOG_DEBUG instead store a pointer to the format string and up to
+* four raw arguments in a ring buffer, which costs about as much as a function call.
+* Log_drain formats and prints the stored messages later, when the game is idle, and
+* drops nothing it has room for; when the ring is full new messages are counted and lost.
+*
+* Levels above LOG_LEVEL are compiled out, though their arguments are still type checked. Formats may use the
+* conversions d i u x X o c s p, with an l modifier, flags, width and precision. A %s
+* argument must stay valid until the next drain: string literals and question text are
+* fine, a local buffer is not.
+*/
+
+#ifndef LOG_H_
+#define LOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LOG_LEVEL_ERROR 0
+#define LOG_LEVEL_INFO  1
+#define LOG_LEVEL_DEBUG 2
+
+// Highest level compiled in
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#define LOG_RING_SIZE 64     // Messages held between drains, must be a power of two
+#define LOG_MAX_ARGS 4
+
+typedef struct {
+    uint32_t written;        // Messages stored
+    uint32_t dropped;        // Messages lost to a full ring
+    uint32_t high_water;     // Most messages waiting at once
+} LogStats;
+
+// Store a message; use the LOG_* macros rather than calling this directly
+void Log_write(const char* format, unsigned int count, uintptr_t a, uintptr_t b, uintptr_t c, uintptr_t d);
+
+// Format and print every stored message. Returns the number printed.
+unsigned int Log_drain(void);
+
+// Time calls of Log_write against printf of the same message, and print the result
+void Log_benchmark(unsigned int calls);
+
+// Logger counters
+const LogStats* Log_stats(void);
+
+// Pack a format and 0-4 arguments as Log_write parameters
+#define LOG_PACK_SELECT(format, a, b, c, d, name, ...) name
+#define LOG_PACK0(format) format, 0, 0, 0, 0, 0
+#define LOG_PACK1(format, a) format, 1, (uintptr_t)(a), 0, 0, 0
+#define LOG_PACK2(format, a, b) format, 2, (uintptr_t)(a), (uintptr_t)(b), 0, 0
+#define LOG_PACK3(format, a, b, c) format, 3, (uintptr_t)(a), (uintptr_t)(b), (uintptr_t)(c), 0
+#define LOG_PACK4(format, a, b, c, d) format, 4, (uintptr_t)(a), (uintptr_t)(b), (uintptr_t)(c), (uintptr_t)(d)
+#define LOG_PACK(...) LOG_PACK_SELECT(__VA_ARGS__, LOG_PACK4, LOG_PACK3, LOG_PACK2, LOG_PACK1, LOG_PACK0, 0)(__VA_ARGS__)
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) Log_write(LOG_PACK(__VA_ARGS__))
+#else
+#define LOG_ERROR(...) do { if (0) Log_write(LOG_PACK(__VA_ARGS__)); } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) Log_write(LOG_PACK(__VA_ARGS__))
+#else
+#define LOG_INFO(...) do { if (0) Log_write(LOG_PACK(__VA_ARGS__)); } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) Log_write(LOG_PACK(__VA_ARGS__))
+#else
+#define LOG_DEBUG(...) do { if (0) Log_write(LOG_PACK(__VA_ARGS__)); } while (0)
+#endif
+
+#endif
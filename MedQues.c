@@ -1,5 +1,7 @@
 #include "Images.h"
 
+#if !ASSETS_FROM_PACK // Otherwise read from the SD card asset pack
+
 const unsigned short MedQues_1[25800] ={
 0xFE2E, 0xFE2E, 0xFE2E, 0xFE2E, 0xFE2D, 0xFE2D, 0xF5CB, 0xED49, 0xE507, 0xDCE7, 0xDCE7, 0xDCE7, 0xDCE7, 0xDCE7, 0xDCE7, 0xDCE7,   // 0x0010 (16) pixels
 0xDCE7, 0xDCE7, 0xDCE7, 0xDCE7, 0xDCE7, 0xDCE7, 0xDCE7, 0xDCE7, 0xDCE7, 0xDCE7, 0xDCE7, 0xDCE7, 0xDCE7, 0xDCE7, 0xDCE7, 0xDCE7,   // 0x0020 (32) pixels
@@ -4858,3 +4860,5 @@ const unsigned short MedQues_3[26015] ={
 0xE528, 0xE528, 0xE528, 0xE528, 0xE528, 0xE528, 0xE528, 0xE528, 0xE528, 0xE528, 0xE528, 0xE528, 0xE528, 0xE528, 0xE528, 0xE528,   // 0x6590 (26000) pixels
 0xE528, 0xE528, 0xE528, 0xE528, 0xE528, 0xE528, 0xE528, 0xF5CB, 0xFE2D, 0xFE2E, 0xFE2E, 0xFE2E, 0xFE2E, 0xFE2E, 0xFE2E
 };
+
+#endif
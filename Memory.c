@@ -0,0 +1,110 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Static memory regions. The backing arrays are plain statics, so their size shows up
+ * in the linker map and a build that does not fit in RAM fails to link.
+ */
+
+#include "Memory.h"
+#include "Arena.h"
+#include "Pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static const char* const region_names[MEMORY_REGION_COUNT] = { "audio", "assets" };
+
+static uint8_t audio_memory[MEMORY_AUDIO_BYTES] __attribute__((aligned(ARENA_ALIGNMENT)));
+static uint8_t asset_memory[MEMORY_ASSET_BYTES] __attribute__((aligned(ARENA_ALIGNMENT)));
+static Arena regions[MEMORY_REGION_COUNT];
+
+static FATFS file_system;
+static FIL file_blocks[MEMORY_FILE_BLOCKS];
+static Pool file_pool;
+
+/*
+ * Function: out_of_memory
+ * Description: Prints what did not fit and stops, a smaller buffer would only fail later
+ */
+static void out_of_memory(const char* region, const char* what, size_t size, size_t used, size_t capacity) {
+    printf("Out of memory: %s needs %lu bytes, %s region has %lu of %lu in use\n", what,
+           (unsigned long)size, region, (unsigned long)used, (unsigned long)capacity);
+    exit(1);
+}
+
+/**
+ * Function: Memory_initialise
+ * Description: Sets up empty arenas over the region arrays and frees every file block
+ * Input(s): None
+ * Return: void
+ */
+void Memory_initialise(void) {
+    Arena_initialise(&regions[MEMORY_AUDIO], audio_memory, sizeof(audio_memory));
+    Arena_initialise(&regions[MEMORY_ASSETS], asset_memory, sizeof(asset_memory));
+    Pool_initialise(&file_pool, file_blocks, sizeof(FIL), MEMORY_FILE_BLOCKS);
+}
+
+/**
+ * Function: Memory_alloc
+ * Description: Allocates zeroed memory from a region, stopping the game if it does not fit
+ * Input(s): MemoryRegion region, size_t size - bytes wanted, const char* what - printed on failure
+ * Return: void* - the memory, never NULL
+ */
+void* Memory_alloc(MemoryRegion region, size_t size, const char* what) {
+    void* memory = Arena_alloc(&regions[region], size);
+
+    if (!memory) {
+        out_of_memory(region_names[region], what, size, Arena_used(&regions[region]), regions[region].size);
+    }
+    return memory;
+}
+
+/**
+ * Function: Memory_fileSystem
+ * Description: Returns the filesystem object
+ * Input(s): None
+ * Return: FATFS* - to pass to f_mount
+ */
+FATFS* Memory_fileSystem(void) {
+    return &file_system;
+}
+
+/**
+ * Function: Memory_fileAlloc
+ * Description: Takes a file object from the pool, stopping the game if none is free
+ * Input(s): const char* what - printed on failure
+ * Return: FIL* - zeroed file object, never NULL
+ */
+FIL* Memory_fileAlloc(const char* what) {
+    FIL* file = Pool_alloc(&file_pool);
+
+    if (!file) {
+        out_of_memory("file", what, sizeof(FIL), Pool_inUse(&file_pool) * sizeof(FIL), sizeof(file_blocks));
+    }
+    return file;
+}
+
+/**
+ * Function: Memory_fileFree
+ * Description: Returns a closed file object to the pool
+ * Input(s): FIL* file - from Memory_fileAlloc, or NULL
+ * Return: void
+ */
+void Memory_fileFree(FIL* file) {
+    Pool_free(&file_pool, file);
+}
+
+/**
+ * Function: Memory_report
+ * Description: Prints the bytes in use, peak and capacity of each region, and the file pool
+ * Input(s): None
+ * Return: void
+ */
+void Memory_report(void) {
+    printf("Memory:");
+    for (int region = 0; region < MEMORY_REGION_COUNT; region++) {
+        printf(" %s %lu/%lu bytes (peak %lu),", region_names[region], (unsigned long)Arena_used(&regions[region]),
+               (unsigned long)regions[region].size, (unsigned long)Arena_peak(&regions[region]));
+    }
+    printf(" files %lu/%d open (peak %lu)\n", (unsigned long)Pool_inUse(&file_pool), MEMORY_FILE_BLOCKS,
+           (unsigned long)Pool_peak(&file_pool));
+}
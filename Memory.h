@@ -0,0 +1,49 @@
+/*
+* Memory.h
+*
+* Static memory regions
+*
+* Every buffer that lives for the whole run comes from a region sized at compile time:
+* an arena for the audio samples, an arena for cached assets, and a pool of file
+* objects beside the one filesystem object. Nothing is taken from the heap, so the
+* game cannot fragment it, and running out is found on the first boot rather than
+* after hours of play: an allocation that does not fit prints the region and stops the
+* game. Memory_report prints how close each region has come to full.
+*/
+
+#ifndef MEMORY_H_
+#define MEMORY_H_
+
+#include <stddef.h>
+#include "FatFS/ff.h"
+
+// Region sizes, raise them if a boot stops with an out of memory message
+#ifndef MEMORY_AUDIO_BYTES
+#define MEMORY_AUDIO_BYTES (512 * 1024)   // Samples of every sound effect
+#endif
+#ifndef MEMORY_ASSET_BYTES
+#define MEMORY_ASSET_BYTES (256 * 1024)   // Assets cached from the SD card
+#endif
+#ifndef MEMORY_FILE_BLOCKS
+#define MEMORY_FILE_BLOCKS 4              // Files open at once through Memory_fileAlloc
+#endif
+
+typedef enum { MEMORY_AUDIO, MEMORY_ASSETS, MEMORY_REGION_COUNT } MemoryRegion;
+
+// Set up the regions, before any other Memory call
+void Memory_initialise(void);
+
+// Allocate zeroed memory for the rest of the run. Stops the game if the region is full.
+void* Memory_alloc(MemoryRegion region, size_t size, const char* what);
+
+// The filesystem object to mount
+FATFS* Memory_fileSystem(void);
+
+// Take a file object from the pool, and give it back once closed. Stops the game if the pool is empty.
+FIL* Memory_fileAlloc(const char* what);
+void Memory_fileFree(FIL* file);
+
+// Print use and peak use of every region
+void Memory_report(void);
+
+#endif
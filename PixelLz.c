@@ -0,0 +1,130 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Streaming PixelLz decoder. Each pass of the loop copies as much of the current literal
+ * run or match as fits in the output, so the per-pixel work is a load, a ring store and
+ * an output store.
+ */
+
+#include "PixelLz.h"
+
+#define WINDOW_MASK (PIXELLZ_WINDOW - 1)
+
+typedef char pixellz_window_must_be_power_of_two[(PIXELLZ_WINDOW & WINDOW_MASK) == 0 ? 1 : -1];
+
+/*
+ * Function: read_length
+ * Description: Adds extension bytes to a length whose nibble was 15, false if the data ends first
+ */
+static bool read_length(PixelLzStream* stream, uint32_t* length) {
+    uint8_t byte;
+
+    do {
+        if (stream->in >= stream->end) return false;
+        byte = *stream->in++;
+        *length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+/*
+ * Function: read_token
+ * Description: Starts the next sequence, checking its literals are all there
+ */
+static bool read_token(PixelLzStream* stream) {
+    uint8_t token;
+
+    if (stream->in >= stream->end) return false;
+    token = *stream->in++;
+    stream->literals = token >> 4;
+    stream->match = token & 15;
+    stream->offset_pending = true;
+    if (stream->literals == 15 && !read_length(stream, &stream->literals)) return false;
+    return stream->literals <= (uint32_t)(stream->end - stream->in) / 2;
+}
+
+/*
+ * Function: read_offset
+ * Description: Reads the match offset and length that follow the literals
+ */
+static bool read_offset(PixelLzStream* stream) {
+    if (stream->end - stream->in < 2) return false;
+    stream->offset = stream->in[0] | (uint32_t)stream->in[1] << 8;
+    stream->in += 2;
+    stream->offset_pending = false;
+    if (stream->match == 15 && !read_length(stream, &stream->match)) return false;
+    stream->match += PIXELLZ_MIN_MATCH;
+    return stream->offset != 0 && stream->offset <= PIXELLZ_WINDOW && stream->offset <= stream->produced;
+}
+
+/**
+ * Function: PixelLz_begin
+ * Description: Sets up a stream at the start of a compressed image
+ * Input(s): PixelLzStream* stream, const void* data, size_t size - compressed bytes, uint32_t pixels - in the image
+ * Return: void
+ */
+void PixelLz_begin(PixelLzStream* stream, const void* data, size_t size, uint32_t pixels) {
+    stream->in = (const uint8_t*)data;
+    stream->end = stream->in + size;
+    stream->remaining = pixels;
+    stream->produced = 0;
+    stream->literals = 0;
+    stream->match = 0;
+    stream->offset = 0;
+    stream->offset_pending = false;
+    stream->error = false;
+}
+
+/**
+ * Function: PixelLz_read
+ * Description: Decodes the next pixels of the image. A corrupt stream is not read further and
+ *              the rest of the image comes out black, so a drawing window is always filled.
+ * Input(s): PixelLzStream* stream, unsigned short* pixels - output, unsigned int max - pixels wanted
+ * Return: unsigned int - pixels produced, 0 once the image is complete
+ */
+unsigned int PixelLz_read(PixelLzStream* stream, unsigned short* pixels, unsigned int max) {
+    unsigned int count = 0;
+
+    if (max > stream->remaining) max = stream->remaining;
+    while (count < max) {
+        unsigned int n = max - count;
+        uint32_t position = stream->produced;
+
+        if (stream->error) {
+            for (unsigned int i = 0; i < n; i++) {
+                stream->window[(position + i) & WINDOW_MASK] = 0x0000;
+                pixels[count + i] = 0x0000;
+            }
+        } else if (stream->literals > 0) {
+            const uint8_t* in = stream->in;
+            if (n > stream->literals) n = stream->literals;
+            for (unsigned int i = 0; i < n; i++, in += 2) {
+                unsigned short colour = (unsigned short)(in[0] | in[1] << 8);
+                stream->window[(position + i) & WINDOW_MASK] = colour;
+                pixels[count + i] = colour;
+            }
+            stream->in = in;
+            stream->literals -= n;
+        } else if (stream->offset_pending) {
+            stream->error = !read_offset(stream);
+            continue;
+        } else if (stream->match > 0) {
+            uint32_t from = position - stream->offset;
+            if (n > stream->match) n = stream->match;
+            // Forward copy, so a match may overlap the pixels it is producing
+            for (unsigned int i = 0; i < n; i++) {
+                unsigned short colour = stream->window[(from + i) & WINDOW_MASK];
+                stream->window[(position + i) & WINDOW_MASK] = colour;
+                pixels[count + i] = colour;
+            }
+            stream->match -= n;
+        } else {
+            stream->error = !read_token(stream);
+            continue;
+        }
+        count += n;
+        stream->produced += n;
+    }
+    stream->remaining -= count;
+    return count;
+}
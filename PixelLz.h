@@ -0,0 +1,56 @@
+/*
+* PixelLz.h
+*
+* LZ4-style image compression on RGB565 pixels
+*
+* A compressed image is a list of sequences, each a run of literal pixels followed by a
+* match: a copy of earlier pixels at some distance back. Runs of one colour are matches
+* at distance 1 and repeated rows are matches at the image width, so the flat screens
+* and question bitmaps shrink to a fraction of their size.
+*
+* The decoder streams: PixelLz_read produces the next pixels into a small buffer, so an
+* image goes to the LCD a chunk at a time without ever being whole in RAM. Matches only
+* reach back PIXELLZ_WINDOW pixels, which the stream keeps in a ring.
+*
+* Sequence layout:
+*     token           literal count in the high nibble, match length - PIXELLZ_MIN_MATCH in the low
+*     [count bytes]   if the literal nibble is 15: bytes added to it until one is below 255
+*     literals        count pixels, 2 bytes each, little endian
+*     offset          2 bytes little endian, 1 to PIXELLZ_WINDOW pixels back
+*     [length bytes]  if the match nibble is 15: as for the literal count
+* The image ends as soon as its width x height pixels are out, so the last sequence
+* may stop after its literals.
+*
+* tools/make_asset_pack.c holds the compressor.
+*/
+
+#ifndef PIXELLZ_H_
+#define PIXELLZ_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define PIXELLZ_WINDOW    2048   // Pixels a match can reach back, must be a power of two
+#define PIXELLZ_MIN_MATCH 2      // Shorter repeats are cheaper as literals
+
+typedef struct {
+    const uint8_t* in;
+    const uint8_t* end;
+    uint32_t remaining;          // Pixels still to produce
+    uint32_t produced;
+    uint32_t literals;           // Left in the current sequence
+    uint32_t match;
+    uint32_t offset;
+    bool offset_pending;         // Token read, its offset not yet; match holds the length nibble
+    bool error;                  // Corrupt stream, the rest of the image is black
+    unsigned short window[PIXELLZ_WINDOW];
+} PixelLzStream;
+
+// Start decoding size bytes of compressed data holding pixels pixels
+void PixelLz_begin(PixelLzStream* stream, const void* data, size_t size, uint32_t pixels);
+
+// Decode the next pixels, at most max. Returns how many, 0 once the image is complete.
+unsigned int PixelLz_read(PixelLzStream* stream, unsigned short* pixels, unsigned int max);
+
+#endif
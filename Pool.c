@@ -0,0 +1,87 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Fixed-block pool allocator. The free list lives in the free blocks, so the pool
+ * needs no memory beyond the blocks themselves.
+ */
+
+#include "Pool.h"
+#include <string.h>
+
+/**
+ * Function: Pool_initialise
+ * Description: Sets up a pool with every block free
+ * Input(s): Pool* pool, void* memory, size_t block_size - bytes per block, uint32_t blocks
+ * Return: void
+ */
+void Pool_initialise(Pool* pool, void* memory, size_t block_size, uint32_t blocks) {
+    uint8_t* block = (uint8_t*)memory;
+
+    pool->free = NULL;
+    pool->block_size = block_size;
+    pool->blocks = memory ? blocks : 0;
+    pool->in_use = 0;
+    pool->peak = 0;
+    // Threaded back to front, so blocks are handed out in address order
+    for (uint32_t i = pool->blocks; i > 0; i--) {
+        PoolBlock* free_block = (PoolBlock*)(block + (i - 1) * block_size);
+        free_block->next = pool->free;
+        pool->free = free_block;
+    }
+}
+
+/**
+ * Function: Pool_alloc
+ * Description: Takes a zeroed block from the pool
+ * Input(s): Pool* pool
+ * Return: void* - the block, NULL if every block is in use
+ */
+void* Pool_alloc(Pool* pool) {
+    PoolBlock* block = pool->free;
+
+    if (!block) {
+        return NULL;
+    }
+    pool->free = block->next;
+    pool->in_use++;
+    if (pool->in_use > pool->peak) pool->peak = pool->in_use;
+    memset(block, 0, pool->block_size);
+    return block;
+}
+
+/**
+ * Function: Pool_free
+ * Description: Returns a block to the pool
+ * Input(s): Pool* pool, void* block - from Pool_alloc on this pool, or NULL
+ * Return: void
+ */
+void Pool_free(Pool* pool, void* block) {
+    PoolBlock* free_block = (PoolBlock*)block;
+
+    if (!free_block) {
+        return;
+    }
+    free_block->next = pool->free;
+    pool->free = free_block;
+    pool->in_use--;
+}
+
+/**
+ * Function: Pool_inUse
+ * Description: Returns how many blocks are allocated
+ * Input(s): const Pool* pool
+ * Return: uint32_t - blocks in use
+ */
+uint32_t Pool_inUse(const Pool* pool) {
+    return pool->in_use;
+}
+
+/**
+ * Function: Pool_peak
+ * Description: Returns the most blocks allocated at once
+ * Input(s): const Pool* pool
+ * Return: uint32_t - high-water mark in blocks
+ */
+uint32_t Pool_peak(const Pool* pool) {
+    return pool->peak;
+}
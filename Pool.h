@@ -0,0 +1,44 @@
+/*
+* Pool.h
+*
+* Fixed-block pool allocator
+*
+* Hands out blocks of one size from a block of memory reserved at compile time. Free
+* blocks are kept on a list threaded through the blocks themselves, so allocating and
+* freeing are constant time and the pool never fragments. Used for objects that come
+* and go, such as open files, where an arena could not take them back.
+*/
+
+#ifndef POOL_H_
+#define POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct PoolBlock {
+    struct PoolBlock* next;
+} PoolBlock;
+
+typedef struct {
+    PoolBlock* free;      // First free block
+    size_t block_size;
+    uint32_t blocks;
+    uint32_t in_use;
+    uint32_t peak;        // Most blocks in use at once
+} Pool;
+
+// Use blocks * block_size bytes of memory as a pool. block_size must be at least a pointer
+// and a multiple of the pointer size, as sizeof of any struct holding a pointer is.
+void Pool_initialise(Pool* pool, void* memory, size_t block_size, uint32_t blocks);
+
+// Allocate a zeroed block, NULL if every block is in use
+void* Pool_alloc(Pool* pool);
+
+// Return a block to the pool
+void Pool_free(Pool* pool, void* block);
+
+// Blocks in use now, and the most in use at once
+uint32_t Pool_inUse(const Pool* pool);
+uint32_t Pool_peak(const Pool* pool);
+
+#endif
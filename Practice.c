@@ -0,0 +1,342 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Leitner practice history. Records live in a fixed array; a linear probing hash table
+ * maps question ids to records and a binary min-heap of record indices orders the
+ * questions still in practice by due time. Each record remembers its heap position, so
+ * rescheduling a question after an answer is a single O(log n) sift.
+ */
+
+#include "Practice.h"
+#include "FatFS/ff.h"
+#include <stdio.h>
+#include <string.h>
+
+#define PRACTICE_HASH_SIZE 2048  // Power of two, at least twice PRACTICE_MAX_RECORDS
+#define NOT_IN_HEAP 0xFFFF
+
+// Review interval of each box, in answered questions
+static const uint32_t box_intervals[PRACTICE_BOX_COUNT] = { 1, 3, 8, 20, 50 };
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t clock;
+    uint32_t count;
+} PracticeFileHeader;
+
+static PracticeRecord records[PRACTICE_MAX_RECORDS];
+static uint16_t heap_position[PRACTICE_MAX_RECORDS];
+static uint16_t heap[PRACTICE_MAX_RECORDS];
+static uint16_t hash_index[PRACTICE_HASH_SIZE];   // Record index + 1, 0 for an empty slot
+static uint32_t heap_size;
+static PracticeStats practice_stats;
+
+/*
+ * Hash table
+ */
+static uint32_t hash_slot(Difficulty difficulty, uint64_t id) {
+    uint64_t hash = (id ^ ((uint64_t)difficulty << 61)) * 0x9E3779B97F4A7C15ULL;
+    return (uint32_t)(hash >> 32) & (PRACTICE_HASH_SIZE - 1);
+}
+
+static int hash_find(Difficulty difficulty, uint64_t id) {
+    for (uint32_t slot = hash_slot(difficulty, id); hash_index[slot]; slot = (slot + 1) & (PRACTICE_HASH_SIZE - 1)) {
+        const PracticeRecord* record = &records[hash_index[slot] - 1];
+        if (record->id == id && record->difficulty == difficulty) return hash_index[slot] - 1;
+    }
+    return -1;
+}
+
+static void hash_insert(int index) {
+    uint32_t slot = hash_slot((Difficulty)records[index].difficulty, records[index].id);
+    while (hash_index[slot]) {
+        slot = (slot + 1) & (PRACTICE_HASH_SIZE - 1);
+    }
+    hash_index[slot] = (uint16_t)(index + 1);
+}
+
+// Remove with backward shift, so lookups never need tombstones
+static void hash_remove(int index) {
+    uint32_t slot = hash_slot((Difficulty)records[index].difficulty, records[index].id);
+    while (hash_index[slot] != index + 1) {
+        slot = (slot + 1) & (PRACTICE_HASH_SIZE - 1);
+    }
+    for (uint32_t next = (slot + 1) & (PRACTICE_HASH_SIZE - 1); hash_index[next]; next = (next + 1) & (PRACTICE_HASH_SIZE - 1)) {
+        const PracticeRecord* record = &records[hash_index[next] - 1];
+        uint32_t home = hash_slot((Difficulty)record->difficulty, record->id);
+        // Move the entry back if the hole lies between its home slot and where it is now
+        if (((next - home) & (PRACTICE_HASH_SIZE - 1)) >= ((next - slot) & (PRACTICE_HASH_SIZE - 1))) {
+            hash_index[slot] = hash_index[next];
+            slot = next;
+        }
+    }
+    hash_index[slot] = 0;
+}
+
+/*
+ * Min-heap on due time
+ */
+static bool heap_before(uint16_t a, uint16_t b) {
+    // Compare through the clock so due times keep their order when the clock wraps
+    return (int32_t)(records[a].due - records[b].due) < 0;
+}
+
+static void heap_place(uint32_t position, uint16_t index) {
+    heap[position] = index;
+    heap_position[index] = (uint16_t)position;
+}
+
+static void heap_sift_up(uint32_t position) {
+    uint16_t index = heap[position];
+    while (position > 0) {
+        uint32_t parent = (position - 1) / 2;
+        if (!heap_before(index, heap[parent])) break;
+        heap_place(position, heap[parent]);
+        position = parent;
+    }
+    heap_place(position, index);
+}
+
+static void heap_sift_down(uint32_t position) {
+    uint16_t index = heap[position];
+    for (;;) {
+        uint32_t child = 2 * position + 1;
+        if (child >= heap_size) break;
+        if (child + 1 < heap_size && heap_before(heap[child + 1], heap[child])) child++;
+        if (!heap_before(heap[child], index)) break;
+        heap_place(position, heap[child]);
+        position = child;
+    }
+    heap_place(position, index);
+}
+
+// Restore the heap order around a record whose due time changed
+static void heap_update(uint16_t index) {
+    heap_sift_up(heap_position[index]);
+    heap_sift_down(heap_position[index]);
+}
+
+static void heap_push(uint16_t index) {
+    heap_place(heap_size, index);
+    heap_sift_up(heap_size++);
+}
+
+static void heap_remove(uint16_t index) {
+    uint32_t position = heap_position[index];
+    heap_position[index] = NOT_IN_HEAP;
+    if (position == --heap_size) return;
+    heap_place(position, heap[heap_size]);
+    heap_update(heap[position]);
+}
+
+/*
+ * Function: allocate_record
+ * Description: Returns a free record, replacing a retired or the least urgent one when the history is full
+ */
+static int allocate_record(void) {
+    int victim = 0;
+
+    if (practice_stats.records < PRACTICE_MAX_RECORDS) {
+        return (int)practice_stats.records++;
+    }
+
+    // Full: only happens once the history has filled, so a linear scan is acceptable
+    for (int i = 1; i < PRACTICE_MAX_RECORDS; i++) {
+        if (records[i].box > records[victim].box ||
+            (records[i].box == records[victim].box && heap_before((uint16_t)victim, (uint16_t)i))) {
+            victim = i;
+        }
+    }
+    hash_remove(victim);
+    if (heap_position[victim] != NOT_IN_HEAP) {
+        heap_remove((uint16_t)victim);
+    } else {
+        practice_stats.retired--;
+    }
+    practice_stats.evicted++;
+    return victim;
+}
+
+/**
+ * Function: Practice_initialise
+ * Description: Clears the practice history
+ * Input(s): None
+ * Return: void
+ */
+void Practice_initialise(void) {
+    memset(hash_index, 0, sizeof(hash_index));
+    memset(&practice_stats, 0, sizeof(practice_stats));
+    heap_size = 0;
+}
+
+/**
+ * Function: Practice_record
+ * Description: Moves a question between Leitner boxes after an answer
+ * Input(s): Difficulty difficulty, uint64_t id - MathQuestion id, bool correct, bool slow
+ * Return: void
+ */
+void Practice_record(Difficulty difficulty, uint64_t id, bool correct, bool slow) {
+    bool lapse = !correct || slow;
+    int index = hash_find(difficulty, id);
+    PracticeRecord* record;
+
+    practice_stats.clock++;
+    if (index < 0) {
+        if (!lapse) return; // Known questions are not practised
+        index = allocate_record();
+        record = &records[index];
+        memset(record, 0, sizeof(*record));
+        record->id = id;
+        record->difficulty = (uint8_t)difficulty;
+        hash_insert(index);
+        heap_position[index] = NOT_IN_HEAP;
+    }
+    record = &records[index];
+
+    record->attempts++;
+    if (!correct) {
+        record->box = 0;
+        record->lapses++;
+    } else if (slow) {
+        record->lapses++; // Right but slow: review again at the same interval
+    } else if (record->box < PRACTICE_BOX_COUNT) {
+        record->box++;
+    }
+
+    if (record->box >= PRACTICE_BOX_COUNT) {
+        if (heap_position[index] != NOT_IN_HEAP) {
+            heap_remove((uint16_t)index);
+            practice_stats.retired++;
+        }
+        return;
+    }
+
+    record->due = practice_stats.clock + box_intervals[record->box];
+    if (heap_position[index] == NOT_IN_HEAP) {
+        if (record->attempts > 1) practice_stats.retired--; // Retired question answered wrongly again
+        heap_push((uint16_t)index);
+    } else {
+        heap_update((uint16_t)index);
+    }
+}
+
+/**
+ * Function: Practice_select
+ * Description: Copies the soonest due questions, leaving them queued until they are answered
+ * Input(s): PracticeRecord* selected - filled in, unsigned int max
+ * Return: unsigned int - questions selected
+ */
+unsigned int Practice_select(PracticeRecord* selected, unsigned int max) {
+    uint16_t taken[PRACTICE_MAX_RECORDS];
+    unsigned int count = 0;
+
+    while (count < max && heap_size > 0) {
+        taken[count] = heap[0];
+        selected[count] = records[heap[0]];
+        heap_remove(heap[0]);
+        count++;
+    }
+    for (unsigned int i = 0; i < count; i++) {
+        heap_push(taken[i]);
+    }
+    return count;
+}
+
+/**
+ * Function: Practice_pending
+ * Description: Returns the number of questions in practice
+ * Input(s): None
+ * Return: unsigned int - questions waiting
+ */
+unsigned int Practice_pending(void) {
+    return heap_size;
+}
+
+/**
+ * Function: Practice_load
+ * Description: Restores a saved history and rebuilds the hash table and heap
+ * Input(s): const char* path
+ * Return: bool - true if a history was restored
+ */
+bool Practice_load(const char* path) {
+    FIL file;
+    PracticeFileHeader header;
+    UINT read_size = 0;
+    bool ok;
+
+    Practice_initialise();
+    if (f_open(&file, path, FA_READ) != FR_OK) return false;
+    ok = f_read(&file, &header, sizeof(header), &read_size) == FR_OK && read_size == sizeof(header) &&
+         header.magic == PRACTICE_MAGIC && header.version == PRACTICE_VERSION &&
+         header.record_size == sizeof(PracticeRecord) && header.count <= PRACTICE_MAX_RECORDS;
+    if (ok) {
+        UINT bytes = header.count * sizeof(PracticeRecord);
+        ok = f_read(&file, records, bytes, &read_size) == FR_OK && read_size == bytes;
+    }
+    f_close(&file);
+    if (!ok) return false;
+
+    practice_stats.clock = header.clock;
+    practice_stats.records = header.count;
+    for (uint32_t i = 0; i < header.count; i++) {
+        hash_insert((int)i);
+        heap_position[i] = NOT_IN_HEAP;
+        // A record from a corrupt file could name a level that does not exist; never schedule it
+        if (records[i].box < PRACTICE_BOX_COUNT && records[i].difficulty < DIFFICULTY_COUNT) {
+            heap_place(heap_size++, (uint16_t)i);
+        } else {
+            practice_stats.retired++;
+        }
+    }
+    // Bottom-up heap construction, O(n)
+    for (uint32_t i = heap_size / 2; i-- > 0;) {
+        heap_sift_down(i);
+    }
+    return true;
+}
+
+/**
+ * Function: Practice_save
+ * Description: Writes the record array to the SD card
+ * Input(s): const char* path
+ * Return: bool - true if the history was written
+ */
+bool Practice_save(const char* path) {
+    FIL file;
+    PracticeFileHeader header = { PRACTICE_MAGIC, PRACTICE_VERSION, sizeof(PracticeRecord),
+                                  practice_stats.clock, practice_stats.records };
+    UINT bytes = practice_stats.records * sizeof(PracticeRecord);
+    UINT written = 0;
+    bool ok;
+
+    if (f_open(&file, path, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) return false;
+    ok = f_write(&file, &header, sizeof(header), &written) == FR_OK && written == sizeof(header);
+    ok = ok && f_write(&file, records, bytes, &written) == FR_OK && written == bytes;
+    ok = (f_close(&file) == FR_OK) && ok;
+    return ok;
+}
+
+/**
+ * Function: Practice_stats
+ * Description: Returns the practice statistics
+ * Input(s): None
+ * Return: const PracticeStats* - statistics
+ */
+const PracticeStats* Practice_stats(void) {
+    practice_stats.pending = heap_size;
+    return &practice_stats;
+}
+
+/**
+ * Function: Practice_report
+ * Description: Prints the practice history size and how many questions are waiting
+ * Input(s): None
+ * Return: void
+ */
+void Practice_report(void) {
+    printf("Practice: %lu questions remembered, %lu waiting, %lu retired, %lu evicted\n",
+           (unsigned long)practice_stats.records, (unsigned long)heap_size,
+           (unsigned long)practice_stats.retired, (unsigned long)practice_stats.evicted);
+}
@@ -0,0 +1,78 @@
+/*
+* Practice.h
+*
+* Spaced repetition practice
+*
+* Questions the player got wrong or answered slowly are entered into Leitner boxes. A
+* correct, quick answer moves a question up a box and a wrong one sends it back to the
+* first; each box has a longer review interval, and a question that climbs out of the
+* last box is retired. Intervals are counted in answered questions (the practice clock)
+* because the board has no real time clock.
+*
+* The history is a fixed-size array of compact records, indexed by a hash table for
+* lookups and by a binary heap keyed on due time for selection, so choosing the next
+* question is O(log n). The records array is saved to the SD card as it is.
+*/
+
+#ifndef PRACTICE_H_
+#define PRACTICE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "Questions.h"
+
+// Questions remembered per player
+#define PRACTICE_MAX_RECORDS 1024
+
+// Leitner boxes; a question answered correctly in the last box is retired
+#define PRACTICE_BOX_COUNT 5
+
+#define PRACTICE_MAGIC   0x3150514Du  // "MQP1"
+#define PRACTICE_VERSION 1
+
+// One remembered question
+typedef struct {
+    uint64_t id;             // MathQuestion id
+    uint32_t due;            // Practice clock value when the question is next due
+    uint16_t attempts;       // Times answered
+    uint16_t lapses;         // Times answered wrongly or too slowly
+    uint8_t difficulty;      // Difficulty the question belongs to
+    uint8_t box;             // Leitner box, PRACTICE_BOX_COUNT once retired
+    uint16_t reserved;
+} PracticeRecord;
+
+typedef struct {
+    uint32_t clock;          // Answers recorded, the unit of the review intervals
+    uint32_t records;        // Records in use
+    uint32_t pending;        // Records waiting in the heap (not retired)
+    uint32_t retired;        // Questions retired from practice
+    uint32_t evicted;        // Records replaced because the history was full
+} PracticeStats;
+
+// Start with an empty history
+void Practice_initialise(void);
+
+// Record an answer. Wrong or slow answers enter practice; answers to questions already in
+// practice move them between boxes. Questions answered correctly and quickly on first sight are ignored.
+void Practice_record(Difficulty difficulty, uint64_t id, bool correct, bool slow);
+
+// Take up to max questions from the front of the practice queue, soonest due first.
+// They return to the queue when their answer is recorded. Returns the number taken.
+unsigned int Practice_select(PracticeRecord* selected, unsigned int max);
+
+// Number of questions waiting in practice
+unsigned int Practice_pending(void);
+
+// Restore a saved history. Returns false if there is none.
+bool Practice_load(const char* path);
+
+// Save the history
+bool Practice_save(const char* path);
+
+// Read the practice statistics
+const PracticeStats* Practice_stats(void);
+
+// Print the practice statistics
+void Practice_report(void);
+
+#endif
@@ -0,0 +1,93 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Profiling span statistics. Adding a sample is a handful of compares and one count
+ * leading zeros; all formatting is left to the report.
+ */
+
+#include "Profile.h"
+#include <stdio.h>
+#include <string.h>
+
+static ProfileSpan* span_list;
+
+/*
+ * Function: print_duration
+ * Description: Prints counts as ns, us or ms, keeping three or four significant digits
+ */
+static void print_duration(uint64_t counts) {
+    uint64_t ns = counts * 1000000000u / HAL_CYCLE_HZ;
+
+    if (ns < 10000) {
+        printf("%luns", (unsigned long)ns);
+    } else if (ns < 10000000) {
+        printf("%luus", (unsigned long)(ns / 1000));
+    } else {
+        printf("%lums", (unsigned long)(ns / 1000000));
+    }
+}
+
+/**
+ * Function: Profile_add
+ * Description: Adds one timed run to a span, linking the span into the report on first use
+ * Input(s): ProfileSpan* span, uint32_t counts - duration at HAL_CYCLE_HZ
+ * Return: void
+ */
+void Profile_add(ProfileSpan* span, uint32_t counts) {
+    if (!span->linked) {
+        span->linked = true;
+        span->next = span_list;
+        span_list = span;
+    }
+    if (span->calls == 0 || counts < span->min) span->min = counts;
+    if (counts > span->max) span->max = counts;
+    span->calls++;
+    span->total += counts;
+    span->buckets[counts ? 32 - __builtin_clz(counts) : 0]++;
+}
+
+/**
+ * Function: Profile_end
+ * Description: Closes a PROFILE_SCOPE, adding the time since it opened to its span
+ * Input(s): ProfileScope* scope
+ * Return: void
+ */
+void Profile_end(ProfileScope* scope) {
+    Profile_add(scope->span, Hal_cycles() - scope->start);
+}
+
+/**
+ * Function: Profile_report
+ * Description: Prints calls, min/avg/max and the non-empty histogram buckets of every span,
+ *              then clears the counts so the next report covers the next session
+ * Input(s): None
+ * Return: void
+ */
+void Profile_report(void) {
+    if (!span_list) return;
+    printf("Profile: calls, min/avg/max, then calls shorter than each histogram bound\n");
+    for (ProfileSpan* span = span_list; span; span = span->next) {
+        if (span->calls == 0) continue;
+        printf("  %-20s %6lu  ", span->name, (unsigned long)span->calls);
+        print_duration(span->min);
+        printf("/");
+        print_duration(span->total / span->calls);
+        printf("/");
+        print_duration(span->max);
+        printf("\n   ");
+        for (int b = 0; b < PROFILE_BUCKETS; b++) {
+            if (span->buckets[b]) {
+                printf(" <");
+                print_duration(1ull << b);
+                printf(":%lu", (unsigned long)span->buckets[b]);
+            }
+        }
+        printf("\n");
+
+        span->calls = 0;
+        span->min = 0;
+        span->max = 0;
+        span->total = 0;
+        memset(span->buckets, 0, sizeof(span->buckets));
+    }
+}
@@ -0,0 +1,68 @@
+/*
+* Profile.h
+*
+* Cycle counter profiling spans
+*
+* PROFILE_SCOPE("name") at the top of a block times the rest of the block with the HAL
+* cycle counter (the Cortex-A9 PMU on the board, the wall clock on the host). Each span
+* keeps its call count, min/avg/max and a log2 histogram in static storage; the span
+* links itself into the report list the first time it completes, so adding one needs no
+* central table. Profile_report prints every span over the UART.
+*
+* Spans are only compiled in with GAME_PROFILE=1. Otherwise the macro expands to nothing
+* and the report is empty. Spans are timed on core 0 only, and nested spans each count
+* their own time including their children.
+*/
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "Hal.h"
+
+// Set to 1 to compile the profiling spans in
+#ifndef GAME_PROFILE
+#define GAME_PROFILE 0
+#endif
+
+// Histogram buckets: bucket b holds durations of 2^(b-1) to 2^b - 1 counts, bucket 0 holds zero
+#define PROFILE_BUCKETS 33
+
+typedef struct ProfileSpan {
+    const char* name;
+    struct ProfileSpan* next;       // Report list, linked on first use
+    bool linked;
+    uint32_t calls;
+    uint32_t min;                   // Counts at HAL_CYCLE_HZ
+    uint32_t max;
+    uint64_t total;
+    uint32_t buckets[PROFILE_BUCKETS];
+} ProfileSpan;
+
+typedef struct {
+    ProfileSpan* span;
+    uint32_t start;
+} ProfileScope;
+
+// Add one timed run of a span
+void Profile_add(ProfileSpan* span, uint32_t counts);
+
+// Cleanup handler of PROFILE_SCOPE: adds the time since the scope opened
+void Profile_end(ProfileScope* scope);
+
+// Print every span with its histogram, then clear them for the next session
+void Profile_report(void);
+
+#if GAME_PROFILE
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(span_name) \
+    static ProfileSpan PROFILE_CONCAT(profile_span_, __LINE__) = { .name = span_name }; \
+    ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__) __attribute__((cleanup(Profile_end))) = \
+        { .span = &PROFILE_CONCAT(profile_span_, __LINE__), .start = Hal_cycles() }
+#else
+#define PROFILE_SCOPE(span_name) do { } while (0)
+#endif
+
+#endif
@@ -0,0 +1,181 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * SD card question bank. Only the header is read when the bank is opened; the offset
+ * and count per difficulty turn a question index into a file position directly, so each
+ * lookup costs one seek and one record sized read regardless of how large the bank is.
+ * Recently used records are kept in a small LRU cache scanned linearly.
+ */
+
+#include "QuestionBank.h"
+#include <stdio.h>
+#include <string.h>
+
+// Cache key: difficulty in the top byte, record index below it
+#define BANK_KEY(difficulty, index) (((uint32_t)(difficulty) << 24) | ((index) & 0x00FFFFFFu))
+
+/*
+ * Function: bank_header_valid
+ * Description: Checks the header and that every difficulty's records lie inside the file
+ */
+static bool bank_header_valid(const QuestionBankHeader* header, FSIZE_t file_size) {
+    if (header->magic != QUESTION_BANK_MAGIC || header->version != QUESTION_BANK_VERSION) return false;
+    if (header->record_size != sizeof(QuestionBankRecord)) return false;
+
+    for (int i = 0; i < DIFFICULTY_COUNT; i++) {
+        uint64_t end = (uint64_t)header->offset[i] + (uint64_t)header->count[i] * sizeof(QuestionBankRecord);
+        if (header->count[i] > 0x00FFFFFFu) return false;
+        if (header->count[i] && (header->offset[i] < sizeof(QuestionBankHeader) || end > file_size)) return false;
+    }
+    return true;
+}
+
+/*
+ * Function: bank_record_valid
+ * Description: Rejects records the game could not display or answer
+ */
+static bool bank_record_valid(const QuestionBankRecord* record, Difficulty difficulty) {
+    if (memchr(record->question, '\0', sizeof(record->question)) == NULL) return false;
+    if (memchr(record->formula, '\0', sizeof(record->formula)) == NULL) return false;
+    for (int i = 0; i < 4; i++) {
+        if (memchr(record->choices[i], '\0', sizeof(record->choices[i])) == NULL) return false;
+    }
+    return difficulty != EASY || record->correct_choice < 4;
+}
+
+/**
+ * Function: QuestionBank_open
+ * Description: Opens the bank file and reads its header
+ * Input(s): QuestionBank* bank, const char* path
+ * Return: bool - true if the bank is usable
+ */
+bool QuestionBank_open(QuestionBank* bank, const char* path) {
+    UINT read_size = 0;
+
+    memset(bank, 0, sizeof(*bank));
+    if (f_open(&bank->file, path, FA_READ) != FR_OK) {
+        return false;
+    }
+    if (f_read(&bank->file, &bank->header, sizeof(bank->header), &read_size) != FR_OK ||
+        read_size != sizeof(bank->header) ||
+        !bank_header_valid(&bank->header, f_size(&bank->file))) {
+        printf("Question bank %s is not valid, ignoring it\n", path);
+        f_close(&bank->file);
+        memset(&bank->header, 0, sizeof(bank->header));
+        return false;
+    }
+
+    bank->open = true;
+    printf("Question bank: %lu easy, %lu medium, %lu hard\n",
+           (unsigned long)bank->header.count[EASY], (unsigned long)bank->header.count[MEDIUM],
+           (unsigned long)bank->header.count[HARD]);
+    return true;
+}
+
+/**
+ * Function: QuestionBank_close
+ * Description: Closes the bank file
+ * Input(s): QuestionBank* bank
+ * Return: void
+ */
+void QuestionBank_close(QuestionBank* bank) {
+    if (bank->open) {
+        f_close(&bank->file);
+    }
+    bank->open = false;
+    memset(&bank->header, 0, sizeof(bank->header));
+    memset(bank->cache, 0, sizeof(bank->cache));
+}
+
+/**
+ * Function: QuestionBank_count
+ * Description: Returns the number of questions of a difficulty
+ * Input(s): const QuestionBank* bank, Difficulty difficulty
+ * Return: uint32_t - question count
+ */
+uint32_t QuestionBank_count(const QuestionBank* bank, Difficulty difficulty) {
+    return bank->open ? bank->header.count[difficulty] : 0;
+}
+
+/**
+ * Function: QuestionBank_load
+ * Description: Loads one question, from the cache if possible, otherwise with a single seek and read
+ * Input(s): QuestionBank* bank, Difficulty difficulty, uint32_t index, MathQuestion* question - filled in
+ * Return: bool - true if the question was loaded
+ */
+bool QuestionBank_load(QuestionBank* bank, Difficulty difficulty, uint32_t index, MathQuestion* question) {
+    uint32_t key = BANK_KEY(difficulty, index);
+    QuestionBankCacheEntry* entry = NULL;
+    QuestionBankCacheEntry* victim = &bank->cache[0];
+
+    if (index >= QuestionBank_count(bank, difficulty)) return false;
+    bank->stats.lookups++;
+
+    for (int i = 0; i < QUESTION_BANK_CACHE_SIZE; i++) {
+        QuestionBankCacheEntry* candidate = &bank->cache[i];
+        if (candidate->valid && candidate->key == key) {
+            entry = candidate;
+            break;
+        }
+        // Prefer an empty slot, otherwise the least recently used one
+        if (victim->valid && (!candidate->valid || candidate->last_used < victim->last_used)) {
+            victim = candidate;
+        }
+    }
+
+    if (entry) {
+        bank->stats.hits++;
+    } else {
+        UINT read_size = 0;
+        FSIZE_t position = (FSIZE_t)bank->header.offset[difficulty] + (FSIZE_t)index * sizeof(QuestionBankRecord);
+
+        bank->stats.reads++;
+        if (f_lseek(&bank->file, position) != FR_OK ||
+            f_read(&bank->file, &victim->record, sizeof(victim->record), &read_size) != FR_OK ||
+            read_size != sizeof(victim->record) ||
+            !bank_record_valid(&victim->record, difficulty)) {
+            victim->valid = false;
+            bank->stats.errors++;
+            return false;
+        }
+        victim->key = key;
+        victim->valid = true;
+        entry = victim;
+    }
+    entry->last_used = ++bank->use_counter;
+
+    memcpy(question->question, entry->record.question, sizeof(question->question));
+    memcpy(question->choices, entry->record.choices, sizeof(question->choices));
+    memcpy(question->formula, entry->record.formula, sizeof(question->formula));
+    question->answer = entry->record.answer;
+    question->correct_choice = entry->record.correct_choice;
+    question->screen = entry->record.screen;
+    question->id = QUESTION_ID_BANK | index;
+    question->user_answer = NO_ANSWER;
+    question->response_ticks = 0;
+    question->response_us = 0;
+    return true;
+}
+
+/**
+ * Function: QuestionBank_stats
+ * Description: Returns the bank statistics
+ * Input(s): const QuestionBank* bank
+ * Return: const QuestionBankStats* - statistics
+ */
+const QuestionBankStats* QuestionBank_stats(const QuestionBank* bank) {
+    return &bank->stats;
+}
+
+/**
+ * Function: QuestionBank_report
+ * Description: Prints the cache hit rate and SD reads
+ * Input(s): const QuestionBank* bank
+ * Return: void
+ */
+void QuestionBank_report(const QuestionBank* bank) {
+    if (!bank->open) return;
+    printf("Question bank: %lu lookups, %lu cache hits, %lu SD reads, %lu errors\n",
+           (unsigned long)bank->stats.lookups, (unsigned long)bank->stats.hits,
+           (unsigned long)bank->stats.reads, (unsigned long)bank->stats.errors);
+}
@@ -0,0 +1,101 @@
+/*
+* QuestionBank.h
+*
+* Indexed question bank on the SD card
+*
+* Curated questions ship in a single binary file instead of being compiled in. The file
+* starts with a fixed header holding, for each difficulty, the number of questions and
+* the file offset of its first record; the records themselves are fixed size. Opening the
+* bank reads only the header, and each lookup is one f_lseek plus one f_read, served from
+* a small LRU cache of records when the same question is asked again.
+*
+* File layout (little endian):
+*     QuestionBankHeader
+*     QuestionBankRecord[count[EASY]]    at offset[EASY]
+*     QuestionBankRecord[count[MEDIUM]]  at offset[MEDIUM]
+*     QuestionBankRecord[count[HARD]]    at offset[HARD]
+*
+* tools/make_question_bank.c builds the file from a tab separated text list.
+*/
+
+#ifndef QUESTIONBANK_H_
+#define QUESTIONBANK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "Questions.h"
+
+#define QUESTION_BANK_MAGIC   0x3142514Du  // "MQB1"
+#define QUESTION_BANK_VERSION 2
+
+// Records kept in RAM
+#define QUESTION_BANK_CACHE_SIZE 8
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;                 // sizeof(QuestionBankRecord)
+    uint32_t count[DIFFICULTY_COUNT];     // Questions per difficulty
+    uint32_t offset[DIFFICULTY_COUNT];    // File offset of the first record per difficulty
+} QuestionBankHeader;
+
+// One question as stored on the SD card
+typedef struct {
+    char question[QUESTION_TEXT_LENGTH];
+    int32_t answer;                               // Numeric answer for Medium and Hard, may be negative
+    char choices[4][CHOICE_TEXT_LENGTH];          // Multiple-choice for Easy
+    uint8_t correct_choice;                       // Correct choice index for Easy
+    uint8_t screen;                               // Question image, 0 to draw the text
+    uint8_t reserved[2];
+    char formula[QUESTION_FORMULA_LENGTH];        // Formula checking the answer, empty if none
+} QuestionBankRecord;
+
+// Host tools define QUESTIONBANK_FORMAT_ONLY to use the file format without FatFS
+#ifndef QUESTIONBANK_FORMAT_ONLY
+
+#include "FatFS/ff.h"
+
+typedef struct {
+    uint32_t key;                // Difficulty and index, see QuestionBank.c
+    uint32_t last_used;          // Use stamp for LRU replacement
+    bool valid;
+    QuestionBankRecord record;
+} QuestionBankCacheEntry;
+
+typedef struct {
+    uint32_t lookups;
+    uint32_t hits;
+    uint32_t reads;              // f_lseek + f_read pairs
+    uint32_t errors;             // Failed or short reads, rejected records
+} QuestionBankStats;
+
+typedef struct {
+    FIL file;
+    bool open;
+    QuestionBankHeader header;
+    uint32_t use_counter;
+    QuestionBankCacheEntry cache[QUESTION_BANK_CACHE_SIZE];
+    QuestionBankStats stats;
+} QuestionBank;
+
+// Open the bank and read its header. Returns false (leaving the bank empty) if the file is missing or invalid.
+bool QuestionBank_open(QuestionBank* bank, const char* path);
+
+// Close the bank
+void QuestionBank_close(QuestionBank* bank);
+
+// Number of questions available for a difficulty, 0 if the bank is not open
+uint32_t QuestionBank_count(const QuestionBank* bank, Difficulty difficulty);
+
+// Load question index of a difficulty. Returns false if it is out of range or could not be read.
+bool QuestionBank_load(QuestionBank* bank, Difficulty difficulty, uint32_t index, MathQuestion* question);
+
+// Read the bank statistics
+const QuestionBankStats* QuestionBank_stats(const QuestionBank* bank);
+
+// Print the bank statistics
+void QuestionBank_report(const QuestionBank* bank);
+
+#endif // QUESTIONBANK_FORMAT_ONLY
+
+#endif
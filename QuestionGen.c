@@ -0,0 +1,311 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Procedural question generator. Each question kind picks its answer first and derives
+ * the operands from it, so every question is valid by construction and costs a fixed
+ * number of PCG32 draws. Text is assembled with small append helpers rather than
+ * snprintf to keep generation cheap on the board. Alongside the text each kind writes
+ * the formula of its answer (Expr.h), so the game can check the answer independently.
+ */
+
+#include "QuestionGen.h"
+#include <stdbool.h>
+
+/**
+ * Function: QuestionRng_seed
+ * Description: Seeds the PCG32 generator
+ * Input(s): QuestionRng* rng, uint64_t seed
+ * Return: void
+ */
+void QuestionRng_seed(QuestionRng* rng, uint64_t seed) {
+    rng->state = 0;
+    rng->increment = (seed << 1) | 1;
+    QuestionRng_next(rng);
+    rng->state += seed;
+    QuestionRng_next(rng);
+}
+
+/**
+ * Function: QuestionRng_next
+ * Description: Returns the next 32 random bits (PCG-XSH-RR)
+ * Input(s): QuestionRng* rng
+ * Return: uint32_t - random value
+ */
+uint32_t QuestionRng_next(QuestionRng* rng) {
+    uint64_t old = rng->state;
+    rng->state = old * 6364136223846793005ULL + rng->increment;
+    uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+    uint32_t rot = (uint32_t)(old >> 59);
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+/**
+ * Function: QuestionRng_below
+ * Description: Returns a random number in [0, bound)
+ * Input(s): QuestionRng* rng, uint32_t bound
+ * Return: uint32_t - random value
+ */
+uint32_t QuestionRng_below(QuestionRng* rng, uint32_t bound) {
+    return (uint32_t)(((uint64_t)QuestionRng_next(rng) * bound) >> 32);
+}
+
+// Random number in [low, high]
+static int random_range(QuestionRng* rng, int low, int high) {
+    return low + (int)QuestionRng_below(rng, (uint32_t)(high - low + 1));
+}
+
+/*
+ * Text helpers. Each returns the new write position and never writes past end - 1.
+ */
+static char* append_text(char* out, char* end, const char* text) {
+    while (*text && out < end - 1) {
+        *out++ = *text++;
+    }
+    *out = '\0';
+    return out;
+}
+
+static char* append_int(char* out, char* end, int value) {
+    char digits[12];
+    int count = 0;
+    unsigned int magnitude = (value < 0) ? 0u - (unsigned int)value : (unsigned int)value;
+
+    if (value < 0 && out < end - 1) *out++ = '-';
+    do {
+        digits[count++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+    while (count && out < end - 1) {
+        *out++ = digits[--count];
+    }
+    *out = '\0';
+    return out;
+}
+
+// Append a coefficient and variable, writing "x" rather than "1x"
+static char* append_term(char* out, char* end, int coefficient, const char* variable) {
+    if (coefficient != 1) out = append_int(out, end, coefficient);
+    return append_text(out, end, variable);
+}
+
+/*
+ * Function: generate_choice
+ * Description: Easy level: arithmetic with four multiple choice answers
+ */
+static void generate_choice(QuestionRng* rng, MathQuestion* question) {
+    static const char* const operators[4] = { " + ", " - ", " * ", " / " };
+    static const char* const formula_operators[4] = { "+", "-", "*", "/" };
+    static const int offsets[6] = { -10, -2, -1, 1, 2, 10 };
+    char* out = question->question;
+    char* end = question->question + QUESTION_TEXT_LENGTH;
+    int operation = random_range(rng, 0, 3);
+    int a, b, answer;
+
+    switch (operation) {
+        case 0: a = random_range(rng, 2, 50); b = random_range(rng, 2, 50); answer = a + b; break;
+        case 1: a = random_range(rng, 10, 60); b = random_range(rng, 1, a); answer = a - b; break;
+        case 2: a = random_range(rng, 2, 12); b = random_range(rng, 2, 12); answer = a * b; break;
+        default: answer = random_range(rng, 2, 12); b = random_range(rng, 2, 9); a = answer * b; break;
+    }
+
+    out = append_text(out, end, "What is ");
+    out = append_int(out, end, a);
+    out = append_text(out, end, operators[operation]);
+    out = append_int(out, end, b);
+    append_text(out, end, "?");
+
+    out = question->formula;
+    end = question->formula + QUESTION_FORMULA_LENGTH;
+    out = append_int(out, end, a);
+    out = append_text(out, end, formula_operators[operation]);
+    append_int(out, end, b);
+
+    // Three distinct distractors from every other entry of the offset table
+    int correct = random_range(rng, 0, 3);
+    int first = random_range(rng, 0, 5);
+    int distractor = 0;
+    for (int i = 0; i < 4; i++) {
+        int value = answer;
+        if (i != correct) {
+            value = answer + offsets[(first + 2 * distractor) % 6];
+            if (value < 0) value = answer + 20 + distractor;
+            distractor++;
+        }
+        append_int(question->choices[i], question->choices[i] + CHOICE_TEXT_LENGTH, value);
+    }
+
+    question->answer = answer;
+    question->correct_choice = correct;
+}
+
+/*
+ * Function: generate_linear
+ * Description: Medium level: linear equations and substitution, answer in [0, max_answer]
+ */
+static void generate_linear(QuestionRng* rng, int max_answer, MathQuestion* question) {
+    char* out = question->question;
+    char* end = question->question + QUESTION_TEXT_LENGTH;
+    char* formula = question->formula;
+    char* formula_end = question->formula + QUESTION_FORMULA_LENGTH;
+    int answer = random_range(rng, 0, max_answer);
+    int form = random_range(rng, 0, 2);
+
+    if (form == 0) {
+        // Solve for x: ax + b = c
+        int a = random_range(rng, 2, 9);
+        int b = random_range(rng, 1, 20);
+        bool minus = (a * answer >= b) && random_range(rng, 0, 1);
+        int c = minus ? a * answer - b : a * answer + b;
+        out = append_text(out, end, "Solve for x: ");
+        out = append_term(out, end, a, "x");
+        out = append_text(out, end, minus ? " - " : " + ");
+        out = append_int(out, end, b);
+        out = append_text(out, end, " = ");
+        append_int(out, end, c);
+
+        formula = append_int(formula, formula_end, a);
+        formula = append_text(formula, formula_end, minus ? "x-" : "x+");
+        formula = append_int(formula, formula_end, b);
+        formula = append_text(formula, formula_end, "=");
+        append_int(formula, formula_end, c);
+    } else if (form == 1) {
+        // Substitution: value of ax + b when x = k
+        int a = random_range(rng, 1, 3);
+        int k = random_range(rng, 0, answer / a);
+        int b = answer - a * k;
+        out = append_text(out, end, "What is ");
+        out = append_term(out, end, a, "x");
+        if (b) {
+            out = append_text(out, end, " + ");
+            out = append_int(out, end, b);
+        }
+        out = append_text(out, end, " when x = ");
+        out = append_int(out, end, k);
+        append_text(out, end, "?");
+
+        formula = append_int(formula, formula_end, a);
+        formula = append_text(formula, formula_end, "*");
+        formula = append_int(formula, formula_end, k);
+        formula = append_text(formula, formula_end, "+");
+        append_int(formula, formula_end, b);
+    } else {
+        // If x - b = c, what is x?
+        int b = random_range(rng, 0, answer);
+        out = append_text(out, end, "If x - ");
+        out = append_int(out, end, b);
+        out = append_text(out, end, " = ");
+        out = append_int(out, end, answer - b);
+        append_text(out, end, ", what is x?");
+
+        formula = append_text(formula, formula_end, "x-");
+        formula = append_int(formula, formula_end, b);
+        formula = append_text(formula, formula_end, "=");
+        append_int(formula, formula_end, answer - b);
+    }
+    question->answer = answer;
+}
+
+/*
+ * Function: generate_hard
+ * Description: Hard level: products, unit digits of powers and derivatives, answer in [0, max_answer]
+ */
+static void generate_hard(QuestionRng* rng, int max_answer, MathQuestion* question) {
+    char* out = question->question;
+    char* end = question->question + QUESTION_TEXT_LENGTH;
+    char* formula = question->formula;
+    char* formula_end = question->formula + QUESTION_FORMULA_LENGTH;
+    int form = random_range(rng, 0, 3);
+    int answer;
+
+    if (form == 0) {
+        // Find x if ax = b
+        int a = random_range(rng, 2, 12);
+        answer = random_range(rng, 0, max_answer);
+        out = append_text(out, end, "Find x if ");
+        out = append_term(out, end, a, "x");
+        out = append_text(out, end, " = ");
+        append_int(out, end, a * answer);
+
+        formula = append_int(formula, formula_end, a);
+        formula = append_text(formula, formula_end, "x=");
+        append_int(formula, formula_end, a * answer);
+    } else if (form == 1) {
+        // Unit digit of b^e, always 0-9
+        int base = random_range(rng, 2, 19);
+        int exponent = random_range(rng, 2, 12);
+        int digit = 1;
+        for (int i = 0; i < exponent; i++) {
+            digit = (digit * base) % 10;
+        }
+        answer = digit;
+        out = append_text(out, end, "What is the unit digit of ");
+        out = append_int(out, end, base);
+        out = append_text(out, end, "^");
+        out = append_int(out, end, exponent);
+        append_text(out, end, "?");
+
+        formula = append_int(formula, formula_end, base);
+        formula = append_text(formula, formula_end, "^");
+        formula = append_int(formula, formula_end, exponent);
+        append_text(formula, formula_end, "%10");
+    } else if (form == 2) {
+        // d/dx ax^2 at x = k is 2ak
+        int k = random_range(rng, 1, 4);
+        int a = random_range(rng, 1, max_answer / (2 * k));
+        answer = 2 * a * k;
+        out = append_text(out, end, "Derivative of ");
+        out = append_term(out, end, a, "x^2");
+        out = append_text(out, end, " at x = ");
+        append_int(out, end, k);
+
+        formula = append_text(formula, formula_end, "d(");
+        formula = append_int(formula, formula_end, a);
+        formula = append_text(formula, formula_end, "x^2,");
+        formula = append_int(formula, formula_end, k);
+        append_text(formula, formula_end, ")");
+    } else {
+        // d/dx ax^n at x = 1 is an
+        int n = random_range(rng, 2, 4);
+        int a = random_range(rng, 1, max_answer / n);
+        answer = a * n;
+        out = append_text(out, end, "Derivative of ");
+        out = append_term(out, end, a, "x^");
+        out = append_int(out, end, n);
+        append_text(out, end, " at x = 1");
+
+        formula = append_text(formula, formula_end, "d(");
+        formula = append_int(formula, formula_end, a);
+        formula = append_text(formula, formula_end, "x^");
+        formula = append_int(formula, formula_end, n);
+        append_text(formula, formula_end, ",1)");
+    }
+    question->answer = answer;
+}
+
+/**
+ * Function: QuestionGen_generate
+ * Description: Generates a question for the given difficulty
+ * Input(s): QuestionRng* rng, Difficulty difficulty, int max_answer - largest Medium/Hard answer,
+ *           MathQuestion* question - filled in
+ * Return: void
+ */
+void QuestionGen_generate(QuestionRng* rng, Difficulty difficulty, int max_answer, MathQuestion* question) {
+    for (int i = 0; i < 4; i++) {
+        question->choices[i][0] = '\0';
+    }
+    question->correct_choice = 0;
+    question->user_answer = NO_ANSWER;
+    question->screen = 0;
+    question->response_ticks = 0;
+    question->response_us = 0;
+
+    if (max_answer < QUESTION_SWITCH_MAX_ANSWER) {
+        max_answer = QUESTION_SWITCH_MAX_ANSWER;
+    }
+
+    switch (difficulty) {
+        case EASY:   generate_choice(rng, question); break;
+        case MEDIUM: generate_linear(rng, max_answer, question); break;
+        default:     generate_hard(rng, max_answer, question); break;
+    }
+}
@@ -0,0 +1,38 @@
+/*
+* QuestionGen.h
+*
+* Procedural question generator
+*
+* Produces an unlimited stream of arithmetic, linear equation, power and derivative
+* questions for each difficulty. Every question is built answer-first from a fixed
+* number of random draws, so generation is constant time with no retry loops.
+*/
+
+#ifndef QUESTIONGEN_H_
+#define QUESTIONGEN_H_
+
+#include <stdint.h>
+#include "Questions.h"
+
+// PCG32 random number generator state
+typedef struct {
+    uint64_t state;
+    uint64_t increment;
+} QuestionRng;
+
+// Largest answer the slide switches can enter as a single switch
+#define QUESTION_SWITCH_MAX_ANSWER 9
+
+// Seed the generator (e.g. from the private timer when the player presses start)
+void QuestionRng_seed(QuestionRng* rng, uint64_t seed);
+
+// Next 32 random bits
+uint32_t QuestionRng_next(QuestionRng* rng);
+
+// Random number in [0, bound) using a multiply-shift, no rejection loop
+uint32_t QuestionRng_below(QuestionRng* rng, uint32_t bound);
+
+// Generate one question. Medium and Hard answers lie in [0, max_answer]; max_answer must be at least 9.
+void QuestionGen_generate(QuestionRng* rng, Difficulty difficulty, int max_answer, MathQuestion* question);
+
+#endif
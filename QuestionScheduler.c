@@ -0,0 +1,255 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Question scheduler. The shuffle of each difficulty is stored as order[k] ^ k, so the
+ * zeroed static array is already the identity permutation and a new cycle only needs a
+ * memset. A draw performs one Fisher-Yates step: swap slot drawn with a random slot in
+ * [drawn, pool) and return it. The shuffle is driven by a per-difficulty PCG32 seeded for
+ * each cycle, so a saved session is restored by replaying its seed for the saved number
+ * of draws rather than by storing the permutation itself.
+ */
+
+#include "QuestionScheduler.h"
+#include "QuestionGen.h"
+#include "FatFS/ff.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SEEN_WORDS ((QUESTION_SCHEDULER_MAX_POOL + 31) / 32)
+
+typedef struct {
+    QuestionSchedulerStats stats;
+    uint64_t seed;           // Seed of the current cycle
+    QuestionRng rng;         // Shuffle generator of the current cycle
+} ScheduleLevel;
+
+// Saved state, followed by the seen bitset words of each difficulty
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint64_t seed[DIFFICULTY_COUNT];
+    uint32_t pool[DIFFICULTY_COUNT];
+    uint32_t drawn[DIFFICULTY_COUNT];
+    uint32_t cycles[DIFFICULTY_COUNT];
+} ScheduleFileHeader;
+
+static uint32_t schedule_order[DIFFICULTY_COUNT][QUESTION_SCHEDULER_MAX_POOL];
+static uint32_t schedule_seen[DIFFICULTY_COUNT][SEEN_WORDS];
+static ScheduleLevel schedule_levels[DIFFICULTY_COUNT];
+static QuestionRng schedule_seeds; // Seeds each new cycle
+
+static inline bool seen_test(int level, uint32_t index) {
+    return (schedule_seen[level][index >> 5] >> (index & 31)) & 1;
+}
+
+static inline void seen_set(int level, uint32_t index) {
+    schedule_seen[level][index >> 5] |= 1u << (index & 31);
+}
+
+/*
+ * Function: shuffle_step
+ * Description: One Fisher-Yates step, returns the question moved into slot drawn
+ */
+static uint32_t shuffle_step(int level) {
+    ScheduleLevel* state = &schedule_levels[level];
+    uint32_t* order = schedule_order[level];
+    uint32_t i = state->stats.drawn;
+    uint32_t j = i + QuestionRng_below(&state->rng, state->stats.pool - i);
+    uint32_t value_i = order[i] ^ i;
+    uint32_t value_j = order[j] ^ j;
+
+    order[i] = value_j ^ i;
+    order[j] = value_i ^ j;
+    state->stats.drawn++;
+    return value_j;
+}
+
+/*
+ * Function: restart_shuffle
+ * Description: Resets the permutation to the identity and seeds it for a new cycle
+ */
+static void restart_shuffle(int level, uint64_t seed) {
+    ScheduleLevel* state = &schedule_levels[level];
+
+    memset(schedule_order[level], 0, state->stats.pool * sizeof(uint32_t));
+    state->seed = seed;
+    state->stats.drawn = 0;
+    QuestionRng_seed(&state->rng, seed);
+}
+
+static uint64_t next_seed(void) {
+    uint64_t high = QuestionRng_next(&schedule_seeds);
+    return (high << 32) | QuestionRng_next(&schedule_seeds);
+}
+
+/*
+ * Function: start_cycle
+ * Description: Forgets which questions were seen and starts a new shuffle
+ */
+static void start_cycle(int level) {
+    ScheduleLevel* state = &schedule_levels[level];
+
+    memset(schedule_seen[level], 0, ((state->stats.pool + 31) / 32) * sizeof(uint32_t));
+    state->stats.seen = 0;
+    restart_shuffle(level, next_seed());
+}
+
+/**
+ * Function: QuestionScheduler_initialise
+ * Description: Sets the pool sizes and starts a new cycle for every difficulty
+ * Input(s): const uint32_t pool[DIFFICULTY_COUNT] - questions per difficulty, uint64_t seed
+ * Return: void
+ */
+void QuestionScheduler_initialise(const uint32_t pool[DIFFICULTY_COUNT], uint64_t seed) {
+    QuestionRng_seed(&schedule_seeds, seed);
+    for (int level = 0; level < DIFFICULTY_COUNT; level++) {
+        ScheduleLevel* state = &schedule_levels[level];
+        memset(state, 0, sizeof(*state));
+        state->stats.pool = (pool[level] < QUESTION_SCHEDULER_MAX_POOL) ? pool[level] : QUESTION_SCHEDULER_MAX_POOL;
+        start_cycle(level);
+    }
+}
+
+/**
+ * Function: QuestionScheduler_next
+ * Description: Draws the next unseen question of a difficulty
+ * Input(s): Difficulty difficulty
+ * Return: uint32_t - question index in [0, pool)
+ */
+uint32_t QuestionScheduler_next(Difficulty difficulty) {
+    ScheduleLevel* state = &schedule_levels[difficulty];
+    uint32_t index;
+
+    // Only questions seen before the pool changed can be skipped, so this loop
+    // runs once per draw unless the previous session used a different pool.
+    do {
+        if (state->stats.seen >= state->stats.pool || state->stats.drawn >= state->stats.pool) {
+            if (state->stats.seen >= state->stats.pool) state->stats.cycles++;
+            start_cycle(difficulty);
+        }
+        index = shuffle_step(difficulty);
+        if (seen_test(difficulty, index)) state->stats.skipped++;
+    } while (seen_test(difficulty, index));
+
+    seen_set(difficulty, index);
+    state->stats.seen++;
+    return index;
+}
+
+/**
+ * Function: QuestionScheduler_load
+ * Description: Restores the seen bitsets and shuffle positions saved by QuestionScheduler_save
+ * Input(s): const char* path
+ * Return: bool - true if a saved state was restored
+ */
+bool QuestionScheduler_load(const char* path) {
+    FIL file;
+    ScheduleFileHeader header;
+    UINT read_size = 0;
+    bool ok = true;
+
+    if (f_open(&file, path, FA_READ) != FR_OK) return false;
+    if (f_read(&file, &header, sizeof(header), &read_size) != FR_OK || read_size != sizeof(header) ||
+        header.magic != QUESTION_SCHEDULER_MAGIC || header.version != QUESTION_SCHEDULER_VERSION) {
+        f_close(&file);
+        return false;
+    }
+
+    for (int level = 0; level < DIFFICULTY_COUNT && ok; level++) {
+        ScheduleLevel* state = &schedule_levels[level];
+        uint32_t saved_pool = (header.pool[level] < QUESTION_SCHEDULER_MAX_POOL) ? header.pool[level] : QUESTION_SCHEDULER_MAX_POOL;
+        uint32_t bytes = ((saved_pool + 31) / 32) * sizeof(uint32_t);
+
+        // The saved bitset replaces the fresh one; bits past the current pool are dropped
+        memset(schedule_seen[level], 0, sizeof(schedule_seen[level]));
+        ok = f_read(&file, schedule_seen[level], bytes, &read_size) == FR_OK && read_size == bytes;
+        for (uint32_t i = state->stats.pool; ok && i < saved_pool; i++) {
+            schedule_seen[level][i >> 5] &= ~(1u << (i & 31));
+        }
+
+        state->stats.seen = 0;
+        for (uint32_t i = 0; i < (state->stats.pool + 31) / 32; i++) {
+            state->stats.seen += (uint32_t)__builtin_popcount(schedule_seen[level][i]);
+        }
+        state->stats.cycles = header.cycles[level];
+
+        if (ok && saved_pool == state->stats.pool && header.drawn[level] <= saved_pool) {
+            // Same pool: replay the saved shuffle up to where it stopped
+            restart_shuffle(level, header.seed[level]);
+            while (state->stats.drawn < header.drawn[level]) {
+                shuffle_step(level);
+            }
+        }
+        // Different pool: keep the fresh shuffle, QuestionScheduler_next skips seen questions
+    }
+    f_close(&file);
+
+    if (!ok) {
+        // A truncated file leaves the bitsets half restored, start again instead
+        for (int level = 0; level < DIFFICULTY_COUNT; level++) {
+            schedule_levels[level].stats.cycles = 0;
+            start_cycle(level);
+        }
+    }
+    return ok;
+}
+
+/**
+ * Function: QuestionScheduler_save
+ * Description: Saves the shuffle seeds, positions and seen bitsets
+ * Input(s): const char* path
+ * Return: bool - true if the state was written
+ */
+bool QuestionScheduler_save(const char* path) {
+    FIL file;
+    ScheduleFileHeader header;
+    UINT written = 0;
+    bool ok;
+
+    memset(&header, 0, sizeof(header));
+    header.magic = QUESTION_SCHEDULER_MAGIC;
+    header.version = QUESTION_SCHEDULER_VERSION;
+    for (int level = 0; level < DIFFICULTY_COUNT; level++) {
+        header.seed[level] = schedule_levels[level].seed;
+        header.pool[level] = schedule_levels[level].stats.pool;
+        header.drawn[level] = schedule_levels[level].stats.drawn;
+        header.cycles[level] = schedule_levels[level].stats.cycles;
+    }
+
+    if (f_open(&file, path, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) return false;
+    ok = f_write(&file, &header, sizeof(header), &written) == FR_OK && written == sizeof(header);
+    for (int level = 0; level < DIFFICULTY_COUNT && ok; level++) {
+        UINT bytes = ((header.pool[level] + 31) / 32) * sizeof(uint32_t);
+        ok = f_write(&file, schedule_seen[level], bytes, &written) == FR_OK && written == bytes;
+    }
+    ok = (f_close(&file) == FR_OK) && ok;
+    return ok;
+}
+
+/**
+ * Function: QuestionScheduler_stats
+ * Description: Returns the statistics of a difficulty
+ * Input(s): Difficulty difficulty
+ * Return: const QuestionSchedulerStats* - statistics
+ */
+const QuestionSchedulerStats* QuestionScheduler_stats(Difficulty difficulty) {
+    return &schedule_levels[difficulty].stats;
+}
+
+/**
+ * Function: QuestionScheduler_report
+ * Description: Prints how far through each pool the player is
+ * Input(s): None
+ * Return: void
+ */
+void QuestionScheduler_report(void) {
+    static const char* const level_names[DIFFICULTY_COUNT] = { "easy", "medium", "hard" };
+    for (int level = 0; level < DIFFICULTY_COUNT; level++) {
+        const QuestionSchedulerStats* stats = &schedule_levels[level].stats;
+        if (!stats->pool) continue;
+        printf("Scheduler %s: %lu of %lu seen, %lu cycles, %lu skipped\n", level_names[level],
+               (unsigned long)stats->seen, (unsigned long)stats->pool,
+               (unsigned long)stats->cycles, (unsigned long)stats->skipped);
+    }
+}
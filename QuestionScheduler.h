@@ -0,0 +1,57 @@
+/*
+* QuestionScheduler.h
+*
+* No-repeat question scheduler
+*
+* Hands out question bank indices so that a player sees every question of a difficulty
+* once before any repeats. Each difficulty keeps an incremental Fisher-Yates shuffle of
+* its pool, advanced by one swap per draw, plus a bitset of the questions already seen.
+* Both live in static storage, so drawing is O(1) with no allocation for pools of up to
+* QUESTION_SCHEDULER_MAX_POOL questions.
+*
+* The scheduler state (shuffle seed, position and seen bitset) is saved to the SD card so
+* that the no-repeat guarantee carries across sessions. If the pool size changes between
+* sessions the shuffle starts again, but questions already marked seen are still skipped.
+*/
+
+#ifndef QUESTIONSCHEDULER_H_
+#define QUESTIONSCHEDULER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "Questions.h"
+
+// Largest pool per difficulty, larger pools only use their first QUESTION_SCHEDULER_MAX_POOL questions
+#define QUESTION_SCHEDULER_MAX_POOL 131072
+
+#define QUESTION_SCHEDULER_MAGIC   0x3153514Du  // "MQS1"
+#define QUESTION_SCHEDULER_VERSION 1
+
+typedef struct {
+    uint32_t pool;           // Questions in the pool
+    uint32_t drawn;          // Shuffle position in the current cycle
+    uint32_t seen;           // Questions seen in the current cycle
+    uint32_t cycles;         // Completed passes through the pool
+    uint32_t skipped;        // Draws skipped because the question was seen in a previous session
+} QuestionSchedulerStats;
+
+// Set the pool size of each difficulty and start a fresh shuffle from seed
+void QuestionScheduler_initialise(const uint32_t pool[DIFFICULTY_COUNT], uint64_t seed);
+
+// Next question index of a difficulty, never repeating until the whole pool has been seen.
+// The pool of the difficulty must not be empty.
+uint32_t QuestionScheduler_next(Difficulty difficulty);
+
+// Restore the state saved by a previous session. Returns false if there is none.
+bool QuestionScheduler_load(const char* path);
+
+// Save the state for the next session
+bool QuestionScheduler_save(const char* path);
+
+// Read the statistics of a difficulty
+const QuestionSchedulerStats* QuestionScheduler_stats(Difficulty difficulty);
+
+// Print the scheduler statistics
+void QuestionScheduler_report(void);
+
+#endif
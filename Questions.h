@@ -0,0 +1,43 @@
+/*
+* Questions.h
+*
+* Question types shared by the game, the question generator and the question sources
+*/
+
+#ifndef QUESTIONS_H_
+#define QUESTIONS_H_
+
+#include <stdint.h>
+#include <limits.h>
+
+// Define difficulty levels.
+typedef enum { EASY, MEDIUM, HARD } Difficulty;
+
+#define DIFFICULTY_COUNT 3
+
+// Text storage for generated questions
+#define QUESTION_TEXT_LENGTH 48
+#define CHOICE_TEXT_LENGTH 8
+#define QUESTION_FORMULA_LENGTH 32
+
+// User answer value meaning the question timed out, outside any answer that can be entered
+#define NO_ANSWER INT_MIN
+
+// Question ids: bank questions set the top bit over their bank index, generated questions use their generator seed
+#define QUESTION_ID_BANK (1ULL << 63)
+
+// Define structure for math questions.
+typedef struct {
+    char question[QUESTION_TEXT_LENGTH];
+    int answer;  // Numeric answers for Medium and Hard.
+    char choices[4][CHOICE_TEXT_LENGTH];  // Multiple-choice for Easy level.
+    int correct_choice;  // Correct choice index for Easy level.
+    int user_answer;  // User provided answer.
+    uint8_t screen;  // Question image to show (ShowScreen id), 0 to draw the text
+    uint64_t id;  // Identifies the question so it can be asked again (QUESTION_ID_BANK)
+    uint32_t response_ticks;  // Time taken to answer, in timer wheel ticks
+    uint32_t response_us;  // Question drawn to answer key, in microseconds
+    char formula[QUESTION_FORMULA_LENGTH];  // Formula the answer is checked against (Expr.h), empty if none
+} MathQuestion;
+
+#endif
@@ -0,0 +1,270 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Input trace recorder and player. Records are packed into a static buffer and written
+ * to the SD card a buffer at a time, so recording costs a few instructions per input
+ * read and one f_write every few thousand reads. Replay reads the trace back through
+ * the same buffer.
+ */
+
+#include "Replay.h"
+#include "Hal.h"
+#include "Crc32.h"
+#include "FatFS/ff.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VARINT_MAX_BYTES 5       // A 32-bit difference with the 3 channel bits above it
+#define CHANNEL_BITS 3
+
+static ReplayMode replay_mode;
+static ReplayStats replay_stats;
+static FIL trace_file;
+static uint8_t trace_buffer[REPLAY_BUFFER_SIZE];
+static UINT buffer_used;         // Recording: bytes waiting to be written
+static UINT buffer_read;         // Replay: bytes of the buffer consumed
+static uint32_t last_value[REPLAY_CHANNEL_COUNT];
+
+/*
+ * Function: state_crc
+ * Description: CRC of the files the game state is loaded from, a missing file counting as empty
+ */
+static uint32_t state_crc(const char* const* state_files) {
+    uint8_t chunk[256];
+    uint32_t crc = 0;
+
+    for (; state_files && *state_files; state_files++) {
+        FIL file;
+        UINT read_size = 0;
+        if (f_open(&file, *state_files, FA_READ) != FR_OK) continue;
+        while (f_read(&file, chunk, sizeof(chunk), &read_size) == FR_OK && read_size > 0) {
+            crc = Crc32_update(crc, chunk, read_size);
+        }
+        f_close(&file);
+    }
+    return crc;
+}
+
+/*
+ * Function: write_buffer
+ * Description: Writes the buffered records to the trace. Recording stops if the card fails.
+ */
+static void write_buffer(void) {
+    UINT written = 0;
+
+    if (buffer_used == 0) return;
+    if (f_write(&trace_file, trace_buffer, buffer_used, &written) != FR_OK || written != buffer_used) {
+        replay_stats.write_errors++;
+        replay_mode = REPLAY_OFF;
+        f_close(&trace_file);
+        printf("Replay: write to the SD card failed, recording stopped\n");
+    }
+    buffer_used = 0;
+}
+
+/*
+ * Function: read_byte
+ * Description: Next trace byte, refilling the buffer from the card. Returns -1 at the end of the trace.
+ */
+static int read_byte(void) {
+    if (buffer_read == buffer_used) {
+        if (f_read(&trace_file, trace_buffer, sizeof(trace_buffer), &buffer_used) != FR_OK) buffer_used = 0;
+        buffer_read = 0;
+        if (buffer_used == 0) return -1;
+    }
+    replay_stats.bytes++;
+    return trace_buffer[buffer_read++];
+}
+
+/*
+ * Function: stop_replay
+ * Description: Ends a replay run, with the counters printed
+ */
+static void stop_replay(int status) {
+    Replay_report();
+    f_close(&trace_file);
+    replay_mode = REPLAY_OFF;
+    exit(status);
+}
+
+/**
+ * Function: Replay_start
+ * Description: Opens a trace for recording (created or truncated) or replay, and checks a
+ *              replayed trace against this build and the card
+ * Input(s): ReplayMode mode, const char* path, uint16_t flags, const char* const* state_files
+ * Return: bool - true if inputs are now recorded or replayed
+ */
+bool Replay_start(ReplayMode mode, const char* path, uint16_t flags, const char* const* state_files) {
+    ReplayHeader header;
+    UINT size = 0;
+
+    replay_mode = REPLAY_OFF;
+    memset(&replay_stats, 0, sizeof(replay_stats));
+    memset(last_value, 0, sizeof(last_value));
+    buffer_used = 0;
+    buffer_read = 0;
+    if (mode == REPLAY_OFF) return false;
+
+    if (mode == REPLAY_RECORD) {
+        memset(&header, 0, sizeof(header));
+        header.magic = REPLAY_MAGIC;
+        header.version = REPLAY_VERSION;
+        header.flags = flags;
+        header.timer_hz = HAL_TIMER_HZ;
+        header.state_crc = state_crc(state_files);
+        if (f_open(&trace_file, path, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) {
+            printf("Replay: cannot create %s\n", path);
+            return false;
+        }
+        if (f_write(&trace_file, &header, sizeof(header), &size) != FR_OK || size != sizeof(header)) {
+            f_close(&trace_file);
+            printf("Replay: cannot write %s\n", path);
+            return false;
+        }
+        printf("Replay: recording inputs to %s\n", path);
+    } else {
+        if (f_open(&trace_file, path, FA_READ) != FR_OK) {
+            printf("Replay: cannot open %s\n", path);
+            return false;
+        }
+        if (f_read(&trace_file, &header, sizeof(header), &size) != FR_OK || size != sizeof(header) ||
+            header.magic != REPLAY_MAGIC || header.version != REPLAY_VERSION) {
+            f_close(&trace_file);
+            printf("Replay: %s is not an input trace\n", path);
+            return false;
+        }
+        if (header.timer_hz != HAL_TIMER_HZ || header.flags != flags) {
+            f_close(&trace_file);
+            printf("Replay: %s was recorded by a build with a different timer or RENDER_WORKER\n", path);
+            return false;
+        }
+        if (header.state_crc != state_crc(state_files)) {
+            printf("Replay: the card's saved state differs from when %s was recorded, expect divergence\n", path);
+        }
+        printf("Replay: replaying inputs from %s\n", path);
+    }
+    replay_mode = mode;
+    return true;
+}
+
+/**
+ * Function: Replay_playing
+ * Description: Tells whether inputs come from a trace
+ * Input(s): None
+ * Return: bool - true while replaying
+ */
+bool Replay_playing(void) {
+    return replay_mode == REPLAY_PLAY;
+}
+
+/**
+ * Function: Replay_record
+ * Description: Appends an input value to the trace when recording
+ * Input(s): ReplayChannel channel, uint32_t value - as read from the hardware
+ * Return: uint32_t - value
+ */
+uint32_t Replay_record(ReplayChannel channel, uint32_t value) {
+    uint32_t difference;
+    uint64_t record;
+
+    if (replay_mode != REPLAY_RECORD) return value;
+
+    // The timer only counts up, everything else changes a few bits at a time
+    difference = (channel == REPLAY_TIMER) ? value - last_value[channel] : value ^ last_value[channel];
+    if ((channel == REPLAY_KEYS || channel == REPLAY_SWITCHES) && difference != 0) replay_stats.changes++;
+    last_value[channel] = value;
+
+    if (buffer_used > sizeof(trace_buffer) - VARINT_MAX_BYTES) write_buffer();
+    record = ((uint64_t)difference << CHANNEL_BITS) | channel;
+    do {
+        uint8_t byte = record & 0x7F;
+        record >>= 7;
+        trace_buffer[buffer_used++] = byte | (record ? 0x80 : 0);
+        replay_stats.bytes++;
+    } while (record);
+    replay_stats.inputs++;
+    return value;
+}
+
+/**
+ * Function: Replay_next
+ * Description: Reads the next input value from the trace. The run ends when the trace does,
+ *              or with REPLAY_DIVERGED_STATUS if the trace holds a different channel next.
+ * Input(s): ReplayChannel channel
+ * Return: uint32_t - value as it was recorded
+ */
+uint32_t Replay_next(ReplayChannel channel) {
+    uint64_t record = 0;
+    unsigned int shift = 0;
+    uint32_t difference;
+    int byte;
+
+    do {
+        byte = read_byte();
+        if (byte < 0) {
+            if (shift > 0) {
+                printf("Replay: trace ends in the middle of a record\n");
+            }
+            printf("Replay: end of trace after %lu inputs\n", (unsigned long)replay_stats.inputs);
+            stop_replay(0);
+        }
+        record |= (uint64_t)(byte & 0x7F) << shift;
+        shift += 7;
+    } while ((byte & 0x80) && shift < 7 * VARINT_MAX_BYTES);
+
+    if ((record & ((1u << CHANNEL_BITS) - 1)) != channel) {
+        printf("Replay: diverged at input %lu, the game read channel %d where the trace has %d\n",
+               (unsigned long)replay_stats.inputs, (int)channel, (int)(record & ((1u << CHANNEL_BITS) - 1)));
+        stop_replay(REPLAY_DIVERGED_STATUS);
+    }
+
+    difference = (uint32_t)(record >> CHANNEL_BITS);
+    if (channel == REPLAY_TIMER) {
+        last_value[channel] += difference;
+    } else {
+        if ((channel == REPLAY_KEYS || channel == REPLAY_SWITCHES) && difference != 0) replay_stats.changes++;
+        last_value[channel] ^= difference;
+    }
+    replay_stats.inputs++;
+    return last_value[channel];
+}
+
+/**
+ * Function: Replay_flush
+ * Description: Writes buffered records and syncs the trace, so a session survives a power cut
+ * Input(s): None
+ * Return: void
+ */
+void Replay_flush(void) {
+    if (replay_mode != REPLAY_RECORD) return;
+    write_buffer();
+    if (replay_mode == REPLAY_RECORD && f_sync(&trace_file) != FR_OK) {
+        replay_stats.write_errors++;
+    }
+}
+
+/**
+ * Function: Replay_stats
+ * Description: Returns the recording or replay counters
+ * Input(s): None
+ * Return: const ReplayStats* - counters
+ */
+const ReplayStats* Replay_stats(void) {
+    return &replay_stats;
+}
+
+/**
+ * Function: Replay_report
+ * Description: Prints the recording or replay counters
+ * Input(s): None
+ * Return: void
+ */
+void Replay_report(void) {
+    if (replay_stats.inputs == 0) return;
+    printf("Replay: %lu inputs %s in %lu bytes (%lu.%02lu bytes each), %lu key and switch changes, %lu write errors\n",
+           (unsigned long)replay_stats.inputs, (replay_mode == REPLAY_RECORD) ? "recorded" : "replayed",
+           (unsigned long)replay_stats.bytes, (unsigned long)(replay_stats.bytes / replay_stats.inputs),
+           (unsigned long)(replay_stats.bytes * 100ull / replay_stats.inputs % 100),
+           (unsigned long)replay_stats.changes, (unsigned long)replay_stats.write_errors);
+}
@@ -0,0 +1,85 @@
+/*
+* Replay.h
+*
+* Input recording and replay
+*
+* Every input that steers the game (timer reads, push buttons, slide switches, whether the
+* worker is still playing a sound and, when audio is fed from core 0, the codec FIFO space)
+* is read through this module. When
+* recording, each value is appended to a trace file on the SD card; when replaying, the
+* values come back from a trace in the same order instead of from the hardware, so the
+* game takes exactly the same path. A classroom session recorded on the board can be
+* replayed in the host build under a profiler, and two builds can be timed on the same
+* workload.
+*
+* The trace is a header followed by one varint per input read: the channel in the low
+* three bits, above it the difference from the previous value of that channel (timer
+* counts since the last read, or the changed bits of the keys, switches or FIFO space).
+* An unchanged key read costs one byte.
+*
+* A replay needs the card as it was when recording started (question bank, schedule
+* and practice history). The header holds a CRC of those files and a mismatch is
+* reported. The run ends when the trace does; if the game asks for a different input
+* than the trace holds next, the replay has diverged and the run stops with status 5.
+* Waits for the render worker read no traced inputs, so with RENDER_WORKER the game's path
+* does not depend on how fast the worker draws, only how much it has drawn at a given
+* moment does.
+*/
+
+#ifndef REPLAY_H_
+#define REPLAY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define REPLAY_MAGIC   0x59504C52u  // "RLPY"
+#define REPLAY_VERSION 2
+
+#define REPLAY_BUFFER_SIZE 4096     // Trace bytes buffered between SD card writes or reads
+#define REPLAY_DIVERGED_STATUS 5    // Exit status when a replay stops matching its trace
+
+// Header flags: build options that change which inputs are read
+#define REPLAY_FLAG_RENDER_WORKER 0x1
+
+typedef enum { REPLAY_OFF, REPLAY_RECORD, REPLAY_PLAY, REPLAY_MODE_COUNT } ReplayMode;
+
+typedef enum { REPLAY_TIMER, REPLAY_KEYS, REPLAY_SWITCHES, REPLAY_AUDIO_SPACE, REPLAY_SOUND_BUSY, REPLAY_CHANNEL_COUNT } ReplayChannel;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t flags;
+    uint32_t timer_hz;         // Counts per second of the recorded timer
+    uint32_t state_crc;        // Of the card files the game state is loaded from
+} ReplayHeader;
+
+typedef struct {
+    uint32_t inputs;           // Values recorded or replayed
+    uint32_t bytes;            // Trace bytes after the header
+    uint32_t changes;          // Key and switch reads that differed from the previous one
+    uint32_t write_errors;     // Recording stops at the first one
+} ReplayStats;
+
+// Start recording to, or replaying from, path. state_files is a null terminated list of the
+// card files the game loads its state from. Returns false, leaving inputs live, on failure.
+bool Replay_start(ReplayMode mode, const char* path, uint16_t flags, const char* const* state_files);
+
+// True while inputs come from a trace rather than the hardware
+bool Replay_playing(void);
+
+// Record a value read from the hardware, if recording. Returns the value.
+uint32_t Replay_record(ReplayChannel channel, uint32_t value);
+
+// Next value of a channel from the trace. Exits when the trace ends or has diverged.
+uint32_t Replay_next(ReplayChannel channel);
+
+// Write buffered trace bytes to the card and sync the file
+void Replay_flush(void);
+
+// Recording or replay counters
+const ReplayStats* Replay_stats(void);
+
+// Print the counters, if recording or replaying
+void Replay_report(void);
+
+#endif
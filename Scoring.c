@@ -0,0 +1,109 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Time bonus scoring. Points are integer arithmetic on the measured response time; the
+ * session array is filled in answer order and only read back at the end of the session.
+ */
+
+#include "Scoring.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * Function: Scoring_initialise
+ * Description: Sets the storage for the session's responses and clears the session
+ * Input(s): ScoreSession* session, ScoreResponse* storage, uint32_t capacity - entries in storage
+ * Return: void
+ */
+void Scoring_initialise(ScoreSession* session, ScoreResponse* storage, uint32_t capacity) {
+    session->responses = storage;
+    session->capacity = storage ? capacity : 0;
+    Scoring_reset(session);
+}
+
+/**
+ * Function: Scoring_reset
+ * Description: Starts a new session
+ * Input(s): ScoreSession* session
+ * Return: void
+ */
+void Scoring_reset(ScoreSession* session) {
+    session->count = 0;
+    session->answered = 0;
+    session->correct = 0;
+    session->points = 0;
+    session->bonus = 0;
+}
+
+/**
+ * Function: Scoring_points
+ * Description: Scores one answer
+ * Input(s): Difficulty difficulty, bool correct, uint32_t latency_us - response time,
+ *           uint32_t window_us - time allowed for the answer
+ * Return: uint32_t - points
+ */
+uint32_t Scoring_points(Difficulty difficulty, bool correct, uint32_t latency_us, uint32_t window_us) {
+    uint32_t base = SCORING_BASE_POINTS * ((uint32_t)difficulty + 1);
+
+    if (!correct) return 0;
+    if (latency_us <= SCORING_FULL_BONUS_US) return 2 * base;
+    if (latency_us >= window_us) return base;
+    // Linear from the full bonus at SCORING_FULL_BONUS_US to none at the end of the window
+    return base + (uint32_t)((uint64_t)base * (window_us - latency_us) / (window_us - SCORING_FULL_BONUS_US));
+}
+
+/**
+ * Function: Scoring_record
+ * Description: Scores an answer, adds it to the session total and keeps it if there is room
+ * Input(s): ScoreSession* session, Difficulty difficulty, bool correct, uint32_t latency_us,
+ *           uint32_t window_us
+ * Return: uint32_t - points awarded
+ */
+uint32_t Scoring_record(ScoreSession* session, Difficulty difficulty, bool correct, uint32_t latency_us, uint32_t window_us) {
+    uint32_t points = Scoring_points(difficulty, correct, latency_us, window_us);
+
+    session->answered++;
+    session->correct += correct;
+    session->points += points;
+    if (correct) session->bonus += points - SCORING_BASE_POINTS * ((uint32_t)difficulty + 1);
+
+    if (session->count < session->capacity) {
+        ScoreResponse* response = &session->responses[session->count++];
+        response->latency_us = latency_us;
+        response->points = (uint16_t)points;
+        response->difficulty = (uint8_t)difficulty;
+        response->correct = correct;
+    }
+    return points;
+}
+
+/**
+ * Function: Scoring_report
+ * Description: Prints the session points and the fastest and mean correct response times
+ * Input(s): const ScoreSession* session
+ * Return: void
+ */
+void Scoring_report(const ScoreSession* session) {
+    uint64_t total_us = 0;
+    uint32_t fastest_us = UINT32_MAX;
+    uint32_t correct = 0;
+
+    for (uint32_t i = 0; i < session->count; i++) {
+        const ScoreResponse* response = &session->responses[i];
+        if (!response->correct) continue;
+        correct++;
+        total_us += response->latency_us;
+        if (response->latency_us < fastest_us) fastest_us = response->latency_us;
+    }
+
+    printf("Points: %lu (%lu time bonus) from %lu answers\n", (unsigned long)session->points,
+           (unsigned long)session->bonus, (unsigned long)session->answered);
+    if (correct) {
+        printf("Correct answers: fastest %lu us, mean %lu us\n", (unsigned long)fastest_us,
+               (unsigned long)(total_us / correct));
+    }
+    if (session->answered > session->count) {
+        printf("Scoring: %lu responses not kept, session array holds %lu\n",
+               (unsigned long)(session->answered - session->count), (unsigned long)session->capacity);
+    }
+}
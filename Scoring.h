@@ -0,0 +1,63 @@
+/*
+* Scoring.h
+*
+* Response times and time bonus scoring
+*
+* Each answer is worth base points for its difficulty plus a time bonus. The bonus is
+* the full base again for an answer within SCORING_FULL_BONUS_US of the question being
+* drawn, falling linearly to nothing at the end of the answer window. Wrong answers and
+* timeouts score nothing.
+*
+* Every answer of the session is kept, with its response time in microseconds, in an
+* array the caller provides (carved from the question arena), so the session can be
+* exported once it is over. Answers beyond its capacity still score but are not kept.
+*/
+
+#ifndef SCORING_H_
+#define SCORING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "Questions.h"
+
+#define SCORING_BASE_POINTS     10        // Points for a correct Easy answer, doubled for Medium, tripled for Hard
+#define SCORING_FULL_BONUS_US   1000000   // Answers this quick get the whole bonus
+
+// Responses kept when the session length is not configured, and at most for a longer session
+#define SCORING_DEFAULT_RESPONSES 256
+#define SCORING_MAX_RESPONSES     4096    // 32KB
+
+// One answered question
+typedef struct {
+    uint32_t latency_us;     // Question drawn to answer key, the whole window for a timeout
+    uint16_t points;         // Points awarded, bonus included
+    uint8_t difficulty;
+    uint8_t correct;
+} ScoreResponse;
+
+typedef struct {
+    ScoreResponse* responses;
+    uint32_t capacity;
+    uint32_t count;          // Responses kept
+    uint32_t answered;       // Responses recorded, including those not kept
+    uint32_t correct;
+    uint32_t points;         // Session total
+    uint32_t bonus;          // Part of the total earned by answering quickly
+} ScoreSession;
+
+// Keep the session's responses in storage, which holds capacity entries
+void Scoring_initialise(ScoreSession* session, ScoreResponse* storage, uint32_t capacity);
+
+// Start a new session, forgetting the responses of the previous one
+void Scoring_reset(ScoreSession* session);
+
+// Points for an answer: base points for the difficulty plus the time bonus
+uint32_t Scoring_points(Difficulty difficulty, bool correct, uint32_t latency_us, uint32_t window_us);
+
+// Score an answer and keep it in the session. Returns the points awarded.
+uint32_t Scoring_record(ScoreSession* session, Difficulty difficulty, bool correct, uint32_t latency_us, uint32_t window_us);
+
+// Print the session points and response times
+void Scoring_report(const ScoreSession* session);
+
+#endif
@@ -0,0 +1,278 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Append-only session log with a CRC per record, and the high-score table derived from
+ * it. Records are validated while streaming them through a small buffer, so recovery
+ * needs no memory proportional to the log. The table file is rewritten whole after each
+ * append; losing it to a torn write only costs a rebuild from the log.
+ */
+
+#include "SessionLog.h"
+#include "Crc32.h"
+#include "FatFS/ff.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SCAN_CHUNK 32  // ScoreResponse entries read at a time while checking a record
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    uint32_t log_bytes;        // Log length the table covers
+    uint32_t next_sequence;
+    HighScore scores[HIGH_SCORE_COUNT];
+    uint32_t crc;              // Of everything above
+} HighScoreFile;
+
+static HighScoreFile table;
+static SessionLogStats log_stats;
+static const char* session_log_path;
+static const char* high_score_path;
+static bool log_usable;
+
+/*
+ * Function: table_insert
+ * Description: Places a session in the table by points, earlier sessions first on a tie
+ */
+static int table_insert(const SessionLogHeader* header) {
+    int place = table.count;
+
+    while (place > 0 && table.scores[place - 1].points < header->points) place--;
+    if (place >= HIGH_SCORE_COUNT) return -1;
+
+    int last = (table.count < HIGH_SCORE_COUNT) ? table.count : HIGH_SCORE_COUNT - 1;
+    memmove(&table.scores[place + 1], &table.scores[place], (last - place) * sizeof(HighScore));
+    HighScore* score = &table.scores[place];
+    memset(score, 0, sizeof(*score));
+    score->points = header->points;
+    score->sequence = header->sequence;
+    score->correct = header->correct;
+    score->answered = header->answered;
+    score->mode = header->mode;
+    score->difficulty = header->difficulty;
+    if (table.count < HIGH_SCORE_COUNT) table.count++;
+    return place;
+}
+
+static void table_clear(void) {
+    memset(&table, 0, sizeof(table));
+    table.magic = HIGH_SCORE_MAGIC;
+    table.version = HIGH_SCORE_VERSION;
+}
+
+static bool table_load(void) {
+    FIL file;
+    UINT read_size = 0;
+    bool ok;
+
+    if (f_open(&file, high_score_path, FA_READ) != FR_OK) return false;
+    ok = f_read(&file, &table, sizeof(table), &read_size) == FR_OK && read_size == sizeof(table);
+    f_close(&file);
+    return ok && table.magic == HIGH_SCORE_MAGIC && table.version == HIGH_SCORE_VERSION &&
+           table.count <= HIGH_SCORE_COUNT && table.crc == Crc32_update(0, &table, offsetof(HighScoreFile, crc));
+}
+
+static bool table_save(void) {
+    FIL file;
+    UINT written = 0;
+    bool ok;
+
+    table.crc = Crc32_update(0, &table, offsetof(HighScoreFile, crc));
+    if (f_open(&file, high_score_path, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) return false;
+    ok = f_write(&file, &table, sizeof(table), &written) == FR_OK && written == sizeof(table);
+    ok = (f_close(&file) == FR_OK) && ok;
+    return ok;
+}
+
+/*
+ * Function: read_record
+ * Description: Reads and checks the record at the current file position. Returns its size, 0 if it is torn or corrupt.
+ */
+static uint32_t read_record(FIL* file, SessionLogHeader* header) {
+    ScoreResponse chunk[SCAN_CHUNK];
+    UINT read_size = 0;
+    uint32_t crc, stored_crc;
+
+    if (f_read(file, header, sizeof(*header), &read_size) != FR_OK || read_size != sizeof(*header)) return 0;
+    if (header->magic != SESSION_LOG_MAGIC || header->version != SESSION_LOG_VERSION ||
+        header->response_count > SESSION_LOG_MAX_RESPONSES) return 0;
+
+    crc = Crc32_update(0, header, sizeof(*header));
+    for (uint32_t remaining = header->response_count; remaining > 0;) {
+        uint32_t count = (remaining < SCAN_CHUNK) ? remaining : SCAN_CHUNK;
+        UINT bytes = count * sizeof(ScoreResponse);
+        if (f_read(file, chunk, bytes, &read_size) != FR_OK || read_size != bytes) return 0;
+        crc = Crc32_update(crc, chunk, bytes);
+        remaining -= count;
+    }
+    if (f_read(file, &stored_crc, sizeof(stored_crc), &read_size) != FR_OK || read_size != sizeof(stored_crc) ||
+        stored_crc != crc) return 0;
+
+    return sizeof(*header) + header->response_count * sizeof(ScoreResponse) + sizeof(stored_crc);
+}
+
+/**
+ * Function: SessionLog_open
+ * Description: Loads the high-score table, indexes any log records it does not cover yet and
+ *              cuts a torn record off the end of the log
+ * Input(s): const char* log_path, const char* table_path
+ * Return: bool - true if sessions can be appended
+ */
+bool SessionLog_open(const char* log_path, const char* table_path) {
+    FIL file;
+    FSIZE_t size;
+    uint32_t offset;
+    bool changed = false;
+
+    session_log_path = log_path;
+    high_score_path = table_path;
+    memset(&log_stats, 0, sizeof(log_stats));
+    log_usable = false;
+
+    if (f_open(&file, log_path, FA_READ | FA_WRITE | FA_OPEN_ALWAYS) != FR_OK) return false;
+    size = f_size(&file);
+
+    if (!table_load() || table.log_bytes > size) {
+        // No table, or one for a different log: index the whole log
+        if (size > 0) log_stats.rebuilds++;
+        table_clear();
+        changed = true;
+    }
+
+    offset = table.log_bytes;
+    if (f_lseek(&file, offset) != FR_OK) {
+        f_close(&file);
+        return false;
+    }
+    while (offset < size) {
+        SessionLogHeader header;
+        uint32_t record_size = read_record(&file, &header);
+        if (record_size == 0) break;
+        table_insert(&header);
+        if (header.sequence >= table.next_sequence) table.next_sequence = header.sequence + 1;
+        offset += record_size;
+        log_stats.recovered++;
+        changed = true;
+    }
+
+    if (offset < size) {
+        // Torn or corrupt tail, most likely a power cut during an append
+        log_stats.truncated_bytes = (uint32_t)(size - offset);
+        if (f_lseek(&file, offset) != FR_OK || f_truncate(&file) != FR_OK) {
+            f_close(&file);
+            return false;
+        }
+        printf("Session log: cut %lu bytes of a torn record\n", (unsigned long)log_stats.truncated_bytes);
+        changed = true;
+    }
+    if (f_close(&file) != FR_OK) return false;
+
+    table.log_bytes = offset;
+    if (changed) table_save();
+    log_usable = true;
+    return true;
+}
+
+/**
+ * Function: SessionLog_append
+ * Description: Writes a finished session to the log as one record with a single f_sync,
+ *              then updates the high-score table
+ * Input(s): const ScoreSession* session, uint8_t mode, uint8_t difficulty, uint32_t uptime_s
+ * Return: int - place in the high-score table, -1 if not placed or not written
+ */
+int SessionLog_append(const ScoreSession* session, uint8_t mode, uint8_t difficulty, uint32_t uptime_s) {
+    SessionLogHeader header;
+    FIL file;
+    UINT written = 0;
+    UINT response_bytes;
+    uint32_t crc;
+    bool ok;
+    int place;
+
+    if (!log_usable) return -1;
+
+    memset(&header, 0, sizeof(header));
+    header.magic = SESSION_LOG_MAGIC;
+    header.version = SESSION_LOG_VERSION;
+    header.response_count = (uint16_t)((session->count < SESSION_LOG_MAX_RESPONSES) ? session->count : SESSION_LOG_MAX_RESPONSES);
+    header.sequence = table.next_sequence;
+    header.uptime_s = uptime_s;
+    header.points = session->points;
+    header.correct = (uint16_t)session->correct;
+    header.answered = (uint16_t)session->answered;
+    header.mode = mode;
+    header.difficulty = difficulty;
+    response_bytes = header.response_count * sizeof(ScoreResponse);
+    crc = Crc32_update(Crc32_update(0, &header, sizeof(header)), session->responses, response_bytes);
+
+    // Write over anything past the indexed length, so the log never holds a gap
+    if (f_open(&file, session_log_path, FA_WRITE | FA_OPEN_ALWAYS) != FR_OK) {
+        log_stats.write_errors++;
+        return -1;
+    }
+    ok = f_lseek(&file, table.log_bytes) == FR_OK;
+    ok = ok && f_write(&file, &header, sizeof(header), &written) == FR_OK && written == sizeof(header);
+    ok = ok && f_write(&file, session->responses, response_bytes, &written) == FR_OK && written == response_bytes;
+    ok = ok && f_write(&file, &crc, sizeof(crc), &written) == FR_OK && written == sizeof(crc);
+    ok = ok && f_sync(&file) == FR_OK;
+    ok = (f_close(&file) == FR_OK) && ok;
+    if (!ok) {
+        log_stats.write_errors++;
+        return -1;
+    }
+
+    table.log_bytes += sizeof(header) + response_bytes + sizeof(crc);
+    table.next_sequence++;
+    place = table_insert(&header);
+    if (!table_save()) log_stats.write_errors++;
+    return place;
+}
+
+/**
+ * Function: SessionLog_highScores
+ * Description: Returns the high-score table
+ * Input(s): unsigned int* count - filled in with the number of entries
+ * Return: const HighScore* - entries, best first
+ */
+const HighScore* SessionLog_highScores(unsigned int* count) {
+    *count = table.count;
+    return table.scores;
+}
+
+/**
+ * Function: SessionLog_stats
+ * Description: Returns the log statistics
+ * Input(s): None
+ * Return: const SessionLogStats* - statistics
+ */
+const SessionLogStats* SessionLog_stats(void) {
+    log_stats.sessions = table.next_sequence;
+    return &log_stats;
+}
+
+/**
+ * Function: SessionLog_report
+ * Description: Prints the high-score table and the log statistics
+ * Input(s): None
+ * Return: void
+ */
+void SessionLog_report(void) {
+    static const char* const mode_names[] = { "normal", "practice", "blitz" };
+    static const char* const level_names[DIFFICULTY_COUNT] = { "easy", "medium", "hard" };
+
+    if (!log_usable) return;
+    printf("High scores:\n");
+    for (unsigned int i = 0; i < table.count; i++) {
+        const HighScore* score = &table.scores[i];
+        printf("%2u. %5lu points  %u/%u correct  %s %s  (session %lu)\n", i + 1, (unsigned long)score->points,
+               score->correct, score->answered,
+               (score->mode < 3) ? mode_names[score->mode] : "?",
+               (score->difficulty < DIFFICULTY_COUNT) ? level_names[score->difficulty] : "?",
+               (unsigned long)score->sequence);
+    }
+    printf("Session log: %lu sessions, %lu bytes, %lu recovered at boot, %lu torn bytes cut, %lu write errors\n",
+           (unsigned long)table.next_sequence, (unsigned long)table.log_bytes, (unsigned long)log_stats.recovered,
+           (unsigned long)log_stats.truncated_bytes, (unsigned long)log_stats.write_errors);
+}
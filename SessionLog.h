@@ -0,0 +1,86 @@
+/*
+* SessionLog.h
+*
+* Session log and high-score table on the SD card
+*
+* Every finished session is appended to a binary log: a header with the session totals,
+* then each answer's ScoreResponse, then a CRC-32 of both. Nothing is written while a
+* session is being played; the whole record goes out in one batch at game over and is
+* committed with a single f_sync.
+*
+* The top HIGH_SCORE_COUNT sessions are kept in a small table file, together with how
+* many bytes of the log it covers. The log is the authority: at boot only the part of
+* the log after that point is checked, records that pass their CRC are added to the
+* table, and a torn record left by a power cut is cut off. If the table itself fails its
+* CRC it is rebuilt from the whole log.
+*
+* Log layout:
+*     SessionLogHeader, ScoreResponse[response_count], uint32_t crc    (repeated)
+*/
+
+#ifndef SESSIONLOG_H_
+#define SESSIONLOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "Scoring.h"
+
+#define SESSION_LOG_MAGIC   0x314C514Du  // "MQL1"
+#define SESSION_LOG_VERSION 1
+#define HIGH_SCORE_MAGIC    0x3148514Du  // "MQH1"
+#define HIGH_SCORE_VERSION  1
+
+#define HIGH_SCORE_COUNT 10
+
+// Responses accepted in one record when reading the log back
+#define SESSION_LOG_MAX_RESPONSES 4096
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t response_count;   // ScoreResponse entries after the header
+    uint32_t sequence;         // Session number, counting up across power cycles
+    uint32_t uptime_s;         // Seconds since boot when the session ended; the board has no real time clock
+    uint32_t points;
+    uint16_t correct;
+    uint16_t answered;
+    uint8_t mode;              // Game mode (normal, practice, blitz)
+    uint8_t difficulty;        // Last difficulty played
+    uint16_t reserved;
+} SessionLogHeader;
+
+typedef struct {
+    uint32_t points;
+    uint32_t sequence;         // Session in the log
+    uint16_t correct;
+    uint16_t answered;
+    uint8_t mode;
+    uint8_t difficulty;
+    uint16_t reserved;
+} HighScore;
+
+typedef struct {
+    uint32_t sessions;         // Sessions in the log
+    uint32_t recovered;        // Records added to the table from the log at boot
+    uint32_t truncated_bytes;  // Torn record bytes cut from the end of the log
+    uint32_t rebuilds;         // Times the table was rebuilt from the whole log
+    uint32_t write_errors;
+} SessionLogStats;
+
+// Check the log against the high-score table, recovering as described above. Returns false if the log cannot be used.
+bool SessionLog_open(const char* log_path, const char* table_path);
+
+// Append a finished session and update the high-score table.
+// Returns the session's place in the table (0 for the best), or -1 if it did not make it or could not be written.
+int SessionLog_append(const ScoreSession* session, uint8_t mode, uint8_t difficulty, uint32_t uptime_s);
+
+// The high-score table, best first
+const HighScore* SessionLog_highScores(unsigned int* count);
+
+// Read the log statistics
+const SessionLogStats* SessionLog_stats(void);
+
+// Print the high-score table and log statistics
+void SessionLog_report(void);
+
+#endif
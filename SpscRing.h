@@ -0,0 +1,133 @@
+/*
+* SpscRing.h
+*
+* Lock-free single-producer/single-consumer ring buffer
+*
+* Header-only, typed through a declaration macro (the C stand-in for a template):
+*
+*     SPSC_RING_DECLARE(SampleRing, int16_t, 1024)
+*
+* declares the type SampleRing and the functions SampleRing_init, SampleRing_push,
+* SampleRing_pop, SampleRing_pushBatch, SampleRing_popBatch, SampleRing_size and
+* SampleRing_capacity. Capacity must be a power of two.
+*
+* Exactly one context may push (an ISR, core 0, ...) and exactly one may pop. Indices are
+* free running 32-bit counters published with release stores and read with acquire loads.
+* The producer's and consumer's fields live on separate cache lines, and each side keeps a
+* cached copy of the other side's index so it only touches the shared line when the ring
+* looks full (or empty).
+*/
+
+#ifndef SPSCRING_H_
+#define SPSCRING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+// L1 data cache line size: 32 bytes on the Cortex-A9, 64 on typical hosts
+#ifndef SPSC_CACHE_LINE
+#if defined(__arm__)
+#define SPSC_CACHE_LINE 32
+#else
+#define SPSC_CACHE_LINE 64
+#endif
+#endif
+
+#define SPSC_ALIGNED __attribute__((aligned(SPSC_CACHE_LINE)))
+
+#define SPSC_LOAD_ACQUIRE(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define SPSC_STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+#define SPSC_RING_DECLARE(name, type, capacity)                                            \
+    typedef char name##_capacity_must_be_power_of_two                                      \
+        [((capacity) > 0 && ((capacity) & ((capacity) - 1)) == 0) ? 1 : -1];                \
+                                                                                           \
+    typedef struct {                                                                       \
+        SPSC_ALIGNED uint32_t head;   /* Next slot to write, owned by the producer */      \
+        uint32_t cached_tail;         /* Producer's last view of tail */                   \
+        SPSC_ALIGNED uint32_t tail;   /* Next slot to read, owned by the consumer */       \
+        uint32_t cached_head;         /* Consumer's last view of head */                   \
+        SPSC_ALIGNED type slots[(capacity)];                                               \
+    } name;                                                                                \
+                                                                                           \
+    /* Empty the ring. Only safe while neither side is using it. */                        \
+    static inline void name##_init(name* ring) {                                           \
+        ring->head = ring->cached_tail = 0;                                                \
+        ring->tail = ring->cached_head = 0;                                                \
+    }                                                                                      \
+                                                                                           \
+    static inline uint32_t name##_capacity(void) {                                         \
+        return (capacity);                                                                 \
+    }                                                                                      \
+                                                                                           \
+    /* Items currently queued (approximate while the other side is active) */              \
+    static inline uint32_t name##_size(const name* ring) {                                 \
+        return SPSC_LOAD_ACQUIRE(&ring->head) - SPSC_LOAD_ACQUIRE(&ring->tail);            \
+    }                                                                                      \
+                                                                                           \
+    /* Producer: free slots, refreshing the cached tail only when needed */                \
+    static inline uint32_t name##_space(name* ring, uint32_t wanted) {                     \
+        uint32_t free_slots = (capacity) - (ring->head - ring->cached_tail);               \
+        if (free_slots < wanted) {                                                         \
+            ring->cached_tail = SPSC_LOAD_ACQUIRE(&ring->tail);                            \
+            free_slots = (capacity) - (ring->head - ring->cached_tail);                    \
+        }                                                                                  \
+        return free_slots;                                                                 \
+    }                                                                                      \
+                                                                                           \
+    /* Consumer: queued items, refreshing the cached head only when needed */              \
+    static inline uint32_t name##_available(name* ring, uint32_t wanted) {                 \
+        uint32_t queued = ring->cached_head - ring->tail;                                  \
+        if (queued < wanted) {                                                             \
+            ring->cached_head = SPSC_LOAD_ACQUIRE(&ring->head);                            \
+            queued = ring->cached_head - ring->tail;                                       \
+        }                                                                                  \
+        return queued;                                                                     \
+    }                                                                                      \
+                                                                                           \
+    /* Producer: add one item, returns false if the ring is full */                        \
+    static inline bool name##_push(name* ring, const type* item) {                         \
+        if (name##_space(ring, 1) == 0) return false;                                      \
+        ring->slots[ring->head & ((capacity) - 1)] = *item;                                \
+        SPSC_STORE_RELEASE(&ring->head, ring->head + 1);                                   \
+        return true;                                                                       \
+    }                                                                                      \
+                                                                                           \
+    /* Consumer: remove one item, returns false if the ring is empty */                    \
+    static inline bool name##_pop(name* ring, type* item) {                                \
+        if (name##_available(ring, 1) == 0) return false;                                  \
+        *item = ring->slots[ring->tail & ((capacity) - 1)];                                \
+        SPSC_STORE_RELEASE(&ring->tail, ring->tail + 1);                                   \
+        return true;                                                                       \
+    }                                                                                      \
+                                                                                           \
+    /* Producer: add up to count items with at most two copies, returns the number added */ \
+    static inline uint32_t name##_pushBatch(name* ring, const type* items, uint32_t count) { \
+        uint32_t free_slots = name##_space(ring, count);                                   \
+        uint32_t start = ring->head & ((capacity) - 1);                                    \
+        uint32_t first;                                                                    \
+        if (count > free_slots) count = free_slots;                                        \
+        first = (capacity) - start;                                                        \
+        if (first > count) first = count;                                                  \
+        memcpy(&ring->slots[start], items, first * sizeof(type));                          \
+        memcpy(&ring->slots[0], items + first, (count - first) * sizeof(type));            \
+        SPSC_STORE_RELEASE(&ring->head, ring->head + count);                               \
+        return count;                                                                      \
+    }                                                                                      \
+                                                                                           \
+    /* Consumer: remove up to count items with at most two copies, returns the number removed */ \
+    static inline uint32_t name##_popBatch(name* ring, type* items, uint32_t count) {      \
+        uint32_t queued = name##_available(ring, count);                                   \
+        uint32_t start = ring->tail & ((capacity) - 1);                                    \
+        uint32_t first;                                                                    \
+        if (count > queued) count = queued;                                                \
+        first = (capacity) - start;                                                        \
+        if (first > count) first = count;                                                  \
+        memcpy(items, &ring->slots[start], first * sizeof(type));                          \
+        memcpy(items + first, &ring->slots[0], (count - first) * sizeof(type));            \
+        SPSC_STORE_RELEASE(&ring->tail, ring->tail + count);                               \
+        return count;                                                                      \
+    }
+
+#endif
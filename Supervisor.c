@@ -0,0 +1,138 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Watchdog supervisor task. Runs as a periodic timer on the game timer wheel, so it is
+ * serviced from whichever event loop is currently polling timers. Each run checks the
+ * heartbeat flags of the monitored tasks and feeds the watchdog only if none has been
+ * silent for longer than its timeout.
+ */
+
+#include "Supervisor.h"
+#include <stdio.h>
+
+typedef struct {
+    volatile bool alive;     // Set by check-in, cleared by each supervisor run
+    bool monitored;          // Only monitored tasks can withhold the feed
+    uint32_t timeout;        // Ticks a task may stay silent
+    uint32_t silent;         // Ticks since the last check-in seen by the supervisor
+} SupervisedTask;
+
+static SupervisedTask tasks[SUPERVISOR_TASK_COUNT];
+static SupervisorStats supervisor_stats;
+static TimerNode supervisor_timer;
+static uint32_t supervisor_period;
+static void (*supervisor_feed)(void);
+
+static const char* const task_names[SUPERVISOR_TASK_COUNT] = { "event loop", "audio", "worker" };
+
+/*
+ * Function: supervisor_run
+ * Description: Timer callback, feeds the watchdog if every monitored task is alive
+ * Input(s): void* arg - unused
+ * Return: void
+ */
+static void supervisor_run(void* arg) {
+    bool healthy = true;
+    (void)arg;
+
+    supervisor_stats.checks++;
+    for (int i = 0; i < SUPERVISOR_TASK_COUNT; i++) {
+        SupervisedTask* task = &tasks[i];
+        if (!task->monitored) continue;
+
+        if (task->alive) {
+            task->alive = false;
+            task->silent = 0;
+        } else {
+            task->silent += supervisor_period;
+            if (task->silent >= task->timeout) {
+                if (supervisor_stats.stalled_task != i) {
+                    printf("Supervisor: %s stalled, withholding watchdog\n", task_names[i]);
+                }
+                supervisor_stats.stalled_task = i;
+                healthy = false;
+            }
+        }
+    }
+
+    if (healthy) {
+        supervisor_feed();
+        supervisor_stats.feeds++;
+    } else {
+        supervisor_stats.withheld++;
+    }
+}
+
+/**
+ * Function: Supervisor_initialise
+ * Description: Starts the supervisor timer with no tasks monitored yet
+ * Input(s): TimerWheel* wheel, uint32_t period_ticks - supervisor period, void (*feed)(void) - watchdog feed
+ * Return: void
+ */
+void Supervisor_initialise(TimerWheel* wheel, uint32_t period_ticks, void (*feed)(void)) {
+    for (int i = 0; i < SUPERVISOR_TASK_COUNT; i++) {
+        tasks[i] = (SupervisedTask){0};
+    }
+    supervisor_stats = (SupervisorStats){0};
+    supervisor_stats.stalled_task = -1;
+    supervisor_period = period_ticks;
+    supervisor_feed = feed;
+
+    supervisor_feed();
+    TimerWheel_start(wheel, &supervisor_timer, period_ticks, period_ticks, supervisor_run, 0);
+}
+
+/**
+ * Function: Supervisor_begin
+ * Description: Starts monitoring a task
+ * Input(s): SupervisorTask task, uint32_t timeout_ticks - longest allowed silence
+ * Return: void
+ */
+void Supervisor_begin(SupervisorTask task, uint32_t timeout_ticks) {
+    tasks[task].timeout = timeout_ticks;
+    tasks[task].silent = 0;
+    tasks[task].alive = true;
+    tasks[task].monitored = true;
+}
+
+/**
+ * Function: Supervisor_end
+ * Description: Stops monitoring a task
+ * Input(s): SupervisorTask task
+ * Return: void
+ */
+void Supervisor_end(SupervisorTask task) {
+    tasks[task].monitored = false;
+}
+
+/**
+ * Function: Supervisor_checkIn
+ * Description: Records a heartbeat from a task
+ * Input(s): SupervisorTask task
+ * Return: void
+ */
+void Supervisor_checkIn(SupervisorTask task) {
+    tasks[task].alive = true;
+}
+
+/**
+ * Function: Supervisor_stats
+ * Description: Returns the supervisor statistics
+ * Input(s): None
+ * Return: const SupervisorStats* - statistics
+ */
+const SupervisorStats* Supervisor_stats(void) {
+    return &supervisor_stats;
+}
+
+/**
+ * Function: Supervisor_report
+ * Description: Prints how often the watchdog was fed or withheld
+ * Input(s): None
+ * Return: void
+ */
+void Supervisor_report(void) {
+    printf("Supervisor: %lu feeds in %lu runs, %lu withheld\n",
+           (unsigned long)supervisor_stats.feeds, (unsigned long)supervisor_stats.checks,
+           (unsigned long)supervisor_stats.withheld);
+}
@@ -0,0 +1,53 @@
+/*
+* Supervisor.h
+*
+* Watchdog supervisor
+*
+* Owns the hardware watchdog once the game is running. Subsystems check in with a
+* heartbeat (a plain memory write) while they make progress; a periodic timer on the
+* timer wheel feeds the watchdog only if every monitored subsystem has checked in
+* within its timeout. A loop that spins without making progress therefore stops the
+* watchdog being fed instead of hiding the hang.
+*/
+
+#ifndef SUPERVISOR_H_
+#define SUPERVISOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "TimerWheel.h"
+
+// Subsystems that report heartbeats
+typedef enum {
+    SUPERVISOR_EVENT_LOOP,  // Game event loops (menus, question input)
+    SUPERVISOR_AUDIO,       // Audio FIFO feeding while a sound plays
+    SUPERVISOR_WORKER,      // Render/audio worker loop on core 1
+    SUPERVISOR_TASK_COUNT
+} SupervisorTask;
+
+typedef struct {
+    uint32_t feeds;          // Times the watchdog was fed
+    uint32_t checks;         // Supervisor runs
+    uint32_t withheld;       // Supervisor runs that did not feed because a task stalled
+    int stalled_task;        // Last task found stalled, -1 if none
+} SupervisorStats;
+
+// Start supervising: feed is called at most once every period_ticks while all monitored tasks are alive
+void Supervisor_initialise(TimerWheel* wheel, uint32_t period_ticks, void (*feed)(void));
+
+// Start monitoring a task, which must then check in at least once every timeout_ticks
+void Supervisor_begin(SupervisorTask task, uint32_t timeout_ticks);
+
+// Stop monitoring a task
+void Supervisor_end(SupervisorTask task);
+
+// Heartbeat from a task. Cheap enough for inner loops: it is a single store.
+void Supervisor_checkIn(SupervisorTask task);
+
+// Read the supervisor statistics
+const SupervisorStats* Supervisor_stats(void);
+
+// Print the supervisor statistics
+void Supervisor_report(void);
+
+#endif
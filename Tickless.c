@@ -0,0 +1,87 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Tickless idle policy. The event loops call Tickless_idle once per pass; it works out the
+ * earliest pending timer deadline and hands it to the platform sleep function, so the CPU
+ * only wakes for deadlines and interrupts rather than spinning on the private timer.
+ */
+
+#include "Tickless.h"
+#include <stdio.h>
+
+static TicklessStats tickless_stats;
+
+/**
+ * Function: Tickless_initialise
+ * Description: Clears the idle statistics
+ * Input(s): uint32_t now - current tick
+ * Return: void
+ */
+void Tickless_initialise(uint32_t now) {
+    tickless_stats = (TicklessStats){0};
+    tickless_stats.first_tick = now;
+}
+
+/**
+ * Function: Tickless_iteration
+ * Description: Counts one event loop pass
+ * Input(s): None
+ * Return: void
+ */
+void Tickless_iteration(void) {
+    tickless_stats.iterations++;
+}
+
+/**
+ * Function: Tickless_idle
+ * Description: Sleeps until the next timer deadline or max_ticks, whichever is sooner
+ * Input(s): const TimerWheel* wheel, uint32_t max_ticks - longest allowed sleep, TicklessSleep sleep - platform sleep
+ * Return: uint32_t - ticks slept for (0 if a timer is already due)
+ */
+uint32_t Tickless_idle(const TimerWheel* wheel, uint32_t max_ticks, TicklessSleep sleep) {
+#if TICKLESS_IDLE
+    uint32_t ticks = max_ticks;
+    uint32_t next;
+
+    if (TimerWheel_nextExpiry(wheel, &next) && next < ticks) {
+        ticks = next;
+    }
+    if (ticks == 0) return 0;
+
+    ticks = sleep(ticks);
+    tickless_stats.sleeps++;
+    tickless_stats.slept_ticks += ticks;
+    return ticks;
+#else
+    (void)wheel;
+    (void)max_ticks;
+    (void)sleep;
+    return 0;
+#endif
+}
+
+/**
+ * Function: Tickless_stats
+ * Description: Returns the idle statistics
+ * Input(s): None
+ * Return: const TicklessStats* - statistics
+ */
+const TicklessStats* Tickless_stats(void) {
+    return &tickless_stats;
+}
+
+/**
+ * Function: Tickless_report
+ * Description: Prints event loop iterations per second and how much time was spent asleep
+ * Input(s): uint32_t now - current tick, uint32_t ticks_per_second - tick rate
+ * Return: void
+ */
+void Tickless_report(uint32_t now, uint32_t ticks_per_second) {
+    uint32_t elapsed = now - tickless_stats.first_tick;
+    if (elapsed == 0) return;
+
+    printf("Idle: %lu loop iterations/s, %lu sleeps, %lu%% of time asleep\n",
+           (unsigned long)((uint64_t)tickless_stats.iterations * ticks_per_second / elapsed),
+           (unsigned long)tickless_stats.sleeps,
+           (unsigned long)(tickless_stats.slept_ticks * 100 / elapsed));
+}
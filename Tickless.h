@@ -0,0 +1,50 @@
+/*
+* Tickless.h
+*
+* Tickless idle
+*
+* Instead of spinning on the timer registers, an idle event loop asks the timer wheel
+* how long it is until the next deadline and sleeps for exactly that long. The sleep
+* itself is platform specific and is passed in as a function that arms a one-shot
+* wake-up and waits for it (or for any other interrupt, e.g. a key press).
+*/
+
+#ifndef TICKLESS_H_
+#define TICKLESS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "TimerWheel.h"
+
+// Set to 0 to keep the old busy polling behaviour (used to compare idle loop rates)
+#ifndef TICKLESS_IDLE
+#define TICKLESS_IDLE 1
+#endif
+
+// Arm a wake-up the given number of ticks ahead and wait for it or any earlier interrupt.
+// Returns the number of ticks actually spent asleep.
+typedef uint32_t (*TicklessSleep)(uint32_t ticks);
+
+typedef struct {
+    uint32_t iterations;     // Event loop iterations
+    uint32_t sleeps;         // Times the CPU was put to sleep
+    uint64_t slept_ticks;    // Ticks spent asleep
+    uint32_t first_tick;     // Tick at which counting started
+} TicklessStats;
+
+// Reset the idle statistics, starting the measurement window at the given tick
+void Tickless_initialise(uint32_t now);
+
+// Count one pass of an event loop
+void Tickless_iteration(void);
+
+// Sleep until the next timer deadline, but no longer than max_ticks. Returns the ticks slept (0 if no sleep).
+uint32_t Tickless_idle(const TimerWheel* wheel, uint32_t max_ticks, TicklessSleep sleep);
+
+// Read the idle statistics
+const TicklessStats* Tickless_stats(void);
+
+// Print event loop iterations per second and sleep statistics up to the given tick
+void Tickless_report(uint32_t now, uint32_t ticks_per_second);
+
+#endif
@@ -0,0 +1,317 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Hierarchical timer wheel used for every deadline in the game (question countdown,
+ * debounce windows, audio refill). The innermost wheel holds one slot per tick, the
+ * outer wheels hold coarser slots whose timers are cascaded inwards as time passes.
+ * Each timer cascades at most TIMER_WHEEL_LEVELS-1 times, so the cost per tick is
+ * bounded by the number of timers expiring or cascading in that tick.
+ */
+
+#include "TimerWheel.h"
+#include <stdio.h>
+
+/*
+ * Small intrusive list helpers
+ */
+static void list_init(TimerLink* head) {
+    head->next = head;
+    head->prev = head;
+}
+
+static bool list_empty(const TimerLink* head) {
+    return head->next == head;
+}
+
+static void list_append(TimerLink* head, TimerLink* node) {
+    node->prev = head->prev;
+    node->next = head;
+    head->prev->next = node;
+    head->prev = node;
+}
+
+static void list_remove(TimerLink* node) {
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->next = node;
+    node->prev = node;
+}
+
+// Move every node of src to the end of dst and leave src empty
+static void list_splice(TimerLink* dst, TimerLink* src) {
+    if (list_empty(src)) return;
+    src->next->prev = dst->prev;
+    dst->prev->next = src->next;
+    src->prev->next = dst;
+    dst->prev = src->prev;
+    list_init(src);
+}
+
+/*
+ * Function: place_timer
+ * Description: Puts an active timer in the slot matching its expiry tick, or on the ready list if due
+ * Input(s): TimerWheel* wheel, TimerNode* timer
+ * Return: void
+ */
+static void place_timer(TimerWheel* wheel, TimerNode* timer) {
+    int32_t delta = (int32_t)(timer->expires - wheel->now);
+    uint32_t expires = timer->expires;
+    TimerLink* slot;
+
+    if (delta <= 0) {
+        slot = &wheel->ready;
+    } else if (delta < TIMER_WHEEL_ROOT_SIZE) {
+        slot = &wheel->root[expires & (TIMER_WHEEL_ROOT_SIZE - 1)];
+    } else {
+        unsigned int level = 0;
+        unsigned int shift = TIMER_WHEEL_ROOT_BITS;
+        // Find the first outer wheel whose span covers the deadline
+        while (level < TIMER_WHEEL_LEVELS - 2 &&
+               (uint32_t)delta >= (1u << (shift + TIMER_WHEEL_LEVEL_BITS))) {
+            level++;
+            shift += TIMER_WHEEL_LEVEL_BITS;
+        }
+        // Deadlines beyond the outermost wheel are parked in its furthest slot and re-placed on cascade
+        if ((uint32_t)delta >= (1u << (shift + TIMER_WHEEL_LEVEL_BITS))) {
+            expires = wheel->now + (1u << (shift + TIMER_WHEEL_LEVEL_BITS)) - 1;
+        }
+        slot = &wheel->levels[level][(expires >> shift) & (TIMER_WHEEL_LEVEL_SIZE - 1)];
+    }
+    list_append(slot, &timer->link);
+}
+
+/*
+ * Function: cascade
+ * Description: Re-places all timers of one outer wheel slot relative to the current tick
+ * Input(s): TimerWheel* wheel, unsigned int level - outer wheel index, unsigned int index - slot
+ * Return: unsigned int - number of timers moved
+ */
+static unsigned int cascade(TimerWheel* wheel, unsigned int level, unsigned int index) {
+    TimerLink pending;
+    unsigned int moved = 0;
+
+    list_init(&pending);
+    list_splice(&pending, &wheel->levels[level][index]);
+    while (!list_empty(&pending)) {
+        TimerLink* link = pending.next;
+        list_remove(link);
+        place_timer(wheel, (TimerNode*)link);
+        moved++;
+    }
+    return moved;
+}
+
+/**
+ * Function: TimerWheel_initialise
+ * Description: Initialises an empty wheel
+ * Input(s): TimerWheel* wheel, uint32_t now - starting tick, cycle_counter - optional cycle counter for overhead stats
+ * Return: void
+ */
+void TimerWheel_initialise(TimerWheel* wheel, uint32_t now, uint32_t (*cycle_counter)(void)) {
+    for (unsigned int i = 0; i < TIMER_WHEEL_ROOT_SIZE; i++) {
+        list_init(&wheel->root[i]);
+    }
+    for (unsigned int level = 0; level < TIMER_WHEEL_LEVELS - 1; level++) {
+        for (unsigned int i = 0; i < TIMER_WHEEL_LEVEL_SIZE; i++) {
+            list_init(&wheel->levels[level][i]);
+        }
+    }
+    list_init(&wheel->ready);
+    wheel->now = now;
+    wheel->count = 0;
+    wheel->cycle_counter = cycle_counter;
+    wheel->stats = (TimerWheelStats){0};
+}
+
+/**
+ * Function: TimerWheel_start
+ * Description: Starts or restarts a timer
+ * Input(s): TimerWheel* wheel, TimerNode* timer, uint32_t delay - ticks until first expiry,
+ *           uint32_t period - reload ticks (0 for one-shot), TimerCallback callback, void* arg
+ * Return: void
+ */
+void TimerWheel_start(TimerWheel* wheel, TimerNode* timer, uint32_t delay, uint32_t period, TimerCallback callback, void* arg) {
+    if (timer->active) {
+        TimerWheel_cancel(wheel, timer);
+    }
+    timer->expires = wheel->now + delay;
+    timer->period = period;
+    timer->callback = callback;
+    timer->arg = arg;
+    timer->active = true;
+    wheel->count++;
+    place_timer(wheel, timer);
+}
+
+/**
+ * Function: TimerWheel_cancel
+ * Description: Stops a timer if it is running
+ * Input(s): TimerWheel* wheel, TimerNode* timer
+ * Return: void
+ */
+void TimerWheel_cancel(TimerWheel* wheel, TimerNode* timer) {
+    if (!timer->active) return;
+    list_remove(&timer->link);
+    timer->active = false;
+    wheel->count--;
+}
+
+/**
+ * Function: TimerWheel_isActive
+ * Description: Reports whether a timer is still pending
+ * Input(s): const TimerNode* timer
+ * Return: bool - true if pending
+ */
+bool TimerWheel_isActive(const TimerNode* timer) {
+    return timer->active;
+}
+
+/**
+ * Function: TimerWheel_advance
+ * Description: Processes every tick up to now, cascading outer wheels and queueing expired timers
+ * Input(s): TimerWheel* wheel, uint32_t now - current tick
+ * Return: void
+ */
+void TimerWheel_advance(TimerWheel* wheel, uint32_t now) {
+    uint32_t start = wheel->cycle_counter ? wheel->cycle_counter() : 0;
+
+    // Nothing to expire, just jump forward
+    if (wheel->count == 0) {
+        wheel->stats.ticks += now - wheel->now;
+        wheel->now = now;
+    }
+
+    while ((int32_t)(now - wheel->now) > 0) {
+        unsigned int work = 0;
+        unsigned int index;
+
+        wheel->now++;
+        index = wheel->now & (TIMER_WHEEL_ROOT_SIZE - 1);
+
+        // Cascade the outer wheels whenever the wheel inside them wraps
+        if (index == 0) {
+            unsigned int shift = TIMER_WHEEL_ROOT_BITS;
+            for (unsigned int level = 0; level < TIMER_WHEEL_LEVELS - 1; level++) {
+                unsigned int slot = (wheel->now >> shift) & (TIMER_WHEEL_LEVEL_SIZE - 1);
+                unsigned int moved = cascade(wheel, level, slot);
+                work += moved;
+                wheel->stats.cascaded += moved;
+                if (slot != 0) break;
+                shift += TIMER_WHEEL_LEVEL_BITS;
+            }
+        }
+
+        // Everything in the current root slot expires now
+        TimerLink* slot = &wheel->root[index];
+        for (TimerLink* link = slot->next; link != slot; link = link->next) {
+            work++;
+            wheel->stats.expired++;
+        }
+        list_splice(&wheel->ready, slot);
+
+        wheel->stats.ticks++;
+        if (work > wheel->stats.max_tick_work) {
+            wheel->stats.max_tick_work = work;
+        }
+    }
+
+    wheel->stats.advance_calls++;
+    if (wheel->cycle_counter) {
+        uint32_t cycles = wheel->cycle_counter() - start;
+        wheel->stats.advance_cycles += cycles;
+        if (cycles > wheel->stats.max_advance_cycles) {
+            wheel->stats.max_advance_cycles = cycles;
+        }
+    }
+}
+
+/**
+ * Function: TimerWheel_nextExpiry
+ * Description: Finds how far ahead the wheel next has work to do. Root slots give exact expiry
+ *              ticks; outer wheels give the tick at which their first occupied slot cascades,
+ *              which is never later than the expiry of the timers in it.
+ * Input(s): const TimerWheel* wheel, uint32_t* ticks - set to the ticks until that point
+ * Return: bool - false if no timer is active
+ */
+bool TimerWheel_nextExpiry(const TimerWheel* wheel, uint32_t* ticks) {
+    uint32_t best = UINT32_MAX;
+    unsigned int shift = TIMER_WHEEL_ROOT_BITS;
+
+    if (wheel->count == 0) return false;
+    if (!list_empty(&wheel->ready)) {
+        *ticks = 0;
+        return true;
+    }
+
+    for (uint32_t k = 1; k < TIMER_WHEEL_ROOT_SIZE; k++) {
+        if (!list_empty(&wheel->root[(wheel->now + k) & (TIMER_WHEEL_ROOT_SIZE - 1)])) {
+            best = k;
+            break;
+        }
+    }
+
+    for (unsigned int level = 0; level < TIMER_WHEEL_LEVELS - 1; level++) {
+        uint32_t position = wheel->now >> shift;
+        for (uint32_t k = 1; k <= TIMER_WHEEL_LEVEL_SIZE; k++) {
+            if (!list_empty(&wheel->levels[level][(position + k) & (TIMER_WHEEL_LEVEL_SIZE - 1)])) {
+                uint32_t wake = ((position + k) << shift) - wheel->now;
+                if (wake < best) best = wake;
+                break;
+            }
+        }
+        shift += TIMER_WHEEL_LEVEL_BITS;
+    }
+
+    *ticks = best;
+    return true;
+}
+
+/**
+ * Function: TimerWheel_dispatch
+ * Description: Runs the callbacks of expired timers and re-arms periodic ones
+ * Input(s): TimerWheel* wheel
+ * Return: uint32_t - number of callbacks run
+ */
+uint32_t TimerWheel_dispatch(TimerWheel* wheel) {
+    uint32_t run = 0;
+
+    while (!list_empty(&wheel->ready)) {
+        TimerNode* timer = (TimerNode*)wheel->ready.next;
+        list_remove(&timer->link);
+
+        if (timer->period) {
+            // Re-arm from the previous deadline so periodic timers do not drift
+            timer->expires += timer->period;
+            place_timer(wheel, timer);
+        } else {
+            timer->active = false;
+            wheel->count--;
+        }
+
+        // The callback may cancel or restart its own timer
+        timer->callback(timer->arg);
+        run++;
+    }
+    wheel->stats.dispatched += run;
+    return run;
+}
+
+/**
+ * Function: TimerWheel_report
+ * Description: Prints tick processing statistics
+ * Input(s): const TimerWheel* wheel
+ * Return: void
+ */
+void TimerWheel_report(const TimerWheel* wheel) {
+    const TimerWheelStats* stats = &wheel->stats;
+    printf("Timer wheel: %u active, %lu ticks, %lu expired, %lu cascaded, %lu dispatched\n",
+           (unsigned int)wheel->count, (unsigned long)stats->ticks, (unsigned long)stats->expired,
+           (unsigned long)stats->cascaded, (unsigned long)stats->dispatched);
+    printf("Timer wheel: max %lu timers per tick", (unsigned long)stats->max_tick_work);
+    if (stats->advance_calls && wheel->cycle_counter) {
+        printf(", avg %lu cycles per advance, max %lu cycles",
+               (unsigned long)(stats->advance_cycles / stats->advance_calls),
+               (unsigned long)stats->max_advance_cycles);
+    }
+    printf("\n");
+}
@@ -0,0 +1,93 @@
+/*
+* TimerWheel.h
+*
+* Hierarchical software timer wheel
+*
+* Keeps any number of one-shot or periodic software timers on top of a single
+* hardware tick. Timers are intrusive (the caller owns the TimerNode storage),
+* so adding, cancelling and expiring a timer is O(1) and never allocates.
+* Expired timers are queued by TimerWheel_advance and their callbacks are run
+* from the event loop by TimerWheel_dispatch.
+*/
+
+#ifndef TIMERWHEEL_H_
+#define TIMERWHEEL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Wheel geometry: one 256 slot wheel of single ticks followed by three 64 slot wheels.
+// With a 1ms tick this covers deadlines up to 2^26 ms (~18 hours) ahead.
+#define TIMER_WHEEL_LEVELS     4
+#define TIMER_WHEEL_ROOT_BITS  8
+#define TIMER_WHEEL_LEVEL_BITS 6
+#define TIMER_WHEEL_ROOT_SIZE  (1 << TIMER_WHEEL_ROOT_BITS)
+#define TIMER_WHEEL_LEVEL_SIZE (1 << TIMER_WHEEL_LEVEL_BITS)
+
+// Callback run from TimerWheel_dispatch when a timer expires
+typedef void (*TimerCallback)(void* arg);
+
+// Doubly linked list node, embedded in every timer and used for the wheel slots
+typedef struct TimerLink {
+    struct TimerLink* next;
+    struct TimerLink* prev;
+} TimerLink;
+
+// A single software timer. Storage is owned by the caller and must stay valid while active.
+typedef struct {
+    TimerLink link;          // Must be first: slot lists are walked as TimerLinks
+    uint32_t expires;        // Absolute expiry tick
+    uint32_t period;         // Reload period in ticks, 0 for a one-shot timer
+    TimerCallback callback;  // Function to run on expiry
+    void* arg;               // Argument handed to the callback
+    bool active;             // True while the timer sits in a slot or on the ready list
+} TimerNode;
+
+// Processing statistics, used to report how much the tick path costs
+typedef struct {
+    uint32_t ticks;          // Ticks processed
+    uint32_t expired;        // Timers moved to the ready list
+    uint32_t cascaded;       // Timers moved down from an outer wheel
+    uint32_t dispatched;     // Callbacks run
+    uint32_t max_tick_work;  // Most timers touched by a single tick
+    uint32_t advance_calls;  // Calls to TimerWheel_advance
+    uint64_t advance_cycles; // Total cycles spent in TimerWheel_advance (0 if no counter)
+    uint32_t max_advance_cycles; // Slowest TimerWheel_advance call
+} TimerWheelStats;
+
+typedef struct {
+    uint32_t now;            // Current tick
+    uint32_t count;          // Timers currently active
+    TimerLink root[TIMER_WHEEL_ROOT_SIZE];
+    TimerLink levels[TIMER_WHEEL_LEVELS - 1][TIMER_WHEEL_LEVEL_SIZE];
+    TimerLink ready;         // Expired timers waiting for dispatch
+    uint32_t (*cycle_counter)(void); // Optional free running up-counter used for overhead stats
+    TimerWheelStats stats;
+} TimerWheel;
+
+// Initialise an empty wheel starting at the given tick. cycle_counter may be NULL.
+void TimerWheel_initialise(TimerWheel* wheel, uint32_t now, uint32_t (*cycle_counter)(void));
+
+// Start (or restart) a timer that fires delay ticks from now and then every period ticks (0 = once)
+void TimerWheel_start(TimerWheel* wheel, TimerNode* timer, uint32_t delay, uint32_t period, TimerCallback callback, void* arg);
+
+// Stop a timer. Safe to call on a timer that is not running.
+void TimerWheel_cancel(TimerWheel* wheel, TimerNode* timer);
+
+// Returns true if the timer is waiting to expire or to be dispatched
+bool TimerWheel_isActive(const TimerNode* timer);
+
+// Move the wheel forward to the given tick, queueing every timer that expires on the way
+void TimerWheel_advance(TimerWheel* wheel, uint32_t now);
+
+// Ticks until the wheel next needs attention (an expiry or an outer wheel cascade).
+// Returns false if no timer is active.
+bool TimerWheel_nextExpiry(const TimerWheel* wheel, uint32_t* ticks);
+
+// Run the callbacks of all expired timers. Returns the number of callbacks run.
+uint32_t TimerWheel_dispatch(TimerWheel* wheel);
+
+// Print the tick processing statistics
+void TimerWheel_report(const TimerWheel* wheel);
+
+#endif
@@ -0,0 +1,203 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Per-core event rings and their Chrome trace JSON export. A core only ever writes its
+ * own ring, so recording needs no atomic read-modify-write; the exporter copies each
+ * event out and drops it if the writer may have lapped it meanwhile.
+ */
+
+#include "Trace.h"
+#include "SpscRing.h"
+#include "FatFS/ff.h"
+#include <stdarg.h>
+#include <stdio.h>
+
+#define TRACE_COUNTS_PER_US (HAL_GLOBAL_HZ / 1000000u)
+#define JSON_BUFFER_SIZE 512
+#define JSON_LINE_MAX 192   // Longest single event line
+
+typedef char trace_ring_size_must_be_power_of_two[(TRACE_RING_SIZE & (TRACE_RING_SIZE - 1)) == 0 ? 1 : -1];
+
+typedef struct {
+    SPSC_ALIGNED uint32_t head;      // Events recorded, the next slot is head % TRACE_RING_SIZE
+    TraceEvent events[TRACE_RING_SIZE];
+} TraceRing;
+
+static TraceRing trace_rings[TRACE_CORES];
+
+// JSON output, written to the file a buffer at a time
+static FIL json_file;
+static char json_buffer[JSON_BUFFER_SIZE];
+static UINT json_used;
+static bool json_ok;
+
+/*
+ * Function: record
+ * Description: Fills the next slot of the calling core's ring and publishes it
+ */
+static void record(uint8_t type, const char* name, uint64_t start, uint32_t duration, uint32_t value) {
+    TraceRing* ring = &trace_rings[Hal_coreId() & (TRACE_CORES - 1)];
+    uint32_t head = ring->head;
+    TraceEvent* event = &ring->events[head & (TRACE_RING_SIZE - 1)];
+
+    event->start = start;
+    event->duration = duration;
+    event->value = value;
+    event->name = name;
+    event->type = type;
+    SPSC_STORE_RELEASE(&ring->head, head + 1);
+}
+
+/**
+ * Function: Trace_complete
+ * Description: Records a span from start until now
+ * Input(s): const char* name, uint64_t start - Hal_globalCounts at the start, uint32_t value
+ * Return: void
+ */
+void Trace_complete(const char* name, uint64_t start, uint32_t value) {
+    uint64_t duration = Hal_globalCounts() - start;
+    record(TRACE_COMPLETE, name, start, (duration > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t)duration, value);
+}
+
+/**
+ * Function: Trace_instant
+ * Description: Records an instant event, e.g. a key change
+ * Input(s): const char* name, uint32_t value
+ * Return: void
+ */
+void Trace_instant(const char* name, uint32_t value) {
+    record(TRACE_INSTANT_EVENT, name, Hal_globalCounts(), 0, value);
+}
+
+/**
+ * Function: Trace_counter
+ * Description: Records a new value of a counter track, e.g. the game state
+ * Input(s): const char* name, uint32_t value
+ * Return: void
+ */
+void Trace_counter(const char* name, uint32_t value) {
+    record(TRACE_COUNTER_EVENT, name, Hal_globalCounts(), 0, value);
+}
+
+/**
+ * Function: Trace_end
+ * Description: Closes a TRACE_SCOPE, recording it as a span
+ * Input(s): TraceScope* scope
+ * Return: void
+ */
+void Trace_end(TraceScope* scope) {
+    Trace_complete(scope->name, scope->start, 0);
+}
+
+/**
+ * Function: Trace_recorded
+ * Description: Returns how many events a core has recorded since boot
+ * Input(s): unsigned int core
+ * Return: uint32_t - events, the ring keeps the last TRACE_RING_SIZE of them
+ */
+uint32_t Trace_recorded(unsigned int core) {
+    return (core < TRACE_CORES) ? SPSC_LOAD_ACQUIRE(&trace_rings[core].head) : 0;
+}
+
+/*
+ * Function: json_printf
+ * Description: Formats into the output buffer, writing it to the file when it fills up
+ */
+static void json_printf(const char* format, ...) {
+    va_list args;
+    int length;
+
+    if (json_used > JSON_BUFFER_SIZE - JSON_LINE_MAX) {
+        UINT written = 0;
+        json_ok = json_ok && f_write(&json_file, json_buffer, json_used, &written) == FR_OK && written == json_used;
+        json_used = 0;
+    }
+    va_start(args, format);
+    length = vsnprintf(json_buffer + json_used, JSON_BUFFER_SIZE - json_used, format, args);
+    va_end(args);
+    if (length > 0) {
+        json_used += ((UINT)length < JSON_BUFFER_SIZE - json_used) ? (UINT)length : JSON_BUFFER_SIZE - json_used - 1;
+    }
+}
+
+/*
+ * Function: json_time
+ * Description: Formats counts as microseconds with three decimals, as Chrome expects
+ */
+static const char* json_time(char* text, uint64_t counts) {
+    snprintf(text, 24, "%lu.%03lu", (unsigned long)(counts / TRACE_COUNTS_PER_US),
+             (unsigned long)((counts % TRACE_COUNTS_PER_US) * 1000u / TRACE_COUNTS_PER_US));
+    return text;
+}
+
+/**
+ * Function: Trace_exportJson
+ * Description: Writes the events still held in both rings as Chrome trace JSON, one thread per
+ *              core. Timestamps start from the oldest event written.
+ * Input(s): const char* path
+ * Return: bool - true if the whole file was written
+ */
+bool Trace_exportJson(const char* path) {
+    static const char* const core_names[TRACE_CORES] = { "game (core 0)", "worker (core 1)" };
+    uint32_t first[TRACE_CORES], last[TRACE_CORES];
+    uint64_t base = UINT64_MAX;
+    unsigned long written_events = 0, lapped = 0;
+    bool comma = false;
+    char start_text[24], duration_text[24];
+
+    if (f_open(&json_file, path, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) return false;
+    json_used = 0;
+    json_ok = true;
+
+    for (unsigned int core = 0; core < TRACE_CORES; core++) {
+        last[core] = SPSC_LOAD_ACQUIRE(&trace_rings[core].head);
+        first[core] = (last[core] > TRACE_RING_SIZE) ? last[core] - TRACE_RING_SIZE : 0;
+        if (last[core] > first[core]) {
+            uint64_t start = trace_rings[core].events[first[core] & (TRACE_RING_SIZE - 1)].start;
+            if (start < base) base = start;
+        }
+    }
+    if (base == UINT64_MAX) base = 0;
+
+    json_printf("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (unsigned int core = 0; core < TRACE_CORES; core++) {
+        json_printf("%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                    comma ? ",\n" : "", core, core_names[core]);
+        comma = true;
+
+        for (uint32_t index = first[core]; index != last[core]; index++) {
+            TraceEvent event = trace_rings[core].events[index & (TRACE_RING_SIZE - 1)];
+            // The writer may have come round to this slot while it was copied. The fence keeps the
+            // copy ahead of the head re-read, and head - index == TRACE_RING_SIZE already means the
+            // slot was being rewritten
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (SPSC_LOAD_ACQUIRE(&trace_rings[core].head) - index >= TRACE_RING_SIZE) {
+                lapped++;
+                continue;
+            }
+            if (!event.name) continue;
+
+            json_time(start_text, (event.start > base) ? event.start - base : 0);
+            if (event.type == TRACE_COMPLETE) {
+                json_printf(",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%s,\"dur\":%s,\"args\":{\"value\":%lu}}",
+                            event.name, core, start_text, json_time(duration_text, event.duration),
+                            (unsigned long)event.value);
+            } else {
+                json_printf(",\n{\"name\":\"%s\",\"ph\":\"%s\",\"pid\":1,\"tid\":%u,\"ts\":%s,\"args\":{\"value\":%lu}}",
+                            event.name, (event.type == TRACE_COUNTER_EVENT) ? "C" : "i\",\"s\":\"t", core,
+                            start_text, (unsigned long)event.value);
+            }
+            written_events++;
+        }
+    }
+    json_printf("\n]}\n");
+
+    if (json_used > 0) {
+        UINT written = 0;
+        json_ok = json_ok && f_write(&json_file, json_buffer, json_used, &written) == FR_OK && written == json_used;
+    }
+    json_ok = (f_close(&json_file) == FR_OK) && json_ok;
+    printf("Trace: %lu events written to %s%s, %lu overwritten while exporting\n", written_events, path,
+           json_ok ? "" : " (write failed)", lapped);
+    return json_ok;
+}
@@ -0,0 +1,85 @@
+/*
+* Trace.h
+*
+* Event trace with Chrome trace export
+*
+* A flight recorder for spans (TRACE_SCOPE for a block, or TRACE_TIME and TRACE_SPAN when
+* the span does not follow a block), instants such as key changes (TRACE_INSTANT) and
+* counters such as the game state (TRACE_COUNTER). Each core writes its own fixed-size
+* ring with plain stores and a release store of its head, so recording takes no lock and
+* costs a clock read and a few stores; when a ring is full the oldest events are
+* overwritten. It is cheap enough to leave on in release builds.
+*
+* Trace_exportJson writes the rings as Chrome trace JSON (chrome://tracing, Perfetto) to
+* a file on the SD card, or in the host build to the disk image, so a slow question
+* transition can be opened on a timeline with both cores side by side. Timestamps come
+* from Hal_globalCounts, which both cores share.
+*
+* Names must be string literals or other strings that live for the whole run.
+*/
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "Hal.h"
+
+// Set to 0 to compile the trace points out
+#ifndef GAME_TRACE
+#define GAME_TRACE 1
+#endif
+
+#define TRACE_RING_SIZE 1024   // Events kept per core, must be a power of two
+#define TRACE_CORES 2
+
+typedef enum { TRACE_COMPLETE, TRACE_INSTANT_EVENT, TRACE_COUNTER_EVENT } TraceType;
+
+typedef struct {
+    uint64_t start;            // Hal_globalCounts
+    uint32_t duration;         // Counts, spans only
+    uint32_t value;            // Argument shown with the event
+    const char* name;
+    uint8_t type;              // TraceType
+} TraceEvent;
+
+typedef struct {
+    const char* name;
+    uint64_t start;
+} TraceScope;
+
+// Record a span that started at start and ends now
+void Trace_complete(const char* name, uint64_t start, uint32_t value);
+
+// Record an instant event, or a new value of a counter track
+void Trace_instant(const char* name, uint32_t value);
+void Trace_counter(const char* name, uint32_t value);
+
+// Cleanup handler of TRACE_SCOPE
+void Trace_end(TraceScope* scope);
+
+// Events recorded since boot on a core, including those already overwritten
+uint32_t Trace_recorded(unsigned int core);
+
+// Write both rings to path as Chrome trace JSON. Returns false if the file could not be written.
+bool Trace_exportJson(const char* path);
+
+#if GAME_TRACE
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(span_name) \
+    TraceScope TRACE_CONCAT(trace_scope_, __LINE__) __attribute__((cleanup(Trace_end))) = \
+        { span_name, Hal_globalCounts() }
+#define TRACE_INSTANT(name, value) Trace_instant(name, value)
+#define TRACE_COUNTER(name, value) Trace_counter(name, value)
+#define TRACE_TIME() Hal_globalCounts()
+#define TRACE_SPAN(name, start, value) Trace_complete(name, start, value)
+#else
+#define TRACE_SCOPE(span_name) do { } while (0)
+#define TRACE_INSTANT(name, value) do { } while (0)
+#define TRACE_COUNTER(name, value) do { } while (0)
+#define TRACE_TIME() 0
+#define TRACE_SPAN(name, start, value) do { (void)(start); (void)(value); } while (0)
+#endif
+
+#endif
@@ -0,0 +1,466 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Render/audio worker. Core 0 pushes commands into two single-producer/single-consumer
+ * queues (render and audio); the worker pops them and executes them in small slices,
+ * topping up the audio FIFO between every chunk of LCD pixels.
+ *
+ * Board: core 1 is held in reset by the reset manager. Worker_start points the CPU1 boot
+ * address at a small entry stub, joins both cores to the SCU coherency domain and releases
+ * core 1, which mirrors core 0's MMU/cache setup before entering the worker loop.
+ * Host: the worker loop runs on a pthread.
+ */
+
+#include "Worker.h"
+#include "Supervisor.h"
+#include "SpscRing.h"
+#include "Font.h"
+#include "PixelLz.h"
+#include "Trace.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+typedef enum { RENDER_FILL, RENDER_BLIT, RENDER_BLIT_ANSWER, RENDER_GLYPH, RENDER_LZ, RENDER_LZ_ANSWER } RenderOp;
+
+typedef struct {
+    uint8_t op;                  // RenderOp
+    uint8_t correct;             // Colour choice for the answer ops, scale for RENDER_GLYPH
+    unsigned short colour;       // Colour for RENDER_FILL and RENDER_GLYPH
+    unsigned short background;   // Background for RENDER_GLYPH
+    char glyph;                  // Character for RENDER_GLYPH
+    const unsigned short* pixels;
+    uint16_t x, y, width, height;
+    uint32_t size;               // Compressed bytes for the RENDER_LZ ops
+} RenderCommand;
+
+typedef struct {
+    const int16_t* samples;
+    unsigned int count;
+    int volume;
+} AudioCommand;
+
+// Core 0 is the only producer and the worker the only consumer of each queue
+SPSC_RING_DECLARE(RenderQueue, RenderCommand, WORKER_RENDER_QUEUE_SIZE)
+SPSC_RING_DECLARE(AudioQueue, AudioCommand, WORKER_AUDIO_QUEUE_SIZE)
+
+static RenderQueue render_queue;
+static AudioQueue audio_queue;
+static WorkerSinks worker_sinks;
+static WorkerStats worker_stats;
+static volatile bool worker_started;
+
+// Decoder state for the RENDER_LZ ops, one chunk of pixels decoded at a time
+static PixelLzStream lz_stream;
+static unsigned short lz_pixels[WORKER_RENDER_CHUNK];
+
+// Completion counters, used by the flushes and the busy checks
+static uint32_t render_submitted;
+static uint32_t audio_submitted;
+static uint32_t render_completed;
+static uint32_t audio_completed;
+
+/*
+ * Function: submit_render
+ * Description: Queues a render command, waiting for space if the worker is behind
+ * Input(s): const RenderCommand* command
+ * Return: void
+ */
+static void submit_render(const RenderCommand* command) {
+    if (!RenderQueue_push(&render_queue, command)) {
+        worker_stats.queue_full++;
+        while (!RenderQueue_push(&render_queue, command)) {
+#if defined(__linux__)
+            sched_yield(); // The worker thread may share this CPU
+#endif
+        }
+    }
+    render_submitted++;
+}
+
+/*
+ * Function: worker_loop
+ * Description: Worker main loop, never returns
+ * Input(s): None
+ * Return: void
+ */
+static void worker_loop(void) {
+    RenderCommand render = {0};
+    AudioCommand sound;
+    bool rendering = false;
+    bool playing = false;
+    unsigned int render_position = 0;
+    unsigned int render_total = 0;
+    unsigned int sound_position = 0;
+    uint64_t render_start = 0;
+    uint64_t sound_start = 0;
+    uint32_t sound_refills = 0;
+#if defined(__linux__)
+    bool fifo_full = false;      // The host yields while the virtual codec drains
+#endif
+
+    worker_started = true;
+    while (1) {
+        worker_stats.loops++;
+        Supervisor_checkIn(SUPERVISOR_WORKER);
+
+        // Keep the audio FIFO topped up first, it cannot tolerate gaps
+        if (!playing && AudioQueue_pop(&audio_queue, &sound)) {
+            playing = true;
+            sound_position = 0;
+            sound_start = TRACE_TIME();
+            sound_refills = 0;
+        }
+        if (playing) {
+            unsigned int space = worker_sinks.audio_space(worker_sinks.audio);
+#if defined(__linux__)
+            fifo_full = (space == 0);
+#endif
+            if (space > 0) sound_refills++;
+            while (space-- && sound_position < sound.count) {
+                signed int sample = sound.samples[sound_position++] * sound.volume;
+                worker_sinks.audio_write(worker_sinks.audio, sample);
+                worker_stats.samples++;
+            }
+            if (sound_position >= sound.count) {
+                playing = false;
+                worker_stats.commands++;
+                TRACE_SPAN("audio", sound_start, sound_refills);
+                SPSC_STORE_RELEASE(&audio_completed, audio_completed + 1);
+            }
+        }
+
+        // Then draw one chunk of the current render command
+        if (!rendering && RenderQueue_pop(&render_queue, &render)) {
+            rendering = true;
+            render_position = 0;
+            render_start = TRACE_TIME();
+            render_total = (unsigned int)render.width * render.height;
+            worker_sinks.lcd_window(worker_sinks.lcd, render.x, render.y, render.width, render.height);
+            if (render.op == RENDER_LZ || render.op == RENDER_LZ_ANSWER) {
+                PixelLz_begin(&lz_stream, render.pixels, render.size, render_total);
+            }
+        }
+        if (rendering) {
+            unsigned int end = render_position + WORKER_RENDER_CHUNK;
+            if (end > render_total) end = render_total;
+            worker_stats.pixels += end - render_position;
+
+            if (render.op == RENDER_LZ || render.op == RENDER_LZ_ANSWER) {
+                // A corrupt stream still yields every pixel, so the window is always filled
+                unsigned int count = PixelLz_read(&lz_stream, lz_pixels, end - render_position);
+                for (unsigned int i = 0; i < count; i++) {
+                    unsigned short colour = lz_pixels[i];
+                    if (render.op == RENDER_LZ_ANSWER && colour == 0x0000) {
+                        colour = render.correct ? 0x4E4E : 0xEA64;
+                    }
+                    worker_sinks.lcd_write(worker_sinks.lcd, colour);
+                }
+                render_position = end;
+            }
+            for (; render_position < end; render_position++) {
+                unsigned short colour;
+                if (render.op == RENDER_FILL) {
+                    colour = render.colour;
+                } else if (render.op == RENDER_GLYPH) {
+                    colour = Font_pixel(render.glyph, render_position, render.correct, render.colour, render.background);
+                } else {
+                    colour = render.pixels[render_position];
+                    // Replace black pixels with green for correct answers, or red for incorrect
+                    if (render.op == RENDER_BLIT_ANSWER && colour == 0x0000) {
+                        colour = render.correct ? 0x4E4E : 0xEA64;
+                    }
+                }
+                worker_sinks.lcd_write(worker_sinks.lcd, colour);
+            }
+
+            if (render_position >= render_total) {
+                rendering = false;
+                worker_stats.commands++;
+                TRACE_SPAN("render", render_start, render_total);
+                SPSC_STORE_RELEASE(&render_completed, render_completed + 1);
+            }
+        }
+
+#if defined(__linux__)
+        if ((!playing || fifo_full) && !rendering) sched_yield();
+#endif
+    }
+}
+
+#if defined(__linux__)
+
+/*
+ * Function: worker_thread
+ * Description: pthread entry for the host build
+ */
+static void* worker_thread(void* arg) {
+    (void)arg;
+    worker_loop();
+    return 0;
+}
+
+/*
+ * Function: worker_launch
+ * Description: Starts the worker loop on a detached thread
+ * Return: bool - true if the thread was created
+ */
+static bool worker_launch(void) {
+    pthread_t thread;
+    if (pthread_create(&thread, 0, worker_thread, 0) != 0) return false;
+    pthread_detach(thread);
+    return true;
+}
+
+#else
+
+// Cortex-A9 MPCore and Cyclone V HPS registers used to bring up core 1
+#define SCU_CONTROL          ((volatile unsigned int *)0xFFFEC000)
+#define RSTMGR_MPUMODRST     ((volatile unsigned int *)0xFFD05010)
+#define SYSMGR_CPU1STARTADDR ((volatile unsigned int *)0xFFD080C4)
+#define RSTMGR_CPU1          (1 << 1)
+#define ACTLR_SMP_FW         0x41  // Join coherency, broadcast cache/TLB maintenance
+
+#define WORKER_STACK_SIZE 8192
+#define WORKER_STRINGIFY(x) #x
+#define WORKER_STR(x) WORKER_STRINGIFY(x)
+
+// Core 1 stack and the core 0 MMU configuration it copies (referenced from the entry stub)
+unsigned char worker_core1_stack[WORKER_STACK_SIZE] __attribute__((aligned(8)));
+volatile unsigned int worker_core0_ttbr0;
+volatile unsigned int worker_core0_dacr;
+volatile unsigned int worker_core0_sctlr;
+
+void worker_core1_main(void);
+
+/*
+ * Function: worker_core1_entry
+ * Description: First code run by core 1 after reset: set the stack, join SMP coherency, enter C
+ */
+__attribute__((naked, noreturn)) static void worker_core1_entry(void) {
+    __asm__ volatile (
+        "ldr r0, =worker_core1_stack\n\t"
+        "add sp, r0, #" WORKER_STR(WORKER_STACK_SIZE) "\n\t"
+        "mrc p15, 0, r0, c1, c0, 1\n\t"
+        "orr r0, r0, #" WORKER_STR(ACTLR_SMP_FW) "\n\t"
+        "mcr p15, 0, r0, c1, c0, 1\n\t"
+        "b worker_core1_main\n\t"
+    );
+}
+
+/*
+ * Function: worker_core1_main
+ * Description: Mirrors core 0's translation table and cache settings on core 1, then runs the worker
+ */
+void worker_core1_main(void) {
+    unsigned int sctlr = worker_core0_sctlr;
+
+    if (sctlr & 0x1) {
+        // Invalidate this core's L1 data cache (4 ways x 256 sets), I-cache and TLB before enabling them
+        for (unsigned int set = 0; set < 256; set++) {
+            for (unsigned int way = 0; way < 4; way++) {
+                unsigned int setway = (way << 30) | (set << 5);
+                __asm__ volatile ("mcr p15, 0, %0, c7, c6, 2" :: "r" (setway));
+            }
+        }
+        __asm__ volatile ("mcr p15, 0, %0, c7, c5, 0" :: "r" (0));
+        __asm__ volatile ("mcr p15, 0, %0, c8, c7, 0" :: "r" (0));
+        __asm__ volatile ("mcr p15, 0, %0, c2, c0, 0" :: "r" (worker_core0_ttbr0));
+        __asm__ volatile ("mcr p15, 0, %0, c3, c0, 0" :: "r" (worker_core0_dacr));
+        __asm__ volatile ("dsb\n\tisb" ::: "memory");
+        __asm__ volatile ("mcr p15, 0, %0, c1, c0, 0" :: "r" (sctlr));
+        __asm__ volatile ("isb" ::: "memory");
+    }
+    worker_loop();
+}
+
+/*
+ * Function: worker_launch
+ * Description: Releases core 1 from reset into worker_core1_entry
+ * Return: bool - true once core 1 has been released
+ */
+static bool worker_launch(void) {
+    unsigned int actlr;
+
+    // Core 0 joins the coherency domain and the SCU is switched on
+    __asm__ volatile ("mrc p15, 0, %0, c1, c0, 1" : "=r" (actlr));
+    __asm__ volatile ("mcr p15, 0, %0, c1, c0, 1" :: "r" (actlr | ACTLR_SMP_FW));
+    *SCU_CONTROL |= 0x1;
+
+    // Record core 0's MMU setup for core 1 to copy
+    __asm__ volatile ("mrc p15, 0, %0, c2, c0, 0" : "=r" (worker_core0_ttbr0));
+    __asm__ volatile ("mrc p15, 0, %0, c3, c0, 0" : "=r" (worker_core0_dacr));
+    __asm__ volatile ("mrc p15, 0, %0, c1, c0, 0" : "=r" (worker_core0_sctlr));
+
+    *SYSMGR_CPU1STARTADDR = (unsigned int)worker_core1_entry;
+    __asm__ volatile ("dsb" ::: "memory");
+    *RSTMGR_MPUMODRST &= ~RSTMGR_CPU1;
+    return true;
+}
+
+#endif
+
+/**
+ * Function: Worker_start
+ * Description: Starts the worker and waits until it is accepting commands
+ * Input(s): const WorkerSinks* sinks - LCD and audio outputs
+ * Return: bool - false if the worker could not be started
+ */
+bool Worker_start(const WorkerSinks* sinks) {
+    if (worker_started) return true;
+
+    worker_sinks = *sinks;
+    RenderQueue_init(&render_queue);
+    AudioQueue_init(&audio_queue);
+    render_submitted = render_completed = 0;
+    audio_submitted = audio_completed = 0;
+    worker_stats = (WorkerStats){0};
+
+    if (!worker_launch()) return false;
+    while (!worker_started) { }
+    return true;
+}
+
+/**
+ * Function: Worker_running
+ * Description: Reports whether commands are handled by the worker
+ * Input(s): None
+ * Return: bool - true if the worker is running
+ */
+bool Worker_running(void) {
+    return worker_started;
+}
+
+/**
+ * Function: Worker_fill
+ * Description: Queues a solid colour rectangle
+ * Input(s): unsigned short colour, unsigned int x, y, width, height
+ * Return: void
+ */
+void Worker_fill(unsigned short colour, unsigned int x, unsigned int y, unsigned int width, unsigned int height) {
+    RenderCommand command = { .op = RENDER_FILL, .colour = colour, .x = x, .y = y, .width = width, .height = height };
+    submit_render(&command);
+}
+
+/**
+ * Function: Worker_blit
+ * Description: Queues an image copy
+ * Input(s): const unsigned short* pixels, unsigned int x, y, width, height
+ * Return: void
+ */
+void Worker_blit(const unsigned short* pixels, unsigned int x, unsigned int y, unsigned int width, unsigned int height) {
+    RenderCommand command = { .op = RENDER_BLIT, .pixels = pixels, .x = x, .y = y, .width = width, .height = height };
+    submit_render(&command);
+}
+
+/**
+ * Function: Worker_blitAnswer
+ * Description: Queues an answer digit copy with black pixels recoloured
+ * Input(s): int correct - 1 for green, 0 for red, const unsigned short* pixels, unsigned int x, y, width, height
+ * Return: void
+ */
+void Worker_blitAnswer(int correct, const unsigned short* pixels, unsigned int x, unsigned int y, unsigned int width, unsigned int height) {
+    RenderCommand command = { .op = RENDER_BLIT_ANSWER, .correct = correct != 0, .pixels = pixels,
+                              .x = x, .y = y, .width = width, .height = height };
+    submit_render(&command);
+}
+
+/**
+ * Function: Worker_blitCompressed
+ * Description: Queues a PixelLz image, decoded a chunk at a time as it is drawn
+ * Input(s): int correct - 1 for green, 0 for red, -1 to draw as is, const void* data, uint32_t size - compressed bytes,
+ *           unsigned int x, y, width, height
+ * Return: void
+ */
+void Worker_blitCompressed(int correct, const void* data, uint32_t size, unsigned int x, unsigned int y, unsigned int width, unsigned int height) {
+    RenderCommand command = { .op = correct < 0 ? RENDER_LZ : RENDER_LZ_ANSWER, .correct = correct > 0, .pixels = data,
+                              .x = x, .y = y, .width = width, .height = height, .size = size };
+    submit_render(&command);
+}
+
+/**
+ * Function: Worker_glyph
+ * Description: Queues one scaled font glyph cell
+ * Input(s): char c, unsigned int scale, unsigned short colour, unsigned short background, unsigned int x, y
+ * Return: void
+ */
+void Worker_glyph(char c, unsigned int scale, unsigned short colour, unsigned short background, unsigned int x, unsigned int y) {
+    RenderCommand command = { .op = RENDER_GLYPH, .correct = scale, .colour = colour, .background = background,
+                              .glyph = c, .x = x, .y = y,
+                              .width = FONT_CELL_WIDTH * scale, .height = FONT_CELL_HEIGHT * scale };
+    submit_render(&command);
+}
+
+/**
+ * Function: Worker_playSound
+ * Description: Queues a sound for playback
+ * Input(s): const int16_t* samples, unsigned int count - number of samples, int volume - sample multiplier
+ * Return: void
+ */
+void Worker_playSound(const int16_t* samples, unsigned int count, int volume) {
+    AudioCommand command = { samples, count, volume };
+    if (!AudioQueue_push(&audio_queue, &command)) {
+        worker_stats.queue_full++;
+        while (!AudioQueue_push(&audio_queue, &command)) {
+#if defined(__linux__)
+            sched_yield();
+#endif
+        }
+    }
+    audio_submitted++;
+}
+
+/**
+ * Function: Worker_soundBusy
+ * Description: Reports whether any sound is still queued or playing
+ * Input(s): None
+ * Return: bool - true while sounds are pending
+ */
+bool Worker_soundBusy(void) {
+    return SPSC_LOAD_ACQUIRE(&audio_completed) != audio_submitted;
+}
+
+/**
+ * Function: Worker_flushRender
+ * Description: Waits for all submitted render commands to complete, without waiting for sounds
+ * Input(s): void (*poll)(void) - called on every pass of the wait, may be NULL
+ * Return: void
+ */
+void Worker_flushRender(void (*poll)(void)) {
+    TRACE_SCOPE("Worker_flushRender");
+    while (SPSC_LOAD_ACQUIRE(&render_completed) != render_submitted) {
+        if (poll) poll();
+#if defined(__linux__)
+        sched_yield(); // The worker thread may share this CPU
+#endif
+    }
+}
+
+/**
+ * Function: Worker_flush
+ * Description: Waits for all submitted render and audio commands to complete
+ * Input(s): void (*poll)(void) - called on every pass of the wait, may be NULL
+ * Return: void
+ */
+void Worker_flush(void (*poll)(void)) {
+    TRACE_SCOPE("Worker_flush");
+    while (SPSC_LOAD_ACQUIRE(&render_completed) != render_submitted ||
+           SPSC_LOAD_ACQUIRE(&audio_completed) != audio_submitted) {
+        if (poll) poll();
+#if defined(__linux__)
+        sched_yield();
+#endif
+    }
+}
+
+/**
+ * Function: Worker_stats
+ * Description: Returns the worker statistics
+ * Input(s): None
+ * Return: const WorkerStats* - statistics
+ */
+const WorkerStats* Worker_stats(void) {
+    return &worker_stats;
+}
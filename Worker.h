@@ -0,0 +1,84 @@
+/*
+* Worker.h
+*
+* Render/audio worker
+*
+* Runs LCD drawing and audio FIFO feeding on the second Cortex-A9 core so they no longer
+* serialise with game logic and input on core 0. Core 0 submits commands through
+* single-producer/single-consumer queues; the worker interleaves chunks of LCD drawing
+* with audio FIFO refills so long blits never starve the codec.
+*
+* On the board the worker is started on core 1. In a Linux host build the same worker
+* loop runs on a pthread, with the LCD and audio replaced by whatever sinks are supplied.
+*/
+
+#ifndef WORKER_H_
+#define WORKER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Queue depths, must be powers of two
+#define WORKER_RENDER_QUEUE_SIZE 32
+#define WORKER_AUDIO_QUEUE_SIZE  8
+
+// Pixels drawn between audio refills
+#define WORKER_RENDER_CHUNK 256
+
+// Output devices driven by the worker
+typedef struct {
+    void* lcd;
+    void (*lcd_window)(void* lcd, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+    void (*lcd_write)(void* lcd, unsigned short colour);
+    void* audio;
+    unsigned int (*audio_space)(void* audio);
+    void (*audio_write)(void* audio, signed int sample);
+} WorkerSinks;
+
+typedef struct {
+    uint32_t loops;          // Worker loop passes
+    uint32_t commands;       // Render and audio commands completed
+    uint32_t pixels;         // Pixels written to the LCD
+    uint32_t samples;        // Samples written to the audio FIFO
+    uint32_t queue_full;     // Submissions that had to wait for queue space
+} WorkerStats;
+
+// Start the worker on core 1 (board) or a thread (host). Returns false if it could not be started.
+bool Worker_start(const WorkerSinks* sinks);
+
+// True once the worker is running and accepting commands
+bool Worker_running(void);
+
+// Fill a rectangle with a single colour
+void Worker_fill(unsigned short colour, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+
+// Copy an image to the LCD. The pixels must stay valid until the command completes.
+void Worker_blit(const unsigned short* pixels, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+
+// Copy an answer digit, recolouring black pixels green (correct != 0) or red
+void Worker_blitAnswer(int correct, const unsigned short* pixels, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+
+// Decode a PixelLz image (PixelLz.h) straight to the LCD; correct as for Worker_blitAnswer,
+// or -1 for no recolouring. The data must stay valid until the command completes.
+void Worker_blitCompressed(int correct, const void* data, uint32_t size, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+
+// Draw one font glyph cell, scaled up by an integer factor
+void Worker_glyph(char c, unsigned int scale, unsigned short colour, unsigned short background, unsigned int x, unsigned int y);
+
+// Queue a sound. The samples must stay valid until it has played.
+void Worker_playSound(const int16_t* samples, unsigned int count, int volume);
+
+// True while any sound is queued or playing
+bool Worker_soundBusy(void);
+
+// Wait until every submitted render command has completed; sounds may still be playing.
+// poll, if not NULL, is called on every pass of the wait, e.g. to keep software timers running.
+void Worker_flushRender(void (*poll)(void));
+
+// Wait until every submitted command has completed, sounds included; poll as for Worker_flushRender
+void Worker_flush(void (*poll)(void));
+
+// Read the worker statistics
+const WorkerStats* Worker_stats(void);
+
+#endif
@@ -20,6 +20,9 @@
  * - Audio Codec for playing sound files
  *  LT24 LCD for  display text message
  *
+ * All of them are reached through Hal.h, so the same game also builds for a Linux host,
+ * where it runs headless on virtual time with scripted input.
+ *
  * Game Flow:
  * 1. Start Menu: User chooses to start or quit the game.
  * 2. Menu: Displays a welcome message and moves to difficulty selection.
@@ -31,36 +34,43 @@
  */
 
 //including different libraries and drivers
-// Include drivers.
-#include "HPS_PrivateTimer/HPS_PrivateTimer.h"
-#include "DE1SoC_SevenSeg/DE1SoC_SevenSeg.h"
-#include "HPS_Watchdog/HPS_Watchdog.h"
-#include "DE1SoC_Addresses/DE1SoC_Addresses.h"
+// Every device is reached through the hardware abstraction layer
+#include "Hal.h"
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <time.h>
 #include <math.h>
-#include "Util/macros.h"
 
-//Audio related headers
-#include "DE1SoC_WM8731/DE1SoC_WM8731.h"
-#include "HPS_GPIO/HPS_GPIO.h"
-#include "HPS_I2C/HPS_I2C.h"
-#include "FPGA_PIO/FPGA_PIO.h"
+//File system header
 #include "FatFS/ff.h"
 
 //LCD header library
 #include "GameLib.h"
+#include "TimerWheel.h"
+#include "Tickless.h"
+#include "Supervisor.h"
+#include "Worker.h"
+#include "QuestionGen.h"
+#include "QuestionBank.h"
+#include "QuestionScheduler.h"
+#include "Practice.h"
+#include "Config.h"
+#include "Arena.h"
+#include "Memory.h"
+#include "Boot.h"
+#include "AssetPack.h"
+#include "LatencyHistogram.h"
+#include "AnswerEntry.h"
+#include "Expr.h"
+#include "Scoring.h"
+#include "SessionLog.h"
+#include "Replay.h"
+#include "Profile.h"
+#include "Trace.h"
+#include "Log.h"
 
 
-// Status function to exit on failure of timer driver
-void exitOnFail(signed int status, signed int successStatus) {
-    if (status != successStatus) {
-        exit((int) status); //Add breakpoint here to catch failure
-    }
-}
-
 /*
  * Function: check_status_audio_files
  * Description: Checks the status of audio file operations
@@ -70,10 +80,10 @@ void exitOnFail(signed int status, signed int successStatus) {
 void check_status_audio_files( FRESULT result ) {
 	switch (result) {
 		case FR_OK:
-		printf("Success \n");
+		LOG_DEBUG("Success \n");
 		break;
 		default:
-		printf("Failure \n");
+		LOG_ERROR("Failure %d\n", result);
 	}
 }
 
@@ -82,22 +92,10 @@ void check_status_audio_files( FRESULT result ) {
 #define DOUBLE_HEX_DISPLAY_LOCATION 2
 #define DOUBLE_DEC_DISPLAY_LOCATION 4
 
-#define QUESTION_PERIOD 225000000  // Time period for each question.
-#define MAX_QUESTIONS_PER_LEVEL 3  // Maximum questions per level.
+#define CONFIG_FILE "game.cfg"  // Question counts, answer time and session length.
 
 unsigned int countdown=20;
 
-// Define memory-mapped I/O addresses. for switch and buttons
-
-#define SW_BASE  0xFF200040
-#define KEY_BASE 0xFF200050
-
-// Context structures for various peripherals
-PFPGAPIOCtx_t leds;
-PWM8731Ctx_t audio;
-PHPSGPIOCtx_t gpio;
-PHPSI2CCtx_t   i2c;
-
 // File system objects and audio file declarations
 FATFS *file_system; // Structure of File system object
 FILINFO filinfo; // information about object read
@@ -113,39 +111,83 @@ int16_t *wrong_answer_buffer; //buffer for wrong_answer
 
 unsigned int correct_answer_size; // Size of  correct_answer buffer
 unsigned int wrong_answer_size; // Size of  correct_answer buffer
-signed int audio_sample;
-unsigned int space;
-
-signed int audio_sample;
 
-volatile unsigned int *KEY_ptr  = (unsigned int *)0xFF200050;
-
-//// ARM A9 Private Timer  related addresses.
-volatile unsigned int *private_timer_load = (unsigned int *)(LSC_BASE_PRIV_TIM + 0x0);
-volatile unsigned int *private_timer_value = (unsigned int *)(LSC_BASE_PRIV_TIM + 0x4);
-volatile unsigned int *private_timer_control = (unsigned int *)(LSC_BASE_PRIV_TIM + 0x8);
-volatile unsigned int *private_timer_interrupt = (unsigned int *)(LSC_BASE_PRIV_TIM + 0xC);
-const unsigned int CountPeriod = 225000000;
+// A sound whose samples are still being read from the SD card
+typedef struct {
+	FIL *file;
+	uint8_t *next;            // Where the next chunk goes
+	unsigned int remaining;   // Bytes still to read
+} AudioLoad;
+
+AudioLoad audio_loads[2];
+unsigned int audio_load_count; // Sounds started
+unsigned int audio_load_next;  // First sound not yet read in full
+
+bool start_screen_shown = false; // Drawn at boot, start_menu need not draw it again
+
+const unsigned int CountPeriod = HAL_TIMER_HZ; // Private timer counts per second
+
+// Software timers driven from the private timer, one wheel tick per millisecond
+#define TIMER_TICKS_PER_SECOND 1000
+#define TIMER_TICK_PERIOD (CountPeriod / TIMER_TICKS_PER_SECOND) // Private timer counts per tick
+TimerWheel game_timers;
+TimerNode countdown_timer; // Question countdown, fires once a second
+unsigned int timer_last_value; // HAL timer counts at the last poll
+unsigned int timer_tick_residue; // Counts carried over to the next tick
+uint32_t timer_ticks; // Wheel ticks since boot
+uint32_t flush_started; // Untraced timer counts when flush_render began waiting
+
+// Watchdog supervision: the supervisor runs every 100ms and feeds the watchdog if all tasks are alive
+#define SUPERVISOR_PERIOD_TICKS 100
+#define EVENT_LOOP_TIMEOUT_TICKS 5000 // Event loops may block this long (e.g. while a sound plays)
+#define AUDIO_TIMEOUT_TICKS 200       // Audio FIFO must accept a sample at least this often
+#define WORKER_TIMEOUT_TICKS 500      // Worker core must complete a loop at least this often
+
+// Run LCD drawing and audio playback on the second core (0 keeps everything on core 0).
+// Host builds default to 0 so a scripted run is deterministic.
+#ifndef RENDER_WORKER
+#if defined(__linux__)
+#define RENDER_WORKER 0
+#else
+#define RENDER_WORKER 1
+#endif
+#endif
+
+// Time Log_write against printf at boot and print the result (0 to skip)
+#ifndef LOG_BENCHMARK
+#define LOG_BENCHMARK 0
+#endif
+
+// Draw the start screen before the SD card is read, and read the sounds while the game
+// waits for input (0 reads everything first, to compare the time to first pixel)
+#ifndef BOOT_LCD_FIRST
+#define BOOT_LCD_FIRST 1
+#endif
+
+// Exit with status 1 when a blitz misses its transition budget, so a scripted host run fails
+// (0 only reports it). tools/blitz_benchmark.c runs the game this way.
+#ifndef BLITZ_BENCHMARK
+#define BLITZ_BENCHMARK 0
+#endif
+
+#define AUDIO_LOAD_CHUNK 4096 // Bytes of samples read per idle pass while the sounds load
+
+// Longest idle sleep, keeps the watchdog fed while nothing else is pending
+#define IDLE_MAX_SLEEP_TICKS 250
 
 
 
 // Define game states and difficulty levels.
 typedef enum { START_MENU, MENU, SELECT_DIFFICULTY, IN_PROGRESS, ASK_CONTINUE, END, QUIT } GameState;
 
-typedef enum { EASY, MEDIUM, HARD } Difficulty;
+// Normal levels, practice of questions answered wrongly or slowly before, or a timed blitz
+typedef enum { GAME_NORMAL, GAME_PRACTICE, GAME_BLITZ } GameMode;
+
 GameState game_state = START_MENU;
+GameMode game_mode = GAME_NORMAL;
 Difficulty difficulty = EASY;
 
 
-// Define structure for math questions.
-typedef struct {
-    char* question;
-    int answer;  // Numeric answers for Medium and Hard.
-    char* choices[4];  // Multiple-choice for Easy level.
-    int correct_choice;  // Correct choice index for Easy level.
-    int user_answer;  // User provided answer.
-} MathQuestion;
-
 /*
  * WAV Header Declaration
  * Referenced from online sources
@@ -168,14 +210,43 @@ typedef struct {
 
 
 
-// Array of questions.
-MathQuestion questions[3][MAX_QUESTIONS_PER_LEVEL];
+// Questions of each level, allocated from the question arena at boot.
+GameConfig game_config;
+Arena question_arena;
+MathQuestion* questions[DIFFICULTY_COUNT];
+QuestionRng question_rng; // Question generator, seeded from the private timer
+QuestionBank question_bank; // Curated questions on the SD card, if present
+#define QUESTION_SCHEDULE_FILE "schedule.bin" // Bank questions already seen, kept across sessions
+#define PRACTICE_FILE "practice.bin" // Practice history, kept across sessions
+#define SESSION_LOG_FILE "sessions.log" // Every finished session, appended at game over
+#define HIGH_SCORE_FILE "scores.bin" // Best sessions, rebuilt from the session log if damaged
+#define QUESTION_BANK_FILE "questions.bin" // Curated questions, optional
+#define INPUT_TRACE_FILE "input.trc" // Inputs of the sessions since boot, with input_trace=1
+#define REPLAY_TRACE_FILE "replay.trc" // Inputs replayed instead of the hardware, with input_trace=2
+#define EVENT_TRACE_FILE "trace.json" // Last events before game over as Chrome trace JSON, with trace_export=1
+#define ASSET_PACK_FILE "assets.pak" // Images, with ASSETS_FROM_PACK
+#define PRACTICE_SLOW_TICKS 10000 // Correct answers slower than this are practised again
+Difficulty* practice_levels; // Difficulty of each question in a practice level
+PracticeRecord* practice_selection; // Practice records chosen for a practice level
+int questions_in_level = 0;
+unsigned int session_questions_asked = 0;
 int current_question = 0;
+unsigned int formulas_checked = 0; // Loaded questions whose answer was checked against their formula
+unsigned int formulas_rejected = 0;
+
+// Blitz: as many correct answers as possible in a fixed window, questions back to back
+#define BLITZ_SECONDS 60
+#define BLITZ_TRANSITION_BUDGET_US 16667 // One LCD frame at 60Hz from answer to next question drawn
+#define BLITZ_BUCKET_US 500 // Transitions are timed with Hal_cycles, wall clock on the host
+#define PRIVATE_TIMER_COUNTS_PER_US (CountPeriod / 1000000)
+LatencyHistogram blitz_transitions;
 int score = 0;
+ScoreSession score_session; // Points with time bonus and the response time of every answer this session
+uint32_t question_shown_us; // When the current question finished drawing
 
 // Function declarations.
 //void delay(int milliseconds);
-void generate_questions();
+void generate_questions(Difficulty level);
 void display_question();
 void evaluate_answer();
 void update_game_state(unsigned char Timeout);
@@ -183,12 +254,17 @@ void ask_continue();
 void display_game_over();
 unsigned char handle_user_input();
 void select_difficulty();
-int process_switch_input(int);
+void play_blitz();
 
 void start_menu();
-void initialisetimer_timer(PTimerCtx_t* timerCtx);
-void check_timer(PTimerCtx_t* timerCtx);
 void reset_time();
+void poll_timers();
+void run_timers();
+void idle_wait();
+void flush_render();
+void flush_keep_alive();
+uint32_t read_time_us(void);
+uint32_t read_timer_counts(void);
 
 
 /*--------------------------------------------------
@@ -207,11 +283,12 @@ unsigned int buffer_size( FIL *input_file )
 
 /**
  * Function: fileread
- * Description: Reads the WAV file into a buffer
- * Input(s): FIL *input_file - pointer to the input file, int16_t *buffer - buffer to store the data
- * Return: signed short int* - pointer to the read buffer
+ * Description: Reads the WAV file header and reserves the sample buffer. The samples are read
+ *              into it a chunk at a time by audio_load_step.
+ * Input(s): FIL *input_file - pointer to the input file
+ * Return: signed short int* - pointer to the sample buffer
  */
-signed short int *fileread( FIL *input_file, int16_t *buffer )
+signed short int *fileread( FIL *input_file )
 {
     WAV_Header_TypeDef wavHeader; // WAV_Header for wav header.
     unsigned int read_size =0;
@@ -220,72 +297,125 @@ signed short int *fileread( FIL *input_file, int16_t *buffer )
     check_status_audio_files ( f_read ( input_file, &wavHeader, sizeof(wavHeader), &read_size)); // Read the WAV file header
 
     file_size = (file_size - sizeof(wavHeader)); //File size
-
-    HPS_ResetWatchdog();
+    if (file_size < 0) file_size = 0; // Shorter than a header, nothing to play
 
     int16_t *temp_buffer;
-    temp_buffer = (int16_t *)malloc(sizeof(int16_t) *file_size);
+    temp_buffer = (int16_t *)Memory_alloc(MEMORY_AUDIO, file_size, "audio samples"); // file_size is in bytes
+
+    AudioLoad *load = &audio_loads[audio_load_count++];
+    load->file = input_file;
+    load->next = (uint8_t *)temp_buffer;
+    load->remaining = file_size;
 
-    //Read file
-    check_status_audio_files ( f_read(input_file, temp_buffer, file_size, &read_size) );
+    return temp_buffer;
+}
+
+/**
+ * Function: audio_loading
+ * Description: Tells whether any sound is still being read from the SD card
+ * Input(s): None
+ * Return: bool - true until every sample is in memory
+ */
+bool audio_loading() {
+    return audio_load_next < audio_load_count;
+}
 
-    buffer = temp_buffer;
+/**
+ * Function: audio_load_step
+ * Description: Reads the next chunk of samples, closing each file once it is read in full
+ * Input(s): None
+ * Return: void
+ */
+void audio_load_step() {
+    PROFILE_SCOPE("audio_load");
+    TRACE_SCOPE("audio_load");
+    unsigned int read_size = 0;
 
-    HPS_ResetWatchdog(); // Reset Watchdog.
+    if (!audio_loading()) {
+        return;
+    }
+    AudioLoad *load = &audio_loads[audio_load_next];
+    unsigned int chunk = (load->remaining < AUDIO_LOAD_CHUNK) ? load->remaining : AUDIO_LOAD_CHUNK;
+    if (chunk > 0) {
+        FRESULT result = f_read(load->file, load->next, chunk, &read_size);
+        check_status_audio_files(result);
+        if (result != FR_OK || read_size == 0) {
+            read_size = load->remaining; // Plays what was read, the rest stays silent
+        }
+    }
+    load->next += read_size;
+    load->remaining -= read_size;
+
+    if (load->remaining == 0) {
+        f_close(load->file);
+        Memory_fileFree(load->file); // Back to the pool for the next file opened
+        audio_load_next++;
+        if (!audio_loading()) {
+            LOG_INFO("Sounds loaded %lu ms after boot\n", (unsigned long)(Boot_elapsedUs() / 1000));
+        }
+    }
+}
 
-    return temp_buffer;
+/**
+ * Function: finish_audio_loading
+ * Description: Reads whatever is left of the sounds, keeping the timers and supervisor running
+ * Input(s): None
+ * Return: void
+ */
+void finish_audio_loading() {
+    while (audio_loading()) {
+        audio_load_step();
+        poll_timers();
+        Supervisor_checkIn(SUPERVISOR_EVENT_LOOP); // Heartbeat, the supervisor feeds the watchdog
+    }
 }
 
 /**
- * Function: audio_files_init
- * Description: Initializes the audio files by mounting the file system and reading the correct_answer.wav & wrong_answer.wav file
+ * Function: mount_sd_card
+ * Description: Registers the file system object for the SD card, which is read on first use
  * Input(s): None
  * Return: void
  */
-void audio_files_init()
+void mount_sd_card()
 {
-	file_system = malloc ( sizeof (FATFS) ); // FATFS pointer memory allocation
+	file_system = Memory_fileSystem(); // FATFS object, statically allocated
 
-	printf("Driver mounting");
+	printf("Driver mounting\n");
 	check_status_audio_files(f_mount ( file_system , "" , 0)); //mounting the drive to program
+}
 
-	// Allocate memory for the file
-	correct_answer_file = malloc ( sizeof (FIL));
-	wrong_answer_file = malloc ( sizeof (FIL));
+/**
+ * Function: audio_files_init
+ * Description: Initializes the audio files by opening the correct_answer.wav & wrong_answer.wav file.
+ *              Their samples are read by audio_load_step, from the idle loop or before the first sound.
+ * Input(s): None
+ * Return: void
+ */
+void audio_files_init()
+{
+	// File objects from the pool, returned once the samples are read in the background
+	correct_answer_file = Memory_fileAlloc("correct_answer.wav");
+	wrong_answer_file = Memory_fileAlloc("wrong_answer.wav");
 
 	printf("Opening correct_answer.wav file\n");
 	check_status_audio_files( f_open ( correct_answer_file ,"correct_answer.wav", FA_READ));
-	HPS_ResetWatchdog(); // reset watchdog
+	Hal_feedWatchdog(); // reset watchdog
 
 	printf("Opening wrong_answer.wav file\n");
 	check_status_audio_files( f_open ( wrong_answer_file ,"wrong_answer.wav", FA_READ));
-	HPS_ResetWatchdog(); // reset watchdog
+	Hal_feedWatchdog(); // reset watchdog
 
-	correct_answer_buffer = fileread( correct_answer_file, correct_answer_buffer );
+	correct_answer_buffer = fileread( correct_answer_file );
 	correct_answer_size = buffer_size (correct_answer_file);
 
-	wrong_answer_buffer = fileread( wrong_answer_file, wrong_answer_buffer);
+	wrong_answer_buffer = fileread( wrong_answer_file );
 	wrong_answer_size = buffer_size (wrong_answer_file);
-}
-
-/* Function: audio_initialise
-* Description: Initialises the audio peripherals
-* Input(s): None
-* Return: void
-*/
-void audio_initialise()
-{
-
-	exitOnFail(HPS_GPIO_initialise(LSC_BASE_ARM_GPIO, ARM_GPIO_DIR, ARM_GPIO_I2C_GENERAL_MUX, 0, &gpio), ERR_SUCCESS);
-	exitOnFail(HPS_I2C_initialise(LSC_BASE_I2C_GENERAL, I2C_SPEED_STANDARD, &i2c), ERR_SUCCESS);
-    exitOnFail(WM8731_initialise(LSC_BASE_AUDIOCODEC, i2c, &audio), ERR_SUCCESS);
-	WM8731_clearFIFO(audio, true,true);// clear FIFO space
-
-	WM8731_getFIFOSpace(audio, &space);
 
+	// Only the bank header is read here, questions are read one at a time as they are used
+	QuestionBank_open(&question_bank, QUESTION_BANK_FILE);
+	Hal_feedWatchdog(); // reset watchdog
 }
 
-
 /**
  * Function: play_sound
  * Description: Plays the sound from the audio buffer
@@ -294,28 +424,80 @@ void audio_initialise()
  */
 void play_sound( int16_t *audio_buffer, unsigned int audio_size )
 {
+	PROFILE_SCOPE("play_sound");
+	TRACE_SCOPE("play_sound");
 	int crnt_pointer = 0; // data index
 	int volume = 10000; // Volume of audio output
+	unsigned int space; // Free FIFO slots
+	signed int audio_sample;
+
+	finish_audio_loading(); // Only waits if the first answer comes before the sounds are read
+
+		// The worker core feeds the FIFO in the background
+		if (Worker_running()) {
+			Worker_playSound(audio_buffer, audio_size/2, volume);
+			return;
+		}
 
+		Supervisor_begin(SUPERVISOR_AUDIO, AUDIO_TIMEOUT_TICKS);
 		while ( crnt_pointer < (audio_size/2) )
 		{
 
-			WM8731_getFIFOSpace(audio, &space);
+			space = Replay_playing() ? Replay_next(REPLAY_AUDIO_SPACE) : Replay_record(REPLAY_AUDIO_SPACE, Hal_audioSpace());
 			if (space > 0)
 			{ // Checks if FIFO pointer is free
 				audio_sample = audio_buffer[crnt_pointer] * volume; // Pass data onto buffer
-				WM8731_writeSample(audio, audio_sample, audio_sample);
+				Hal_audioWrite(audio_sample);
 				crnt_pointer = crnt_pointer +1;
+				Supervisor_checkIn(SUPERVISOR_AUDIO); // Only progress counts as a heartbeat
 			}
 
-			HPS_ResetWatchdog(); // reset watchdog
+			poll_timers(); // Lets the supervisor run while the sound plays
 		}
 
-		HPS_ResetWatchdog(); // reset watchdog
+		Supervisor_end(SUPERVISOR_AUDIO);
 
+}
+
+
+/*
+ * Worker output sinks: the worker core drives the LCD and audio codec through these
+ */
+void worker_lcd_window(void* lcd, unsigned int x, unsigned int y, unsigned int width, unsigned int height) {
+	(void)lcd;
+	Hal_lcdWindow(x, y, width, height);
+}
 
+void worker_lcd_write(void* lcd, unsigned short colour) {
+	(void)lcd;
+	Hal_lcdWrite(colour);
 }
 
+unsigned int worker_audio_space(void* codec) {
+	(void)codec;
+	return Hal_audioSpace();
+}
+
+void worker_audio_write(void* codec, signed int sample) {
+	(void)codec;
+	Hal_audioWrite(sample);
+}
+
+/**
+ * Function: start_worker
+ * Description: Starts the render/audio worker on core 1 and adds it to watchdog supervision
+ * Input(s): None
+ * Return: void
+ */
+void start_worker(void) {
+	WorkerSinks sinks = {
+		0, worker_lcd_window, worker_lcd_write,
+		0, worker_audio_space, worker_audio_write
+	};
+	if (Worker_start(&sinks)) {
+		Supervisor_begin(SUPERVISOR_WORKER, WORKER_TIMEOUT_TICKS);
+	}
+}
 
 /**
  * Function: read_slide_switches
@@ -324,8 +506,14 @@ void play_sound( int16_t *audio_buffer, unsigned int audio_size )
  * Return: int - state of the slide switches
  */
 int read_slide_switches() {
-    volatile int *sw_ptr = (int *)SW_BASE;
-    return *sw_ptr;
+    static unsigned int traced_switches;
+    unsigned int switches = Replay_playing() ? Replay_next(REPLAY_SWITCHES) : Replay_record(REPLAY_SWITCHES, Hal_readSwitches());
+
+    if (switches != traced_switches) {
+        TRACE_INSTANT("switches", switches);
+        traced_switches = switches;
+    }
+    return (int)switches;
 }
 
 /**
@@ -335,31 +523,215 @@ int read_slide_switches() {
  * Return: int - state of the push buttons
  */
 int read_push_buttons() {
-    volatile int *key_ptr = (int *)KEY_BASE;
-    return *key_ptr;
+    static unsigned int traced_keys;
+    unsigned int keys = Replay_playing() ? Replay_next(REPLAY_KEYS) : Replay_record(REPLAY_KEYS, Hal_readKeys());
+
+    if (keys != traced_keys) {
+        TRACE_INSTANT("keys", keys);
+        traced_keys = keys;
+    }
+    return (int)keys;
+}
+
+/**
+ * Function: worker_sound_busy
+ * Description: Tells whether the worker is still playing a sound, through the input recorder,
+ *              since the answer depends on how fast the worker runs
+ * Input(s): None
+ * Return: bool - true while a sound is queued or playing
+ */
+bool worker_sound_busy() {
+    if (Replay_playing()) return Replay_next(REPLAY_SOUND_BUSY) != 0;
+    return Replay_record(REPLAY_SOUND_BUSY, Worker_soundBusy()) != 0;
+}
+
+/**
+ * Function: check_question_formula
+ * Description: Compiles a question's formula and checks its answer against it. Questions
+ *              without a formula are accepted as they are.
+ * Input(s): const MathQuestion* question
+ * Return: bool - false if the formula is invalid or disagrees with the answer
+ */
+bool check_question_formula(const MathQuestion* question) {
+    ExprProgram program;
+    ExprStatus status;
+    int position = 0;
+    bool correct = false;
+
+    if (question->formula[0] == '\0') return true;
+    formulas_checked++;
+    status = Expr_compile(question->formula, &program, &position);
+    if (status == EXPR_OK) {
+        status = Expr_verify(&program, question->answer, &correct);
+    }
+    if (status != EXPR_OK) {
+        printf("Rejected question \"%s\": formula %s: %s at %d\n", question->question, question->formula,
+               Expr_statusText(status), position);
+    } else if (!correct) {
+        printf("Rejected question \"%s\": formula %s does not give %d\n", question->question, question->formula,
+               question->answer);
+    }
+    formulas_rejected += !correct;
+    return correct;
+}
+
+/**
+ * Function: load_question
+ * Description: Fills in a question from its id, reading the question bank or re-running the generator
+ * Input(s): Difficulty level, uint64_t id - MathQuestion id, MathQuestion* question - filled in
+ * Return: bool - true if the question could be loaded
+ */
+bool load_question(Difficulty level, uint64_t id, MathQuestion* question) {
+    AnswerEntryMode entry = (AnswerEntryMode)game_config.answer_entry;
+
+    if (id & QUESTION_ID_BANK) {
+        // Medium and Hard answers must be enterable with the configured answer entry
+        return QuestionBank_load(&question_bank, level, (uint32_t)(id & ~QUESTION_ID_BANK), question) &&
+               (level == EASY || (question->answer >= AnswerEntry_minimum(entry) && question->answer <= AnswerEntry_maximum(entry))) &&
+               check_question_formula(question);
+    }
+
+    QuestionRng rng;
+    int max_answer = (int)game_config.max_answer;
+    if (max_answer > AnswerEntry_maximum(entry)) max_answer = AnswerEntry_maximum(entry);
+    QuestionRng_seed(&rng, id);
+    QuestionGen_generate(&rng, level, max_answer, question);
+    question->id = id;
+    return check_question_formula(question);
+}
+
+/**
+ * Function: next_question
+ * Description: Produces one new question, from the bank scheduler if the bank has questions for the level
+ * Input(s): Difficulty level, MathQuestion* question - filled in
+ * Return: void
+ */
+void next_question(Difficulty level, MathQuestion* question) {
+    bool loaded = QuestionBank_count(&question_bank, level) &&
+                  load_question(level, QUESTION_ID_BANK | QuestionScheduler_next(level), question);
+    // Each generated question gets its own seed, which doubles as its id. A generated question
+    // failing its formula check is a generator bug; try another seed rather than ask it.
+    for (int attempt = 0; !loaded && attempt < 4; attempt++) {
+        uint64_t seed = ((uint64_t)QuestionRng_next(&question_rng) << 32) | QuestionRng_next(&question_rng);
+        loaded = load_question(level, seed & ~QUESTION_ID_BANK, question);
+    }
 }
 
 /**
  * Function: generate_questions
- * Description: Generates math questions for all difficulty levels
+ * Description: Picks a fresh set of math questions for the level about to be played, from
+ *              the SD card question bank when it has questions for the level, otherwise generated.
+ *              Bank questions come from the scheduler, so none repeats until all have been seen.
+ * Input(s): Difficulty level
+ * Return: void
+ */
+void generate_questions(Difficulty level) {
+    questions_in_level = game_config.questions_per_level[level];
+    for (int i = 0; i < questions_in_level; i++) {
+        next_question(level, &questions[level][i]);
+    }
+}
+
+/**
+ * Function: select_practice_questions
+ * Description: Fills a practice level with the questions that are soonest due for review
  * Input(s): None
  * Return: void
  */
-void generate_questions() {
+void select_practice_questions() {
+    unsigned int count = Practice_select(practice_selection, game_config.practice_questions);
+
+    questions_in_level = 0;
+    for (unsigned int i = 0; i < count; i++) {
+        Difficulty level = (Difficulty)practice_selection[i].difficulty;
+        // Slot i of the question's own level, so questions[difficulty][current_question] still finds it
+        if (load_question(level, practice_selection[i].id, &questions[level][questions_in_level])) {
+            practice_levels[questions_in_level++] = level;
+        }
+    }
+}
+
+/**
+ * Function: initialise_question_storage
+ * Description: Sizes the question arena from the configuration and carves the level arrays
+ *              and the session's response array out of it, so no memory is allocated once
+ *              the game is running
+ * Input(s): None
+ * Return: void
+ */
+void initialise_question_storage() {
+    uint32_t slots[DIFFICULTY_COUNT];
+    uint32_t practice = game_config.practice_questions;
+    uint32_t responses = game_config.session_questions ? game_config.session_questions : SCORING_DEFAULT_RESPONSES;
+    if (responses > SCORING_MAX_RESPONSES) responses = SCORING_MAX_RESPONSES; // Later answers still score
+    size_t size = ARENA_ALIGN(practice * sizeof(Difficulty)) + ARENA_ALIGN(practice * sizeof(PracticeRecord)) +
+                  ARENA_ALIGN(responses * sizeof(ScoreResponse));
+
+    // A practice level places its questions in the arrays of their own difficulties
+    for (int level = EASY; level <= HARD; level++) {
+        slots[level] = game_config.questions_per_level[level];
+        if (slots[level] < practice) slots[level] = practice;
+        if (slots[level] < 2) slots[level] = 2; // Blitz prepares the next question in a second slot
+        size += ARENA_ALIGN(slots[level] * sizeof(MathQuestion));
+    }
 
-    questions[EASY][0] = (MathQuestion){"What is 6 * 7?", 42, {"42", "36", "48", "30"}, 0, -1};
-    questions[EASY][1] = (MathQuestion){"What is 15 / 3?", 5, {"3", "5", "7", "9"}, 1, -1};
-    questions[EASY][2] = (MathQuestion){"What is 8 * 9?", 72, {"72", "64", "80", "68"}, 0, -1};
+    Arena_initialise(&question_arena, malloc(size), size);
+    for (int level = EASY; level <= HARD; level++) {
+        questions[level] = Arena_alloc(&question_arena, slots[level] * sizeof(MathQuestion));
+    }
+    practice_levels = Arena_alloc(&question_arena, practice * sizeof(Difficulty));
+    practice_selection = Arena_alloc(&question_arena, practice * sizeof(PracticeRecord));
+    ScoreResponse* response_storage = Arena_alloc(&question_arena, responses * sizeof(ScoreResponse));
+    Scoring_initialise(&score_session, response_storage, responses);
+
+    if (!questions[EASY] || !questions[MEDIUM] || !questions[HARD] || !practice_levels || !practice_selection || !response_storage) {
+        printf("Not enough memory for %lu bytes of questions\n", (unsigned long)size);
+        exit(1);
+    }
+    printf("Question arena: %lu bytes\n", (unsigned long)Arena_used(&question_arena));
+}
+
+/**
+ * Function: start_input_trace
+ * Description: Starts recording the inputs to the SD card, or replaying them from it, as set by
+ *              input_trace in the configuration
+ * Input(s): None
+ * Return: void
+ */
+void start_input_trace() {
+    static const char* const state_files[] = { QUESTION_BANK_FILE, QUESTION_SCHEDULE_FILE, PRACTICE_FILE, 0 };
+    ReplayMode mode = (ReplayMode)game_config.input_trace;
 
-    questions[MEDIUM][0] = (MathQuestion){"Solve for x: 3x - 2 = 7", 3, {0}, 0, -1};
-    questions[MEDIUM][1] = (MathQuestion){"What is the value of 4x when x = 2?", 8, {0}, 0, -1};
-    questions[MEDIUM][2] = (MathQuestion){"If x - 2 = 5, what is x?", 7, {0}, 0, -1};
-    questions[HARD][0] = (MathQuestion){"Find x if 5x = 45", 9, {0}, 0, -1};
-    questions[HARD][1] = (MathQuestion){"What is the unit digit of 2^8?", 6, {0}, 0, -1};
-    questions[HARD][2] = (MathQuestion){"Calculate the derivative of x^2 at x = 3", 6, {0}, 0, -1};
+    Replay_start(mode, (mode == REPLAY_PLAY) ? REPLAY_TRACE_FILE : INPUT_TRACE_FILE,
+                 RENDER_WORKER ? REPLAY_FLAG_RENDER_WORKER : 0, state_files);
 }
 
+/**
+ * Function: seed_questions
+ * Description: Seeds the question generator from the free running timer
+ * Input(s): None
+ * Return: void
+ */
+void seed_questions() {
+    QuestionRng_seed(&question_rng, ((uint64_t)timer_ticks << 32) | read_timer_counts());
+}
 
+/**
+ * Function: initialise_question_schedule
+ * Description: Sizes the no-repeat scheduler to the question bank and restores the last session's progress
+ * Input(s): None
+ * Return: void
+ */
+void initialise_question_schedule() {
+    uint32_t pool[DIFFICULTY_COUNT];
+    for (int level = EASY; level <= HARD; level++) {
+        pool[level] = QuestionBank_count(&question_bank, (Difficulty)level);
+    }
+    QuestionScheduler_initialise(pool, ((uint64_t)QuestionRng_next(&question_rng) << 32) | QuestionRng_next(&question_rng));
+    if (question_bank.open) {
+        QuestionScheduler_load(QUESTION_SCHEDULE_FILE);
+    }
+}
 
 /**
 * Function: display_question
@@ -367,44 +739,34 @@ void generate_questions() {
 * Input(s): None
 * Return: void
 */
-void display_question(PLT24Ctx_t lt24) {
+void display_question() {
+	PROFILE_SCOPE("display_question");
+	TRACE_SCOPE("display_question");
 
-	unsigned short QuesId = (difficulty + 1)*10 + current_question;
+	ShowQuestion(difficulty, &questions[difficulty][current_question]);
+	flush_render(); // Response time starts once the question is on the screen
+	question_shown_us = read_time_us();
 
-	ShowScreen(QuesId, lt24);
-
-	printf("Question: %s\n", questions[difficulty][current_question].question);
-    printf("Options: \n");
+	// Logged rather than printed, the UART would hold up the countdown; printed at the first idle wait
+	LOG_INFO("Question: %s\n", questions[difficulty][current_question].question);
+    LOG_INFO("Options: \n");
     if (difficulty == EASY)
     	{
-			for (int i = 0; i < 4; i++)
-			{
-				printf("%s\t", questions[difficulty][current_question].choices[i]);
-			}
-			printf("Press KEY0 for A, KEY1 for B, KEY2 for C, KEY3 for D to select your answer.\n");
+			LOG_INFO("%s\t%s\t%s\t%s\t", questions[difficulty][current_question].choices[0],
+			         questions[difficulty][current_question].choices[1], questions[difficulty][current_question].choices[2],
+			         questions[difficulty][current_question].choices[3]);
+			LOG_INFO("Press KEY0 for A, KEY1 for B, KEY2 for C, KEY3 for D to select your answer.\n");
     }
     else {
-        printf("Use the switches to set your answer (0-9), and press KEY0 to confirm.\n");
+        static const char* const entry_help[ANSWER_ENTRY_MODE_COUNT] = {
+            "Raise the switch for your answer (0-9)",
+            "Set your answer in binary on SW0-SW9, KEY3 for minus",
+            "KEY1 changes the digit, KEY2 moves to the next digit, KEY3 for minus"
+        };
+        LOG_INFO("%s, and press KEY0 to confirm.\n", entry_help[game_config.answer_entry]);
     }
 }
 
-/**
- * Function: initialisetimer_timer
- * Description: Initializes the timer for the game
- * Input(s): PTimerCtx_t* timerCtx - pointer to the timer context
- * Return: void
- */
-void initialisetimer_timer(PTimerCtx_t* timerCtx) {
-	    exitOnFail(Timer_initialise(LSC_BASE_PRIV_TIM, timerCtx), ERR_SUCCESS); // Initialise Timer Controller
-	    exitOnFail(Timer_setLoad(*timerCtx, QUESTION_PERIOD), ERR_SUCCESS); // Set Timer Controller Load Value
-	    exitOnFail(Timer_setPrescaler(*timerCtx, 0), ERR_SUCCESS);     // Set Timer Controller Prescaler Value
-	    exitOnFail(Timer_setAutoReload(*timerCtx, true), ERR_SUCCESS); // Enable Timer AutoReload
-	    exitOnFail(Timer_enable(*timerCtx, true), ERR_SUCCESS);        // Enable Timer
-	    unsigned int timerCurrentValue;
-	    exitOnFail(Timer_currentValue(*timerCtx, &timerCurrentValue), ERR_SUCCESS); // Read Timer Current Value
-	    ResetWDT(); // Reset watchdog
-}
-
 /**
  * Function: reset_timer
  * Description: Resets the countdown timer
@@ -413,33 +775,186 @@ void initialisetimer_timer(PTimerCtx_t* timerCtx) {
  **/
 void reset_timer() {
     countdown = 9;  // Reset countdown to 10 seconds
-    //DE1SoC_SevenSeg_SetSingle(0, countdown);  // Display initial countdown value
+    //Hal_sevenSegSetSingle(0, countdown);  // Display initial countdown value
+}
+
+/**
+ * Function: read_cycle_counter
+ * Description: Returns the timer as an up-counter, used to measure timer wheel overhead. Not
+ *              recorded, so a replay measures the machine it runs on.
+ * Input(s): None
+ * Return: uint32_t - elapsed timer counts
+ */
+uint32_t read_cycle_counter(void) {
+    return Hal_timerCounts();
+}
+
+/**
+ * Function: read_timer_counts
+ * Description: Reads the timer for everything that steers the game, through the input recorder
+ * Input(s): None
+ * Return: uint32_t - elapsed timer counts, from the trace when replaying
+ */
+uint32_t read_timer_counts(void) {
+    if (Replay_playing()) return Replay_next(REPLAY_TIMER);
+    return Replay_record(REPLAY_TIMER, Hal_timerCounts());
+}
+
+/**
+ * Function: read_time_us
+ * Description: Microseconds since the timer wheel started, from the wheel ticks plus the timer
+ *              counts not yet polled. Valid across timer_sleep, which keeps both consistent.
+ * Input(s): None
+ * Return: uint32_t - microseconds, wraps after about 71 minutes
+ */
+uint32_t read_time_us(void) {
+    uint32_t counts = timer_tick_residue + (read_timer_counts() - timer_last_value);
+    return timer_ticks * (1000000 / TIMER_TICKS_PER_SECOND) + counts / PRIVATE_TIMER_COUNTS_PER_US;
 }
 
 /**
- * Function: check_timer
- * Description: Checks the timer to determine if the question period has elapsed
- * Input(s): PTimerCtx_t* timerCtx - pointer to the timer context
+ * Function: initialise_timer_wheel
+ * Description: Starts the software timer wheel from the current timer value
+ * Input(s): None
  * Return: void
  */
-void check_timer(PTimerCtx_t* timerCtx) {
+void initialise_timer_wheel() {
+    timer_last_value = read_timer_counts();
+    timer_tick_residue = 0;
+    timer_ticks = 0;
+    TimerWheel_initialise(&game_timers, timer_ticks, read_cycle_counter);
+    Tickless_initialise(timer_ticks);
+}
 
-	 unsigned int timerCurrentValue;
-	    bool irqFlag = false;
+/**
+ * Function: add_timer_counts
+ * Description: Converts elapsed timer counts into wheel ticks, keeping the remainder
+ * Input(s): unsigned int elapsed - timer counts
+ * Return: void
+ */
+void add_timer_counts(unsigned int elapsed) {
+    timer_ticks += elapsed / TIMER_TICK_PERIOD;
+    timer_tick_residue += elapsed % TIMER_TICK_PERIOD;
+    if (timer_tick_residue >= TIMER_TICK_PERIOD) {
+        timer_tick_residue -= TIMER_TICK_PERIOD;
+        timer_ticks++;
+    }
+}
 
-	    exitOnFail(Timer_currentValue(*timerCtx, &timerCurrentValue), ERR_SUCCESS); // Read Timer Current Value
-	    exitOnFail(Timer_irqFlag(*timerCtx, &irqFlag), ERR_SUCCESS); // Read Timer IRQ Flags
+/**
+ * Function: sync_timer_ticks
+ * Description: Folds the timer counts since the last poll into the wheel tick count
+ * Input(s): None
+ * Return: void
+ */
+void sync_timer_ticks() {
+    unsigned int value = read_timer_counts();
+    add_timer_counts(value - timer_last_value); // Counter wraps from 0xFFFFFFFF to 0
+    timer_last_value = value;
+}
 
-	    if (irqFlag) {
-	        countdown--;  // Decrease countdown
-	        DE1SoC_SevenSeg_SetDoubleDec(0, countdown);  // Update display
-	        if (countdown == 0) {
-	            // Time is up, handle timeout (e.g., move to the next question or update game state)
-	            update_game_state(0);
-	            reset_timer();  // Reset timer for the next question
-	        }
-	    }
+/**
+ * Function: poll_timers
+ * Description: Converts elapsed timer counts into wheel ticks and runs expired timer callbacks.
+ *              Called from every event loop.
+ * Input(s): None
+ * Return: void
+ */
+void poll_timers() {
+    Tickless_iteration();
+    run_timers();
+}
+
+/**
+ * Function: run_timers
+ * Description: Brings the timer wheel up to date and runs expired timer callbacks, for waits
+ *              that are not event loop passes
+ * Input(s): None
+ * Return: void
+ */
+void run_timers() {
+    sync_timer_ticks();
+    TimerWheel_advance(&game_timers, timer_ticks);
+    TimerWheel_dispatch(&game_timers);
+}
+
+/**
+ * Function: timer_sleep
+ * Description: Sleeps for the given number of ticks, or until a key press, waking exactly on a
+ *              tick boundary. The board waits in WFI on a one-shot timer, the host jumps virtual time.
+ * Input(s): uint32_t ticks - ticks to sleep for
+ * Return: uint32_t - ticks actually slept
+ */
+uint32_t timer_sleep(uint32_t ticks) {
+    uint32_t ticks_before;
+
+    sync_timer_ticks();
+    ticks_before = timer_ticks;
+    if (!Replay_playing()) {
+        Hal_sleep(ticks * TIMER_TICK_PERIOD - timer_tick_residue); // A replay takes its time from the trace
+    }
+    sync_timer_ticks();
+
+    return timer_ticks - ticks_before;
+}
 
+/**
+ * Function: idle_wait
+ * Description: Sleeps until the next timer deadline or input event, whichever comes first
+ * Input(s): None
+ * Return: void
+ */
+void idle_wait() {
+    Log_drain(); // Messages logged since the last wait go out while there is nothing else to do
+    if (audio_loading()) {
+        audio_load_step(); // The sounds load in the time the game would otherwise sleep
+        return;
+    }
+    Tickless_idle(&game_timers, IDLE_MAX_SLEEP_TICKS, timer_sleep);
+}
+
+/**
+ * Function: flush_render
+ * Description: Waits until the render worker has drawn everything queued, but not for sounds to
+ *              finish. The number of passes depends on the worker's speed, so the wait reads no
+ *              recorded inputs; the timers catch up with one read once the drawing is done.
+ * Input(s): None
+ * Return: void
+ */
+void flush_render() {
+    if (Worker_running()) {
+        flush_started = read_cycle_counter();
+        Worker_flushRender(flush_keep_alive);
+        run_timers();
+    }
+}
+
+/**
+ * Function: flush_keep_alive
+ * Description: Feeds the watchdog while flush_render waits, from the timer read directly so a
+ *              replay sees the same inputs however long the wait. A worker that stops drawing
+ *              is only covered for EVENT_LOOP_TIMEOUT_TICKS, then the watchdog resets the board.
+ * Input(s): None
+ * Return: void
+ */
+void flush_keep_alive() {
+    if (read_cycle_counter() - flush_started < EVENT_LOOP_TIMEOUT_TICKS * TIMER_TICK_PERIOD) {
+        Hal_feedWatchdog();
+    }
+}
+
+/**
+ * Function: countdown_tick
+ * Description: Timer callback that counts the question countdown down by one second
+ * Input(s): void* arg - pointer to the countdown value
+ * Return: void
+ */
+void countdown_tick(void* arg) {
+    unsigned int* countdown_value = (unsigned int*)arg;
+    if (*countdown_value > 0) {
+        *countdown_value -= 1;
+        Hal_sevenSegSetDoubleDec(DOUBLE_DEC_DISPLAY_LOCATION, *countdown_value);
+    }
 }
 
 /**
@@ -448,66 +963,54 @@ void check_timer(PTimerCtx_t* timerCtx) {
  * Input(s): None
  * Return: void
  */
-void evaluate_answer(PLT24Ctx_t lt24) {
+void evaluate_answer() {
     int user_answer = questions[difficulty][current_question].user_answer;
     int correct_answer = (difficulty == EASY) ? questions[difficulty][current_question].correct_choice : questions[difficulty][current_question].answer;
-    printf("User answer: %d, Correct answer: %d\n", user_answer, correct_answer);
+    LOG_INFO("User answer: %d, Correct answer: %d\n", user_answer, correct_answer);
 
-    if(user_answer == 10) {
+    // Wrong, timed out or slow answers are asked again in practice mode
+    Practice_record(difficulty, questions[difficulty][current_question].id, user_answer == correct_answer,
+                    questions[difficulty][current_question].response_ticks > PRACTICE_SLOW_TICKS);
+    uint32_t points = Scoring_record(&score_session, difficulty, user_answer == correct_answer,
+                                     questions[difficulty][current_question].response_us,
+                                     game_config.countdown_seconds * 1000000u);
+
+    if(user_answer == NO_ANSWER) {
     	return;
     }
-    ShowAnswer(difficulty, current_question, user_answer, correct_answer, lt24);
+    ShowAnswer(difficulty, current_question, user_answer, correct_answer);
     if (user_answer == correct_answer) {
         score++;
-        printf("Correct! Score: %d\n", score);
+        LOG_INFO("Correct! Score: %d, +%lu points in %lu ms (%lu points)\n", score, (unsigned long)points,
+                 (unsigned long)(questions[difficulty][current_question].response_us / 1000), (unsigned long)score_session.points);
         //printf("Playing audio\n");
         //play_sound (welcome_buffer, welcome_size ); // Say the application
-        DE1SoC_SevenSeg_SetSingle(2,score);
+        Hal_sevenSegSetSingle(2,score);
         play_sound (correct_answer_buffer, correct_answer_size );
     } else {
     	play_sound (wrong_answer_buffer, wrong_answer_size );
-        printf("Incorrect. The correct answer is: %d\n", correct_answer);
+        LOG_INFO("Incorrect. The correct answer is: %d\n", correct_answer);
     }
 }
 
-/**
- * Function: process_switch_input
- * Description: Processes the input from slide switches
- * Input(s): int switch_inp - input from the switches
- * Return: int - processed value
- */
-int process_switch_input(int switch_inp)
-{
-	int val = -1;
-	for(int i =0; i<10;i++)
-	{
-		int ans = pow(2,i);
-		if((pow(2,i))==switch_inp)
-		{
-			val = i;
-			break;
-		}
-	}
-
-	return val;
-}
-
 /**
  * Function: ask_continue
  * Description: Asks the user if they want to continue playing after a level is complete
  * Input(s): None
  * Return: void
  */
-void ask_continue(PLT24Ctx_t lt24) {
+void ask_continue() {
 
     printf("Continue playing? Press KEY3 to continue or KEY1 to end.\n");
-    ShowScreen(CONTPLAY, lt24);
+    ShowScreen(CONTPLAY);
    //score = 0;
-    	 DE1SoC_SevenSeg_SetSingle(2,score);
+    	 Hal_sevenSegSetSingle(2,score);
     while (1) {
 
+    	poll_timers();
+
     	int keys = read_push_buttons();
-    	HPS_ResetWatchdog();  // Reset the watchdog timer.
+    	Supervisor_checkIn(SUPERVISOR_EVENT_LOOP); // Heartbeat, the supervisor feeds the watchdog
 
     	// If key3 pressed continue
         if (keys & 0x08) {
@@ -520,6 +1023,7 @@ void ask_continue(PLT24Ctx_t lt24) {
             game_state = END;
             break;
         }
+        idle_wait(); // Sleep until a key press or the next timer deadline
     }
 
 }
@@ -530,20 +1034,48 @@ void ask_continue(PLT24Ctx_t lt24) {
  * Input(s): None
  * Return: void
  */
-void display_game_over(PLT24Ctx_t lt24) {
+void display_game_over() {
+	int place = -1;
 
-	ShowScreen(END_SCREEN, lt24);
+	ShowScreen(END_SCREEN);
+	// The session goes to the SD card in one write while the game over screen is up
+	if (score_session.answered > 0) {
+		place = SessionLog_append(&score_session, (uint8_t)game_mode, (uint8_t)difficulty, timer_ticks / TIMER_TICKS_PER_SECOND);
+	}
 	// Continue only if Key0 is pressed
 	while(1) {
+		poll_timers();
 		int keys = read_push_buttons();
-		HPS_ResetWatchdog();  // Reset the watchdog timer.
+		Supervisor_checkIn(SUPERVISOR_EVENT_LOOP); // Heartbeat, the supervisor feeds the watchdog
 		if (keys & 0x01) {
 			break;
 		}
+		idle_wait(); // Sleep until a key press or the next timer deadline
 	}
 
 	printf("Game Over\n");
     printf("Final Score: %d\n", score);
+    if (place >= 0) {
+        printf("New high score! Number %d in the table\n", place + 1);
+    }
+    TimerWheel_report(&game_timers);
+    Tickless_report(timer_ticks, TIMER_TICKS_PER_SECOND);
+    Supervisor_report();
+    QuestionBank_report(&question_bank);
+    QuestionScheduler_report();
+    Practice_report();
+    Scoring_report(&score_session);
+    SessionLog_report();
+    Replay_report();
+    Profile_report();
+    Memory_report();
+    AssetPack_report();
+    printf("Formulas: %u answers checked, %u questions rejected\n", formulas_checked, formulas_rejected);
+    printf("Log: %lu messages, at most %lu of %d waiting\n", (unsigned long)Log_stats()->written,
+           (unsigned long)Log_stats()->high_water, LOG_RING_SIZE);
+    if (game_config.trace_export) {
+        Trace_exportJson(EVENT_TRACE_FILE); // The events leading up to this game over
+    }
 }
 
 /**
@@ -555,25 +1087,63 @@ void display_game_over(PLT24Ctx_t lt24) {
 void update_game_state(unsigned char Timeout) {
 
 	current_question++;
+	session_questions_asked++;
 
 	// Continue to next question if key0 is pressed
 	if(Timeout != 1) {
+		// Keys are levels, and with the worker playing the feedback sound the KEY0 press that
+		// confirmed the answer may still be held here, so act on a new press only
+		int held = read_push_buttons();
 		while(1) {
 
+			poll_timers();
+
 			int keys = read_push_buttons();
-			HPS_ResetWatchdog();  // Reset the watchdog timer.
+			int pressed = keys & ~held;
+			held = keys;
+			Supervisor_checkIn(SUPERVISOR_EVENT_LOOP); // Heartbeat, the supervisor feeds the watchdog
 
-			if (keys & 0x01) {
+			if (pressed & 0x01) {
 				break;
 			}
+			idle_wait(); // Sleep until a key press or the next timer deadline
 		}
 	}
 
-    if (current_question >= MAX_QUESTIONS_PER_LEVEL) {
+    if (game_config.session_questions && session_questions_asked >= game_config.session_questions) {
+        game_state = END;  // Session length reached.
+    } else if (current_question >= questions_in_level) {
         game_state = ASK_CONTINUE;
     }
 }
 
+/**
+ * Function: show_answer_preview
+ * Description: Shows the answer being entered on HEX0-HEX3
+ * Input(s): const AnswerEntry* entry
+ * Return: void
+ */
+void show_answer_preview(const AnswerEntry* entry) {
+    uint8_t segments[ANSWER_ENTRY_DISPLAYS];
+    AnswerEntry_preview(entry, segments);
+    for (int i = 0; i < ANSWER_ENTRY_DISPLAYS; i++) {
+        Hal_sevenSegWrite(i, segments[i]);
+    }
+}
+
+/**
+ * Function: show_score
+ * Description: Puts the score back on the seven-segment display after an answer preview
+ * Input(s): None
+ * Return: void
+ */
+void show_score() {
+    for (int i = 0; i < ANSWER_ENTRY_DISPLAYS; i++) {
+        Hal_sevenSegWrite(i, 0);
+    }
+    Hal_sevenSegSetSingle(2, score);
+}
+
 /**
  * Function: handle_user_input
  * Description: Handles user input for answering questions
@@ -581,235 +1151,430 @@ void update_game_state(unsigned char Timeout) {
  * Return: void
  */
 unsigned char handle_user_input() {
+	PROFILE_SCOPE("handle_user_input");
+	TRACE_SCOPE("handle_user_input");
 
-	unsigned int CountdownTimer = 20;
-	DE1SoC_SevenSeg_SetDoubleDec(DOUBLE_DEC_DISPLAY_LOCATION,CountdownTimer);
+	unsigned int CountdownTimer = game_config.countdown_seconds;
+	Hal_sevenSegSetDoubleDec(DOUBLE_DEC_DISPLAY_LOCATION,CountdownTimer);
 	unsigned char Timeout = 0;
-	unsigned int StartTimerValue = *private_timer_value;
-	unsigned int CurrentTimerValue;
+
+	// Count the answer window down once per second on the timer wheel
+	poll_timers();
+	uint32_t start_ticks = timer_ticks;
+	TimerWheel_start(&game_timers, &countdown_timer, TIMER_TICKS_PER_SECOND, TIMER_TICKS_PER_SECOND, countdown_tick, &CountdownTimer);
 
 	if (difficulty == EASY) {
+        int held = read_push_buttons(); // Keys are levels, act on new presses only
         while (1) {
-        	CurrentTimerValue = *private_timer_value;
-        	if (*private_timer_interrupt & 0x1) {
-        		// If the timer interrupt flag is set, clear the flag
-        		*private_timer_interrupt = 0x1;
-        	}
+        	poll_timers();
 
         	int keys = read_push_buttons();
-            HPS_ResetWatchdog();  // Reset the watchdog timer.
-            if (keys & 0x01) {
+        	int pressed = keys & ~held;
+        	held = keys;
+            Supervisor_checkIn(SUPERVISOR_EVENT_LOOP); // Heartbeat, the supervisor feeds the watchdog
+            if (pressed & 0x01) {
                 questions[difficulty][current_question].user_answer = 0;
                 break;
-            } else if (keys & 0x02) {
+            } else if (pressed & 0x02) {
                 questions[difficulty][current_question].user_answer = 1;
                 break;
-            } else if (keys & 0x04) {
+            } else if (pressed & 0x04) {
                 questions[difficulty][current_question].user_answer = 2;
                 break;
-            } else if (keys & 0x08) {
+            } else if (pressed & 0x08) {
                 questions[difficulty][current_question].user_answer = 3;
                 break;
             }
 
-            if(StartTimerValue - CurrentTimerValue >= CountPeriod) {
-            	StartTimerValue = *private_timer_value;
-            	CountdownTimer -= 1;
-            	DE1SoC_SevenSeg_SetDoubleDec(DOUBLE_DEC_DISPLAY_LOCATION,CountdownTimer);
-            	if(CountdownTimer == 0) {
-            		questions[difficulty][current_question].user_answer = 10; // 10 means no answer
-            		Timeout = 1;
-            		break;
-            	}
-
+            if(CountdownTimer == 0) {
+            	questions[difficulty][current_question].user_answer = NO_ANSWER;
+            	Timeout = 1;
+            	break;
             }
-
-
+            idle_wait(); // Sleep until a key press or the next countdown second
         }
     } else {
+		AnswerEntry entry;
+		int held = read_push_buttons(); // Keys are levels, act on new presses only
+
+		AnswerEntry_begin(&entry, (AnswerEntryMode)game_config.answer_entry);
 		while(1)
 		{
-			HPS_ResetWatchdog();  // Reset the watchdog timer.
+			poll_timers();
+			Supervisor_checkIn(SUPERVISOR_EVENT_LOOP); // Heartbeat, the supervisor feeds the watchdog
 
-			if (*private_timer_interrupt & 0x1) {
-				// If the timer interrupt flag is set, clear the flag
-				*private_timer_interrupt = 0x1;
+			int keys = read_push_buttons();
+			int pressed = keys & ~held;
+			held = keys;
+
+			bool confirmed = AnswerEntry_update(&entry, pressed, read_slide_switches());
+			show_answer_preview(&entry);
+			if (confirmed) {
+				LOG_INFO("Answer entered : %d\n", entry.value);
+				questions[difficulty][current_question].user_answer = entry.value;
+				break;
+			}
+			if (pressed & 0x01) {
+				LOG_INFO("That answer cannot be entered, try again!\n");
 			}
-
-
-			 while (!(read_push_buttons() & 0x01)) {
-				 CurrentTimerValue = *private_timer_value;
-				if (*private_timer_interrupt & 0x1) {
-					// If the timer interrupt flag is set, clear the flag
-					*private_timer_interrupt = 0x1;
-				}
-
-
-				 HPS_ResetWatchdog();  // Reset the watchdog timer.
-
-				 if(StartTimerValue - CurrentTimerValue >= CountPeriod) {
-					StartTimerValue = *private_timer_value;
-					CountdownTimer -= 1;
-
-					DE1SoC_SevenSeg_SetDoubleDec(DOUBLE_DEC_DISPLAY_LOCATION,CountdownTimer);
-
-					if(CountdownTimer == 0) {
-						Timeout = 1;
-						break;
-					}
-				 }
-			 }
 
 			if(CountdownTimer == 0) {
-				DE1SoC_SevenSeg_SetDoubleDec(DOUBLE_DEC_DISPLAY_LOCATION,CountdownTimer);
-				questions[difficulty][current_question].user_answer = 10; // 10 means no answer
+				Hal_sevenSegSetDoubleDec(DOUBLE_DEC_DISPLAY_LOCATION,CountdownTimer);
+				questions[difficulty][current_question].user_answer = NO_ANSWER;
 				Timeout = 1;
 				break;
 			}
-
-			int switch_inp = read_slide_switches();
-			int answer = process_switch_input(switch_inp);
-
-			if(!(answer>=0 && answer<10))
-			{
-				printf("Please enter just a single digit value through switch, Try again !\n");
-			}
-			else
-			{
-				printf("Switch input noted : %d",answer);
-				questions[difficulty][current_question].user_answer = answer;
-				break;
-			}
+			idle_wait(); // Sleep until a key press or the next countdown second
 		}
+		show_score();
     }
 
+	// Sampled once the loop has seen the key, so the poll itself does no timing work
+	uint32_t answered_us = read_time_us();
+	TimerWheel_cancel(&game_timers, &countdown_timer);
+	questions[difficulty][current_question].response_ticks = timer_ticks - start_ticks;
+	questions[difficulty][current_question].response_us = Timeout ? game_config.countdown_seconds * 1000000u
+	                                                               : answered_us - question_shown_us;
 	return Timeout;
 }
 
+/**
+ * Function: read_blitz_answer
+ * Description: Waits for a fresh key press that answers the current blitz question
+ * Input(s): const unsigned int* remaining - seconds left, counted down by the timer wheel
+ * Return: int - the answer (choice index for Easy, the entered number otherwise), NO_ANSWER when time runs out
+ */
+int read_blitz_answer(const unsigned int* remaining) {
+    // Keys are levels, so only a press that was not already held when the question appeared counts
+    int held = read_push_buttons();
+    AnswerEntry entry;
+
+    AnswerEntry_begin(&entry, (AnswerEntryMode)game_config.answer_entry);
+    while (*remaining > 0) {
+        poll_timers();
+        Supervisor_checkIn(SUPERVISOR_EVENT_LOOP); // Heartbeat, the supervisor feeds the watchdog
+        int keys = read_push_buttons();
+        int pressed = keys & ~held;
+        held = keys;
+
+        if (difficulty == EASY) {
+            for (int choice = 0; choice < 4; choice++) {
+                if (pressed & (1 << choice)) return choice;
+            }
+        } else {
+            bool confirmed = AnswerEntry_update(&entry, pressed, read_slide_switches());
+            show_answer_preview(&entry);
+            if (confirmed) {
+                show_score();
+                return entry.value;
+            }
+        }
+        idle_wait(); // Sleep until a key press or the next countdown second
+    }
+    if (difficulty != EASY) show_score();
+    return NO_ANSWER;
+}
+
+/**
+ * Function: play_blitz
+ * Description: Blitz mode. Questions follow each other with no confirmation step until the
+ *              window closes; the score is the number answered correctly. The next question is
+ *              prepared while the player thinks, and the time from answer to next question drawn
+ *              is recorded and checked against one LCD frame.
+ * Input(s): None
+ * Return: void
+ */
+void play_blitz() {
+    unsigned int remaining = BLITZ_SECONDS;
+    unsigned int slots = (game_config.questions_per_level[difficulty] > 1) ? game_config.questions_per_level[difficulty] : 2;
+    unsigned int slot = 0;
+    uint32_t transition_start = 0;
+    bool timing = false;
+
+    LatencyHistogram_initialise(&blitz_transitions, BLITZ_BUCKET_US);
+    score = 0;
+    current_question = 0;
+    next_question(difficulty, &questions[difficulty][0]);
+
+    Hal_sevenSegSetSingle(2, score);
+    Hal_sevenSegSetDoubleDec(DOUBLE_DEC_DISPLAY_LOCATION, remaining);
+    poll_timers();
+    TimerWheel_start(&game_timers, &countdown_timer, TIMER_TICKS_PER_SECOND, TIMER_TICKS_PER_SECOND, countdown_tick, &remaining);
+
+    while (remaining > 0) {
+        MathQuestion* question = &questions[difficulty][slot];
+
+        // No UART output in here: printing a question costs several milliseconds
+        ShowQuestion(difficulty, question);
+        flush_render(); // The transition ends when the question is on the screen, not when the last sound has played
+        if (timing) {
+            LatencyHistogram_add(&blitz_transitions, (uint32_t)((uint64_t)(Hal_cycles() - transition_start) * 1000000u / HAL_CYCLE_HZ));
+        }
+        question_shown_us = read_time_us();
+
+        // Prepare the next question now, so an SD read or generation never delays the transition
+        unsigned int next_slot = (slot + 1) % slots;
+        next_question(difficulty, &questions[difficulty][next_slot]);
+
+        int answer = read_blitz_answer(&remaining);
+        transition_start = Hal_cycles(); // Real time: the host's virtual timer does not advance while drawing
+        timing = true;
+        if (answer == NO_ANSWER) break;
+
+        int correct_answer = (difficulty == EASY) ? question->correct_choice : question->answer;
+        question->user_answer = answer;
+        question->response_us = read_time_us() - question_shown_us;
+        session_questions_asked++;
+        Practice_record(difficulty, question->id, answer == correct_answer, false);
+        Scoring_record(&score_session, difficulty, answer == correct_answer, question->response_us,
+                       game_config.countdown_seconds * 1000000u);
+        if (answer == correct_answer) {
+            score++;
+            Hal_sevenSegSetSingle(2, score);
+        }
+        // Feedback sounds only when the worker plays them in the background, and only once the
+        // last one has finished: quick answers would queue sounds up until play_sound blocked
+        if (Worker_running() && !worker_sound_busy()) {
+            play_sound(answer == correct_answer ? correct_answer_buffer : wrong_answer_buffer,
+                       answer == correct_answer ? correct_answer_size : wrong_answer_size);
+        }
+
+        slot = next_slot;
+    }
+
+    TimerWheel_cancel(&game_timers, &countdown_timer);
+    printf("Blitz over: %d correct in %d seconds, %lu points\n", score, BLITZ_SECONDS, (unsigned long)score_session.points);
+    if (!LatencyHistogram_report(&blitz_transitions, "Blitz transition", BLITZ_TRANSITION_BUDGET_US) && BLITZ_BENCHMARK) {
+        printf("Blitz transitions over budget, exiting\n");
+        exit(1);
+    }
+    game_state = END;
+}
+
 /**
  * Function: select_difficulty
  * Description: Allows user to select the difficulty level at the start of the game
  * Input(s): None
  * Return: void
  */
-void select_difficulty(PLT24Ctx_t lt24) {
+void select_difficulty() {
 
-    ShowScreen(LEVEL_SCREEN, lt24); // Show select difficulty screen
+    ShowScreen(LEVEL_SCREEN); // Show select difficulty screen
+    if (game_mode != GAME_BLITZ) {
+        ShowText("KEY3: practise mistakes", 51, 285, 1, 0x0000, 0xFFFF);
+    }
+    int held = read_push_buttons(); // KEY3 may still be down from the start menu
 	while (1) {
+        poll_timers();
         int keys = read_push_buttons();
-        HPS_ResetWatchdog();  // Reset the watchdog timer.
+        int pressed = keys & ~held;
+        held = keys;
+        Supervisor_checkIn(SUPERVISOR_EVENT_LOOP); // Heartbeat, the supervisor feeds the watchdog
         if (keys & 0x01) {
             difficulty = EASY;
+            if (game_mode == GAME_PRACTICE) game_mode = GAME_NORMAL;
             break;
         } else if (keys & 0x02) {
             difficulty = MEDIUM;
+            if (game_mode == GAME_PRACTICE) game_mode = GAME_NORMAL;
             break;
         } else if (keys & 0x04) {
             difficulty = HARD;
+            if (game_mode == GAME_PRACTICE) game_mode = GAME_NORMAL;
             break;
+        } else if ((pressed & 0x08) && game_mode != GAME_BLITZ) {
+            // A new KEY3 press practises earlier mistakes, if there are any; blitz keeps its mode
+            if (Practice_pending()) {
+                game_mode = GAME_PRACTICE;
+                break;
+            }
+            printf("Nothing to practise yet.\n");
+            ShowText("Nothing to practise yet", 51, 300, 1, 0x0000, 0xFFFF);
         }
-
+        idle_wait(); // Sleep until a key press or the next timer deadline
     }
     game_state = IN_PROGRESS;  // Transition to start showing questions.
 }
 
+/**
+ * Function: show_start_screen
+ * Description: Draws the start screen and its blitz hint
+ * Input(s): None
+ * Return: void
+ */
+void show_start_screen() {
+	ShowScreen(START_SCREEN);
+	ShowText("KEY2: blitz, 60 seconds", 51, 305, 1, 0x0000, 0xFFFF);
+}
+
 /**
  * Function: start_menu
  * Description: Displays the start menu to allow user to start or quit the game
  * Input(s): None
  * Return: void
  */
-void start_menu(PLT24Ctx_t lt24) {
+void start_menu() {
 
-	ShowScreen(START_SCREEN, lt24); // 1 - Show start screen
+	if (!start_screen_shown) {
+		show_start_screen(); // 1 - Show start screen
+	}
+	start_screen_shown = false; // The next screen draws over it
 
-	DE1SoC_SevenSeg_SetSingle(2,0); // Initialise HEX0 display with 0 for score
+	Hal_sevenSegSetSingle(2,0); // Initialise HEX0 display with 0 for score
 
 	while (1) {
+        poll_timers();
         int keys = read_push_buttons();
-        HPS_ResetWatchdog();  // Reset the watchdog timer.
+        Supervisor_checkIn(SUPERVISOR_EVENT_LOOP); // Heartbeat, the supervisor feeds the watchdog
         if (keys) {  // Wait until any key is pressed.
             if (keys & 0x08) {
+                seed_questions();  // The moment of the key press seeds the questions
+                game_mode = GAME_NORMAL;
                 game_state = MENU;  // If KEY3, proceed to the menu.
                 break;
+            } else if (keys & 0x04) {
+                seed_questions();
+                game_mode = GAME_BLITZ;
+                game_state = MENU;  // If KEY2, blitz: pick a difficulty, then answer against the clock.
+                break;
             } else if (keys & 0x02) {
                 game_state = QUIT;  // If KEY1, quit the game.
                 break;
             }
         }
+        idle_wait(); // Sleep until a key press or the next timer deadline
     }
 }
 
 
 
 int main(void) {
-	//Initialise Timer Driver and generate questions
-    PTimerCtx_t timerCtx;
-	initialisetimer_timer(&timerCtx);
-	audio_initialise(); // Initialise audio
-	HPS_ResetWatchdog(); // Reset watchdog
+	//Initialise the timer and LCD and show the start screen, then the audio codec, the audio files and the questions
+	Hal_initialise();
+	Boot_start();
+	Memory_initialise();
+	mount_sd_card();
+#if ASSETS_FROM_PACK
+	AssetPack_open(ASSET_PACK_FILE); // Only the index, the start screen is its first image read
+	Boot_stage("asset pack");
+#endif
+#if BOOT_LCD_FIRST
+	show_start_screen();
+	start_screen_shown = true;
+	Boot_firstPixel();
+#endif
+	Hal_audioInitialise();
+	Boot_stage("audio codec");
+	Hal_feedWatchdog(); // Reset watchdog
+#if LOG_BENCHMARK
+	Log_benchmark(LOG_RING_SIZE);
+#endif
 	audio_files_init();
-	HPS_ResetWatchdog();
-
-    generate_questions();  // Pre-generate questions for all levels.
-
-    // Variables
-	PLT24Ctx_t lt24;
-
-	*private_timer_load      = 0xFFFFFFFF;
-	*private_timer_control   = (0 << 8) | (0 << 2) | (1 << 1) | (1 << 0);
-
-	if (*private_timer_interrupt & 0x1) {
-		// If the timer interrupt flag is set, clear the flag
-		*private_timer_interrupt = 0x1;
+#if !BOOT_LCD_FIRST
+	while (audio_loading()) {
+		audio_load_step();
+		Hal_feedWatchdog();
 	}
-
-	DE1SoC_SevenSeg_SetDoubleDec(DOUBLE_DEC_DISPLAY_LOCATION,countdown);
-
-	// Initialise the LCD Display.
-	exitOnFail(
-			LT24_initialise(LSC_BASE_GPIO_JP1,LSC_BASE_LT24HWDATA, &lt24), //Initialise LCD
-			ERR_SUCCESS);                                                  //Exit if not successful
-
+#endif
+	Boot_stage("sd card");
+	Hal_feedWatchdog();
+	Config_defaults(&game_config);
+	Config_load(&game_config, CONFIG_FILE); // Defaults are kept if there is no config file
+	Config_report(&game_config);
+	start_input_trace(); // Before the first timer read, so a replay sees every input
+	initialise_question_storage();
+	Boot_stage("config");
+
+	initialise_timer_wheel(); // Software timers run off the free running private timer
+	seed_questions();
+	initialise_question_schedule();
+	Practice_load(PRACTICE_FILE); // Starts empty if there is no saved history
+	SessionLog_open(SESSION_LOG_FILE, HIGH_SCORE_FILE); // Recovers from a torn write at the last game over
+	Supervisor_initialise(&game_timers, SUPERVISOR_PERIOD_TICKS, Hal_feedWatchdog); // Supervisor owns the watchdog from here
+	Supervisor_begin(SUPERVISOR_EVENT_LOOP, EVENT_LOOP_TIMEOUT_TICKS);
+	Boot_stage("history");
+
+	Hal_sevenSegSetDoubleDec(DOUBLE_DEC_DISPLAY_LOCATION,countdown);
+
+#if RENDER_WORKER
+	start_worker(); // LCD and audio are only driven from core 1 from here on
+	Boot_stage("worker");
+#endif
+#if !BOOT_LCD_FIRST
+	show_start_screen();
+	flush_render(); // Drawn, not just queued
+	start_screen_shown = true;
+	Boot_firstPixel();
+#endif
+	Boot_report();
+
+	    GameState traced_state = QUIT; // Forces the first state onto the trace
 	    while (1) {
-	        //check_timer(&timerCtx);  // Continuously check the timer in the main loop.
+	        Hal_gameState(game_state); // Lets a host simulation count games and spot a stuck state
+	        if (game_state != traced_state) {
+	            TRACE_COUNTER("game_state", game_state);
+	            traced_state = game_state;
+	        }
 
 	        switch (game_state) {
 	            case START_MENU:
-	                start_menu(lt24);  // Handle start menu options.
+	                start_menu();  // Handle start menu options.
 	                break;
 	            case MENU:
 	                printf("Welcome to the Math Game!\n");
 	                game_state = SELECT_DIFFICULTY;  // Move to select difficulty.
 	                break;
 	            case SELECT_DIFFICULTY:
-	                select_difficulty(lt24);  // Select the game difficulty.
+	                select_difficulty();  // Select the game difficulty.
+	                if (game_mode == GAME_BLITZ) {
+	                    play_blitz();  // Runs the whole timed window, then ends the game.
+	                } else if (game_mode == GAME_PRACTICE) {
+	                    select_practice_questions();  // Questions due for review, of any difficulty.
+	                    if (questions_in_level == 0) {
+	                        game_state = SELECT_DIFFICULTY;  // None of them could be loaded, choose again.
+	                    }
+	                } else {
+	                    generate_questions(difficulty);  // New questions for every level played.
+	                }
 	                reset_timer();  // Reset the timer at the start of each level.
 	                break;
 	            case IN_PROGRESS:
-	                if (current_question < MAX_QUESTIONS_PER_LEVEL) {
-	                    display_question(lt24);  // Display the current question.
+	                if (current_question < questions_in_level) {
+	                    if (game_mode == GAME_PRACTICE) {
+	                        difficulty = practice_levels[current_question];
+	                    }
+	                    display_question();  // Display the current question.
 	                    unsigned char Timeout = handle_user_input();  // Handle user input for the question.
-	                    evaluate_answer(lt24);  // Check the answer.
+	                    evaluate_answer();  // Check the answer.
 	                    update_game_state(Timeout);  // Decide next step.
 	                }
 	                break;
 	            case ASK_CONTINUE:
-	                ask_continue(lt24);  // Ask if player wants to continue.
+	                ask_continue();  // Ask if player wants to continue.
 	                break;
 	            case END:
-	                display_game_over(lt24);  // Show game over screen.
+	                display_game_over();  // Show game over screen.
+	                if (question_bank.open) {
+	                    QuestionScheduler_save(QUESTION_SCHEDULE_FILE);  // Remember which questions were seen.
+	                }
+	                Practice_save(PRACTICE_FILE);  // Remember what needs practice.
+	                Replay_flush();  // The recorded session survives a power cut.
 	                game_state = START_MENU;  // Reset to start menu after game over.
 	                score = 0;  // Reset the score.
+	                Scoring_reset(&score_session);
+	                current_question = 0;
+	                session_questions_asked = 0;
 	                break;
 	            case QUIT:
 	                printf("Exiting the game.\n");
+	                Replay_flush();
 	                return 0;  // Exit game loop and end program.
 	            default:
 	                printf("Unhandled game state.\n");
 	                break;
 	        }
-	        HPS_ResetWatchdog();  // Reset the watchdog timer.
+	        Log_drain(); // Nothing is left waiting when a state changes
+	        Supervisor_checkIn(SUPERVISOR_EVENT_LOOP); // Heartbeat, the supervisor feeds the watchdog
 	    }
 	    return 0;
 }
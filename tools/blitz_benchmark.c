@@ -0,0 +1,92 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Host benchmark for blitz transitions. It writes an input script that starts blitz and
+ * answers at a steady pace for the whole minute, then runs the host build on it. The game
+ * must be built with BLITZ_BENCHMARK=1, so it exits with status 1 when the p99 time from an
+ * answer to the next question drawn is over one LCD frame. That time is wall clock time, so
+ * it counts the host's drawing and question work. Build with RENDER_WORKER=1 too
+ * to time the worker path, where each answer also queues a feedback sound. Build and run
+ * on a PC:
+ *
+ *     gcc -O2 -o blitz_benchmark blitz_benchmark.c
+ *     ./blitz_benchmark ./math_game [-p <ms between answers>]
+ *
+ * The SD card image is found as for any host run (HAL_SD_IMAGE, sd.img by default). Prints
+ * the game's blitz lines and exits non-zero if the budget was missed, the run failed, or no
+ * blitz was played.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+
+#define SCRIPT_FILE   "blitz_benchmark.script"
+#define BLITZ_MS      60000
+#define PACE_MS       300     // Default time between answers
+#define TIMEOUT_S     300     // Wall time the run may take
+
+/*
+ * Function: write_script
+ * Description: Writes the input script: start blitz, answer every pace_ms, then quit
+ */
+static int write_script(unsigned int pace_ms) {
+    FILE* script = fopen(SCRIPT_FILE, "w");
+    if (!script) return -1;
+
+    fprintf(script, "# Written by blitz_benchmark\n");
+    fprintf(script, "500 press 2\n");                 // KEY2 starts blitz; still held, it picks the level
+    for (unsigned int elapsed = 0; elapsed < BLITZ_MS + 2000; elapsed += pace_ms) {
+        fprintf(script, "+%u press 0\n", pace_ms);     // KEY0 answers, or confirms the switches
+    }
+    fprintf(script, "+3000 press 1\n+1000 quit\n");
+    return fclose(script);
+}
+
+int main(int argc, char** argv) {
+    unsigned int pace_ms = PACE_MS;
+    char command[512];
+    char line[512];
+    int blitz_played = 0;
+    int status;
+    FILE* game;
+
+    if (argc == 4 && strcmp(argv[2], "-p") == 0) pace_ms = (unsigned int)strtoul(argv[3], 0, 10);
+    if ((argc != 2 && argc != 4) || pace_ms == 0) {
+        fprintf(stderr, "usage: %s ./math_game [-p <ms between answers>]\n", argv[0]);
+        return 2;
+    }
+    if (write_script(pace_ms) != 0) {
+        perror(SCRIPT_FILE);
+        return 2;
+    }
+
+    setenv("HAL_INPUT", SCRIPT_FILE, 1);
+    unsetenv("HAL_RANDOM_SEED");
+    snprintf(command, sizeof(command), "timeout %d '%s'", TIMEOUT_S, argv[1]);
+    game = popen(command, "r");
+    if (!game) {
+        perror(argv[1]);
+        return 2;
+    }
+    while (fgets(line, sizeof(line), game)) {
+        if (strncmp(line, "Blitz", 5) == 0) {
+            fputs(line, stdout);
+            if (strncmp(line, "Blitz transition:", 17) == 0 && !strstr(line, "no samples")) blitz_played = 1;
+        }
+    }
+    status = pclose(game);
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        printf("FAIL: the game exited with status %d\n", WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+        return 1;
+    }
+    if (!blitz_played) {
+        printf("FAIL: no blitz transitions were timed\n");
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
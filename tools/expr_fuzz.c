@@ -0,0 +1,517 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Host fuzz test and benchmark for Expr.c. Three passes:
+ *
+ *   - Random bytes, half of them drawn from the formula alphabet, are compiled. Whatever
+ *     compiles is evaluated in integer and fixed point at random x. The compiled program
+ *     must stay within its limits, and nothing may crash (build with sanitizers to catch
+ *     out of bounds accesses and undefined behaviour).
+ *   - Random formula trees (every operator, unary signs, implicit multiplication, d(),
+ *     equations, stray spaces) are printed, compiled and evaluated. The result is compared
+ *     with a reference evaluator that walks the tree with the same dual number rules. It
+ *     must give the same status and value. When the integer value is exact, fixed point
+ *     must give the same value scaled, or overflow.
+ *   - A throughput loop compiles and evaluates formulas like the generated questions'.
+ *
+ * Build and run on a PC:
+ *
+ *     gcc -O2 -I.. -o expr_fuzz expr_fuzz.c ../Expr.c
+ *     gcc -O1 -g -fsanitize=address,undefined -I.. -o expr_fuzz expr_fuzz.c ../Expr.c
+ *     ./expr_fuzz [iterations] [seed]
+ *
+ * Prints compiles and evaluations per second, and exits non-zero on any mismatch or
+ * broken limit.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../Expr.h"
+
+#define FUZZ_ITERATIONS   1000000u
+#define FUZZ_MAX_BYTES    48
+#define TREE_MAX_NODES    64
+#define TREE_MAX_DEPTH    5
+#define TEXT_SIZE         512
+#define BENCHMARK_EVALS   10000000u
+
+typedef enum {
+    NODE_CONST, NODE_X, NODE_NEG, NODE_PLUS, NODE_ADD, NODE_SUB, NODE_MUL, NODE_DIV, NODE_MOD, NODE_POW, NODE_DERIV
+} NodeType;
+
+typedef struct {
+    uint8_t type;            // NodeType
+    uint8_t implicit;        // NODE_MUL written as 3x or 3(...)
+    int16_t left, right;     // Child nodes, the point of NODE_DERIV on the right
+    int32_t value;           // NODE_CONST
+} Node;
+
+typedef struct {
+    int64_t value;
+    int64_t slope;
+} Dual;
+
+static Node nodes[TREE_MAX_NODES];
+static int node_count;
+static uint64_t rng_state;
+static unsigned long failures;
+static unsigned long compiled, too_complex, evaluated, errors_matched;
+
+/*
+ * Function: now_ns
+ * Description: Monotonic time in nanoseconds
+ */
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * Function: next_random
+ * Description: xorshift64* random numbers
+ */
+static uint32_t next_random(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (uint32_t)((rng_state * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+static uint32_t below(uint32_t bound) {
+    return (uint32_t)(((uint64_t)next_random() * bound) >> 32);
+}
+
+/*
+ * Function: fail
+ * Description: Counts a failure, printing the first few
+ */
+static void fail(const char* text, const char* reason) {
+    if (failures++ < 10) printf("  \"%s\": %s\n", text, reason);
+}
+
+/*
+ * Function: check_program
+ * Description: Checks a compiled program stays within the limits the evaluator relies on
+ */
+static void check_program(const char* text, const ExprProgram* program) {
+    if (program->length > EXPR_MAX_CODE || program->max_stack > EXPR_MAX_STACK ||
+        program->constant_count > EXPR_MAX_CONSTANTS || program->length == 0) {
+        fail(text, "program outside its limits");
+        return;
+    }
+    for (int i = 0; i < program->length; i++) {
+        if (program->code[i] == 0) {                 // OP_CONST and its pool index
+            if (++i >= program->length || program->code[i] >= program->constant_count) {
+                fail(text, "constant index outside the pool");
+                return;
+            }
+        }
+    }
+}
+
+/*
+ * Function: random_x
+ * Description: An x to evaluate at, mostly small, sometimes near the limits
+ */
+static int64_t random_x(void) {
+    switch (below(8)) {
+        case 0: return (int64_t)next_random() << 16;
+        case 1: return -(int64_t)next_random();
+        default: return (int64_t)below(41) - 20;
+    }
+}
+
+/*
+ * Function: fuzz_bytes
+ * Description: Compiles random bytes and evaluates whatever compiles
+ */
+static void fuzz_bytes(void) {
+    static const char alphabet[] = "0123456789x+-*/%^()=d, ";
+    char text[FUZZ_MAX_BYTES + 1];
+    unsigned int length = below(FUZZ_MAX_BYTES + 1);
+    bool formula_like = below(2);
+    ExprProgram program;
+    int position = -1;
+    int64_t result;
+    bool correct;
+
+    for (unsigned int i = 0; i < length; i++) {
+        text[i] = formula_like ? alphabet[below(sizeof(alphabet) - 1)] : (char)(1 + below(255));
+    }
+    text[length] = '\0';
+
+    ExprStatus status = Expr_compile(text, &program, &position);
+    if (position < 0 || position > (int)length) fail(text, "error position outside the text");
+    if (status != EXPR_OK) return;
+    compiled++;
+    check_program(text, &program);
+
+    int64_t x = random_x();
+    Expr_evalInt(&program, x, &result);
+    Expr_evalFixed(&program, x, &result);
+    Expr_verify(&program, (int32_t)next_random(), &correct);
+    evaluated += 3;
+}
+
+/*
+ * Function: new_node
+ * Description: Random formula tree. x may appear anywhere in an equation, otherwise only inside d().
+ */
+static int new_node(int depth, bool in_derivative, bool allow_x) {
+    int index;
+    Node* node;
+
+    if (node_count >= TREE_MAX_NODES) return -1;
+    index = node_count++;
+    node = &nodes[index];
+    memset(node, 0, sizeof(*node));
+
+    if (depth == 0 || below(4) == 0) {
+        if ((allow_x || in_derivative) && below(3) == 0) {
+            node->type = NODE_X;
+        } else {
+            node->type = NODE_CONST;
+            switch (below(10)) {
+                case 0: node->value = (int32_t)below(100000); break;
+                case 1: node->value = INT32_MAX; break;
+                default: node->value = (int32_t)below(13); break;
+            }
+        }
+        return index;
+    }
+
+    switch (below(12)) {
+        case 0: node->type = NODE_NEG; break;
+        case 1: node->type = NODE_PLUS; break;
+        case 2: node->type = NODE_ADD; break;
+        case 3: node->type = NODE_SUB; break;
+        case 4: case 5: node->type = NODE_MUL; break;
+        case 6: node->type = NODE_DIV; break;
+        case 7: node->type = NODE_MOD; break;
+        case 8: case 9: node->type = NODE_POW; break;
+        case 10: node->type = in_derivative ? NODE_MUL : NODE_DERIV; break;
+        default: node->type = NODE_MUL; node->implicit = 1; break;
+    }
+
+    if (node->type == NODE_DERIV) {
+        node->left = (int16_t)new_node(depth - 1, true, allow_x);
+        node->right = (int16_t)new_node(depth - 1, false, allow_x);
+    } else if (node->implicit) {
+        // 3x or 3(...): a number then x or a bracket
+        int number = new_node(0, false, false);
+        if (number >= 0) {
+            nodes[number].type = NODE_CONST;
+            nodes[number].value = (int32_t)below(13);
+        }
+        node->left = (int16_t)number;
+        node->right = (int16_t)new_node(depth - 1, in_derivative, allow_x);
+    } else if (node->type == NODE_POW && below(4) != 0) {
+        // Mostly small literal exponents, so powers are worth evaluating
+        node->left = (int16_t)new_node(depth - 1, in_derivative, allow_x);
+        node->right = (int16_t)new_node(0, false, false);
+        if (node->right >= 0) {
+            nodes[node->right].type = NODE_CONST;
+            nodes[node->right].value = (int32_t)below(6);
+        }
+    } else {
+        node->left = (int16_t)new_node(depth - 1, in_derivative, allow_x);
+        node->right = (node->type == NODE_NEG || node->type == NODE_PLUS) ? -1
+                                                                         : (int16_t)new_node(depth - 1, in_derivative, allow_x);
+    }
+    if (node->left < 0 || (node->right < 0 && node->type != NODE_NEG && node->type != NODE_PLUS)) return -1;
+    return index;
+}
+
+/*
+ * Function: print_node
+ * Description: Writes a tree as formula text, fully bracketed, with stray spaces
+ */
+static char* print_node(char* out, char* end, int index) {
+    static const char* const operators[] = { 0, 0, 0, 0, "+", "-", "*", "/", "%", "^" };
+    const Node* node = &nodes[index];
+    char number[16];
+
+    if (end - out < 40) return end;   // Too long: the caller sees a full buffer
+    if (below(8) == 0) *out++ = ' ';
+
+    switch (node->type) {
+    case NODE_CONST:
+        snprintf(number, sizeof(number), "%ld", (long)node->value);
+        for (const char* c = number; *c; c++) *out++ = *c;
+        return out;
+    case NODE_X:
+        *out++ = 'x';
+        return out;
+    case NODE_NEG:
+    case NODE_PLUS:
+        *out++ = '(';
+        *out++ = (node->type == NODE_NEG) ? '-' : '+';
+        *out++ = '(';
+        out = print_node(out, end, node->left);
+        if (end - out < 4) return end;
+        *out++ = ')';
+        *out++ = ')';
+        return out;
+    case NODE_DERIV:
+        *out++ = 'd';
+        *out++ = '(';
+        out = print_node(out, end, node->left);
+        if (end - out < 4) return end;
+        *out++ = ',';
+        out = print_node(out, end, node->right);
+        if (end - out < 4) return end;
+        *out++ = ')';
+        return out;
+    default:
+        *out++ = '(';
+        if (node->type == NODE_POW) *out++ = '(';
+        out = print_node(out, end, node->left);
+        if (end - out < 8) return end;
+        if (node->type == NODE_POW) *out++ = ')';
+        if (node->implicit && nodes[node->right].type == NODE_X) {
+            *out++ = 'x';                       // 3x
+        } else {
+            if (!node->implicit) *out++ = operators[node->type][0];
+            if (below(8) == 0) *out++ = ' ';
+            *out++ = '(';                       // 3(...), or a bracketed right operand
+            out = print_node(out, end, node->right);
+            if (end - out < 4) return end;
+            *out++ = ')';
+        }
+        *out++ = ')';
+        return out;
+    }
+}
+
+/*
+ * Reference evaluator: the tree walked directly, with the evaluator's rules for each operator
+ */
+static ExprStatus ref_divide(int64_t a, int64_t b, int64_t* result) {
+    if (b == 0) return EXPR_DIV_ZERO;
+    if (b == -1 && a == INT64_MIN) return EXPR_OVERFLOW;
+    if (a % b != 0) return EXPR_INEXACT;
+    *result = a / b;
+    return EXPR_OK;
+}
+
+static ExprStatus ref_eval(int index, int64_t x, int64_t x_slope, Dual* out) {
+    const Node* node = &nodes[index];
+    Dual a, b;
+    ExprStatus status;
+    int64_t t1, t2;
+
+    switch (node->type) {
+    case NODE_CONST: out->value = node->value; out->slope = 0; return EXPR_OK;
+    case NODE_X: out->value = x; out->slope = x_slope; return EXPR_OK;
+    case NODE_DERIV:
+        // The point is evaluated first, then the expression with x carrying a slope of one
+        if ((status = ref_eval(node->right, x, x_slope, &b)) != EXPR_OK) return status;
+        if ((status = ref_eval(node->left, b.value, 1, &a)) != EXPR_OK) return status;
+        out->value = a.slope;
+        out->slope = 0;
+        return EXPR_OK;
+    default:
+        break;
+    }
+
+    if ((status = ref_eval(node->left, x, x_slope, &a)) != EXPR_OK) return status;
+    if (node->type == NODE_PLUS) {
+        *out = a;
+        return EXPR_OK;
+    }
+    if (node->type == NODE_NEG) {
+        if (__builtin_sub_overflow((int64_t)0, a.value, &out->value) ||
+            __builtin_sub_overflow((int64_t)0, a.slope, &out->slope)) return EXPR_OVERFLOW;
+        return EXPR_OK;
+    }
+    if ((status = ref_eval(node->right, x, x_slope, &b)) != EXPR_OK) return status;
+
+    switch (node->type) {
+    case NODE_ADD:
+        if (__builtin_add_overflow(a.value, b.value, &out->value) ||
+            __builtin_add_overflow(a.slope, b.slope, &out->slope)) return EXPR_OVERFLOW;
+        return EXPR_OK;
+    case NODE_SUB:
+        if (__builtin_sub_overflow(a.value, b.value, &out->value) ||
+            __builtin_sub_overflow(a.slope, b.slope, &out->slope)) return EXPR_OVERFLOW;
+        return EXPR_OK;
+    case NODE_MUL:
+        if (__builtin_mul_overflow(a.slope, b.value, &t1) || __builtin_mul_overflow(a.value, b.slope, &t2) ||
+            __builtin_mul_overflow(a.value, b.value, &out->value) ||
+            __builtin_add_overflow(t1, t2, &out->slope)) return EXPR_OVERFLOW;
+        return EXPR_OK;
+    case NODE_DIV:
+        if ((status = ref_divide(a.value, b.value, &out->value)) != EXPR_OK) return status;
+        if (__builtin_mul_overflow(out->value, b.slope, &t1) || __builtin_sub_overflow(a.slope, t1, &t2)) return EXPR_OVERFLOW;
+        return ref_divide(t2, b.value, &out->slope);
+    case NODE_MOD:
+        if (a.slope || b.slope) return EXPR_DOMAIN;
+        if (b.value == 0) return EXPR_DIV_ZERO;
+        out->value = (b.value == -1) ? 0 : a.value % b.value;
+        out->slope = a.slope;
+        return EXPR_OK;
+    case NODE_POW: {
+        int64_t value = 1, before = 0;
+        if (b.slope != 0 || b.value < 0 || b.value > EXPR_MAX_POWER) return EXPR_DOMAIN;
+        for (int64_t i = 0; i < b.value; i++) {
+            before = value;
+            if (__builtin_mul_overflow(value, a.value, &value)) return EXPR_OVERFLOW;
+        }
+        if (b.value > 0 && (__builtin_mul_overflow(before, a.slope, &before) ||
+                            __builtin_mul_overflow(before, b.value, &before))) return EXPR_OVERFLOW;
+        out->value = value;
+        out->slope = (b.value > 0) ? before : 0;
+        return EXPR_OK;
+    }
+    default:
+        return EXPR_SYNTAX;
+    }
+}
+
+/*
+ * Function: fuzz_grammar
+ * Description: Compiles a random formula tree and checks both evaluations against the reference
+ */
+static void fuzz_grammar(void) {
+    char text[TEXT_SIZE];
+    char* out = text;
+    char* end = text + sizeof(text) - 1;
+    bool equation = below(2);
+    int lhs, rhs = -1;
+    ExprProgram program;
+    Dual left, right;
+    int64_t expected = 0, result = 0, x = (int64_t)below(41) - 20;
+    ExprStatus reference, status;
+    char reason[96];
+
+    node_count = 0;
+    lhs = new_node(TREE_MAX_DEPTH, false, equation);
+    if (equation) rhs = new_node(TREE_MAX_DEPTH - 2, false, true);
+    if (lhs < 0 || (equation && rhs < 0)) return;
+
+    out = print_node(out, end, lhs);
+    if (equation && out < end - 2) {
+        *out++ = '=';
+        out = print_node(out, end, rhs);
+    }
+    if (out >= end) return;       // Tree too big to print
+    *out = '\0';
+
+    status = Expr_compile(text, &program, 0);
+    if (status == EXPR_TOO_COMPLEX) {
+        too_complex++;
+        return;
+    }
+    if (status != EXPR_OK) {
+        fail(text, Expr_statusText(status));
+        return;
+    }
+    compiled++;
+    check_program(text, &program);
+
+    reference = ref_eval(lhs, x, 0, &left);
+    if (reference == EXPR_OK && equation) {
+        reference = ref_eval(rhs, x, 0, &right);
+        if (reference == EXPR_OK && __builtin_sub_overflow(left.value, right.value, &left.value)) reference = EXPR_OVERFLOW;
+        // The evaluator subtracts the slopes too
+        if (reference == EXPR_OK && __builtin_sub_overflow(left.slope, right.slope, &left.slope)) reference = EXPR_OVERFLOW;
+    }
+    expected = left.value;
+
+    status = Expr_evalInt(&program, x, &result);
+    evaluated++;
+    if (status != reference) {
+        snprintf(reason, sizeof(reason), "x = %ld: %s, the reference gives %s", (long)x,
+                 Expr_statusText(status), Expr_statusText(reference));
+        fail(text, reason);
+        return;
+    }
+    if (status != EXPR_OK) {
+        errors_matched++;
+        return;
+    }
+    if (result != expected) {
+        snprintf(reason, sizeof(reason), "x = %ld: %ld, the reference gives %ld", (long)x, (long)result, (long)expected);
+        fail(text, reason);
+        return;
+    }
+
+    // Every division was exact, so fixed point must agree or overflow on the scaling
+    status = Expr_evalFixed(&program, x * EXPR_FIXED_ONE, &result);
+    evaluated++;
+    if (status == EXPR_OK && (__int128)result != (__int128)expected * EXPR_FIXED_ONE) {
+        snprintf(reason, sizeof(reason), "x = %ld: fixed point %ld, expected %ld", (long)x, (long)result, (long)expected);
+        fail(text, reason);
+    } else if (status != EXPR_OK && status != EXPR_OVERFLOW) {
+        snprintf(reason, sizeof(reason), "x = %ld: fixed point %s", (long)x, Expr_statusText(status));
+        fail(text, reason);
+    }
+}
+
+/*
+ * Function: benchmark
+ * Description: Compiles and evaluates formulas in the forms the question generator writes
+ */
+static void benchmark(void) {
+    static const char* const formulas[] = { "37+24", "9*7", "4x-3=13", "2*3+5", "7^5%10", "d(3x^2,2)", "(5x+1)/2=8" };
+    const unsigned int formula_count = sizeof(formulas) / sizeof(formulas[0]);
+    ExprProgram programs[sizeof(formulas) / sizeof(formulas[0])];
+    volatile int64_t sink = 0;
+    int64_t result = 0;
+    uint64_t start;
+    double seconds;
+
+    start = now_ns();
+    for (unsigned int i = 0; i < BENCHMARK_EVALS / 10; i++) {
+        Expr_compile(formulas[i % formula_count], &programs[i % formula_count], 0);
+    }
+    seconds = (now_ns() - start) / 1e9;
+    printf("Compile: %.2f M formulas/s\n", BENCHMARK_EVALS / 10 / seconds / 1e6);
+
+    start = now_ns();
+    for (unsigned int i = 0; i < BENCHMARK_EVALS; i++) {
+        Expr_evalInt(&programs[i % formula_count], (int64_t)(i & 15), &result);
+        sink += result;
+    }
+    seconds = (now_ns() - start) / 1e9;
+    printf("Integer evaluation: %.2f M evaluations/s\n", BENCHMARK_EVALS / seconds / 1e6);
+
+    start = now_ns();
+    for (unsigned int i = 0; i < BENCHMARK_EVALS; i++) {
+        Expr_evalFixed(&programs[i % formula_count], (int64_t)(i & 15) * EXPR_FIXED_ONE, &result);
+        sink += result;
+    }
+    seconds = (now_ns() - start) / 1e9;
+    printf("Fixed point evaluation: %.2f M evaluations/s\n", BENCHMARK_EVALS / seconds / 1e6);
+    (void)sink;
+}
+
+int main(int argc, char** argv) {
+    uint32_t iterations = (argc > 1) ? (uint32_t)strtoul(argv[1], 0, 0) : FUZZ_ITERATIONS;
+    unsigned long byte_compiled, grammar_compiled;
+
+    rng_state = (argc > 2) ? strtoull(argv[2], 0, 0) : 0x9E3779B97F4A7C15ull;
+    if (iterations == 0 || rng_state == 0) {
+        fprintf(stderr, "usage: %s [iterations] [non-zero seed]\n", argv[0]);
+        return 2;
+    }
+
+    for (uint32_t i = 0; i < iterations; i++) fuzz_bytes();
+    byte_compiled = compiled;
+    printf("Random bytes: %lu inputs, %lu compiled\n", (unsigned long)iterations, byte_compiled);
+
+    compiled = 0;
+    for (uint32_t i = 0; i < iterations; i++) fuzz_grammar();
+    grammar_compiled = compiled;
+    printf("Formula trees: %lu compiled, %lu too complex, %lu with a matching error\n",
+           grammar_compiled, too_complex, errors_matched);
+
+    benchmark();
+    printf("%s: %lu failures, %lu evaluations checked\n", failures ? "FAILED" : "OK", failures, evaluated);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,268 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Host tool that builds the SD card asset pack (assets.pak) from the image sources the
+ * game otherwise links in. Build and run on a PC:
+ *
+ *     gcc -O2 -I.. -o make_asset_pack make_asset_pack.c ../Images.c ../EasyQues.c ../MedQues.c \
+ *         ../HardQues.c ../Answers.c ../Crc32.c ../PixelLz.c
+ *     ./make_asset_pack [-r] assets.pak
+ *
+ * Every image in ASSET_LIST (AssetPack.h) is PixelLz compressed, or kept as raw RGB565
+ * pixels if that is no smaller or -r is given. Each compressed image is decoded again
+ * and compared before the pack is written. The compression ratio of each image and the
+ * decoder's speed on this machine are printed.
+ *
+ * Each image starts on a 512 byte boundary, so FatFS can read whole sectors straight
+ * into the game's cache. Copy the pack to the SD card and build the game with
+ * ASSETS_FROM_PACK=1.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Only the file format is needed, not the FatFS reader
+#define ASSETPACK_FORMAT_ONLY
+#include "../AssetPack.h"
+// The tool reads the linked-in arrays, even when the game's build flags ask for the pack
+#undef ASSETS_FROM_PACK
+#define ASSETS_FROM_PACK 0
+#include "../Images.h"
+#include "../Crc32.h"
+#include "../PixelLz.h"
+
+#define SECTOR_SIZE 512
+#define HASH_BITS 14
+#define MATCH_TRIES 64          // Earlier positions compared per pixel
+#define DECODE_CHUNK 256        // Pixels per PixelLz_read, as the game draws them
+#define BENCHMARK_SECONDS 0.5
+
+typedef struct {
+    const char* name;
+    const unsigned short* pixels;
+    size_t size;
+    unsigned int width;
+    unsigned int height;
+} AssetSource;
+
+#define ASSET_SOURCE(name, width, height) { #name, name, sizeof(name), width, height },
+static const AssetSource sources[ASSET_COUNT] = { ASSET_LIST(ASSET_SOURCE) };
+#undef ASSET_SOURCE
+
+// Data written for each image, compressed or raw
+static uint8_t* stored[ASSET_COUNT];
+
+/*
+ * Function: put_length
+ * Description: Writes the extension bytes of a length whose nibble is 15
+ */
+static uint8_t* put_length(uint8_t* out, uint32_t length) {
+    while (length >= 255) {
+        *out++ = 255;
+        length -= 255;
+    }
+    *out++ = (uint8_t)length;
+    return out;
+}
+
+/*
+ * Function: put_sequence
+ * Description: Writes one sequence; a match length of 0 ends the image after the literals
+ */
+static uint8_t* put_sequence(uint8_t* out, const unsigned short* literals, uint32_t count, uint32_t offset, uint32_t length) {
+    uint32_t code = length ? length - PIXELLZ_MIN_MATCH : 0;
+
+    *out++ = (uint8_t)(((count < 15) ? count : 15) << 4 | ((code < 15) ? code : 15));
+    if (count >= 15) out = put_length(out, count - 15);
+    for (uint32_t i = 0; i < count; i++) {
+        *out++ = (uint8_t)(literals[i] & 0xFF);
+        *out++ = (uint8_t)(literals[i] >> 8);
+    }
+    if (length) {
+        *out++ = (uint8_t)(offset & 0xFF);
+        *out++ = (uint8_t)(offset >> 8);
+        if (code >= 15) out = put_length(out, code - 15);
+    }
+    return out;
+}
+
+/*
+ * Function: compress
+ * Description: Greedy PixelLz compression, finding matches through hash chains of pixel pairs.
+ *              out must hold count * 3 bytes, more than the worst case.
+ */
+static size_t compress(const unsigned short* pixels, uint32_t count, uint8_t* out) {
+    static int32_t head[1 << HASH_BITS];
+    int32_t* chain = malloc(count * sizeof(int32_t));
+    uint8_t* start = out;
+    uint32_t anchor = 0, i = 0;
+
+    if (!chain) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    memset(head, 0xFF, sizeof(head));
+#define HASH(p) ((((uint32_t)(p)[0] << 16 | (p)[1]) * 2654435761u) >> (32 - HASH_BITS))
+    while (i + PIXELLZ_MIN_MATCH <= count) {
+        uint32_t best_length = 0, best_offset = 0, tries = 0;
+        uint32_t hash = HASH(pixels + i);
+
+        for (int32_t candidate = head[hash]; candidate >= 0 && i - (uint32_t)candidate <= PIXELLZ_WINDOW &&
+             tries < MATCH_TRIES; candidate = chain[candidate], tries++) {
+            uint32_t length = 0;
+            while (i + length < count && pixels[candidate + length] == pixels[i + length]) length++;
+            if (length > best_length) {
+                best_length = length;
+                best_offset = i - (uint32_t)candidate;
+                if (i + length == count) break;
+            }
+        }
+
+        if (best_length >= PIXELLZ_MIN_MATCH) {
+            out = put_sequence(out, pixels + anchor, i - anchor, best_offset, best_length);
+            for (uint32_t end = i + best_length; i < end; i++) {
+                if (i + 1 < count) {
+                    hash = HASH(pixels + i);
+                    chain[i] = head[hash];
+                    head[hash] = (int32_t)i;
+                }
+            }
+            anchor = i;
+        } else {
+            chain[i] = head[hash];
+            head[hash] = (int32_t)i;
+            i++;
+        }
+    }
+#undef HASH
+    if (anchor < count) out = put_sequence(out, pixels + anchor, count - anchor, 0, 0);
+    free(chain);
+    return (size_t)(out - start);
+}
+
+/*
+ * Function: decodes_to
+ * Description: Decodes a compressed image a chunk at a time and compares it with the source
+ */
+static int decodes_to(const uint8_t* data, size_t size, const unsigned short* pixels, uint32_t count) {
+    static PixelLzStream stream;
+    unsigned short chunk[DECODE_CHUNK];
+    uint32_t position = 0;
+    unsigned int n;
+
+    PixelLz_begin(&stream, data, size, count);
+    while ((n = PixelLz_read(&stream, chunk, DECODE_CHUNK)) > 0) {
+        if (memcmp(chunk, pixels + position, n * sizeof(unsigned short)) != 0) return 0;
+        position += n;
+    }
+    return position == count && !stream.error && stream.in == stream.end;
+}
+
+int main(int argc, char** argv) {
+    AssetPackHeader header;
+    AssetPackEntry index[ASSET_COUNT];
+    static const char padding[SECTOR_SIZE];
+    uint32_t offset = sizeof(header) + sizeof(index);
+    size_t raw_total = 0, stored_total = 0;
+    uint64_t compressed_pixels = 0;
+    int errors = 0;
+    int raw = (argc == 3 && strcmp(argv[1], "-r") == 0);
+    const char* path = argv[argc - 1];
+
+    if (argc != 2 + raw) {
+        fprintf(stderr, "usage: %s [-r] assets.pak\n", argv[0]);
+        return 1;
+    }
+
+    memset(index, 0, sizeof(index));
+    for (int i = 0; i < ASSET_COUNT; i++) {
+        if (sources[i].size != sources[i].width * sources[i].height * sizeof(unsigned short) ||
+            strlen(sources[i].name) >= ASSET_NAME_LENGTH) {
+            fprintf(stderr, "%s: %u bytes do not make a %u x %u image, or the name is too long\n",
+                    sources[i].name, (unsigned int)sources[i].size, sources[i].width, sources[i].height);
+            errors++;
+            continue;
+        }
+        uint32_t pixels = sources[i].width * sources[i].height;
+        size_t size = sources[i].size;
+        stored[i] = (uint8_t*)sources[i].pixels;
+        index[i].format = ASSET_FORMAT_RGB565;
+        if (!raw) {
+            uint8_t* data = malloc(pixels * 3);
+            size_t compressed = data ? compress(sources[i].pixels, pixels, data) : 0;
+            if (!data || !decodes_to(data, compressed, sources[i].pixels, pixels)) {
+                fprintf(stderr, "%s: compressed image does not decode to the original\n", sources[i].name);
+                errors++;
+            } else if (compressed < size) {
+                stored[i] = data;
+                size = compressed;
+                index[i].format = ASSET_FORMAT_PIXELLZ;
+                compressed_pixels += pixels;
+            }
+        }
+        printf("  %-16s %4u x %-4u %7u -> %7u bytes  %5.1f:1%s\n", sources[i].name, sources[i].width, sources[i].height,
+               (unsigned int)sources[i].size, (unsigned int)size, (double)sources[i].size / size,
+               index[i].format == ASSET_FORMAT_RGB565 ? "  (raw)" : "");
+        raw_total += sources[i].size;
+        stored_total += size;
+
+        offset = (offset + SECTOR_SIZE - 1) & ~(uint32_t)(SECTOR_SIZE - 1);
+        strncpy(index[i].name, sources[i].name, ASSET_NAME_LENGTH);
+        index[i].offset = offset;
+        index[i].size = (uint32_t)size;
+        index[i].width = (uint16_t)sources[i].width;
+        index[i].height = (uint16_t)sources[i].height;
+        offset += index[i].size;
+    }
+    if (errors) {
+        fprintf(stderr, "%d invalid images, no pack written\n", errors);
+        return 1;
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.magic = ASSET_PACK_MAGIC;
+    header.version = ASSET_PACK_VERSION;
+    header.count = ASSET_COUNT;
+    header.index_crc = Crc32_update(0, index, sizeof(index));
+
+    FILE* output = fopen(path, "wb");
+    if (!output) {
+        perror(path);
+        return 1;
+    }
+    fwrite(&header, sizeof(header), 1, output);
+    fwrite(index, sizeof(index), 1, output);
+    for (int i = 0; i < ASSET_COUNT; i++) {
+        fwrite(padding, 1, index[i].offset - (uint32_t)ftell(output), output);
+        fwrite(stored[i], 1, index[i].size, output);
+    }
+    if (fclose(output) != 0) {
+        perror(path);
+        return 1;
+    }
+
+    printf("%s: %d images, %u bytes, image data %u -> %u bytes (%.1f:1)\n", path, ASSET_COUNT, offset,
+           (unsigned int)raw_total, (unsigned int)stored_total, (double)raw_total / stored_total);
+
+    // Decoder speed on this machine, to compare with the LCD's pixel rate
+    if (compressed_pixels) {
+        static PixelLzStream stream;
+        unsigned short chunk[DECODE_CHUNK];
+        uint64_t decoded = 0;
+        clock_t start = clock();
+        double seconds;
+        do {
+            for (int i = 0; i < ASSET_COUNT; i++) {
+                if (index[i].format != ASSET_FORMAT_PIXELLZ) continue;
+                PixelLz_begin(&stream, stored[i], index[i].size, (uint32_t)index[i].width * index[i].height);
+                while (PixelLz_read(&stream, chunk, DECODE_CHUNK) > 0) { }
+                decoded += (uint64_t)index[i].width * index[i].height;
+            }
+            seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+        } while (seconds < BENCHMARK_SECONDS);
+        printf("Decoder: %.1f Mpixels/s in %u pixel chunks on this machine\n", decoded / seconds / 1e6, DECODE_CHUNK);
+    }
+    return 0;
+}
@@ -0,0 +1,232 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Host tool that builds the SD card question bank (questions.bin) from a tab separated
+ * text file. Build and run on a PC:
+ *
+ *     gcc -I.. -o make_question_bank make_question_bank.c ../Expr.c
+ *     ./make_question_bank questions.txt questions.bin
+ *
+ * One question per line, '#' starts a comment:
+ *
+ *     E <tab> What is 6 * 7? <tab> 42 <tab> 40 <tab> 48 <tab> 36 <tab> 0 <tab> 6*7
+ *     M <tab> Solve for x: 3x + 2 = 17 <tab> 5 <tab> 3x+2=17
+ *     H <tab> Derivative of x^3 at x = 2 <tab> ? <tab> d(x^3,2)
+ *     H <tab> Find x if 4x = 28 <tab> 7
+ *
+ * Easy lines give four choices and the index of the correct one; Medium and Hard lines
+ * give the numeric answer, -999 to 999. The game skips questions whose answer the
+ * configured answer entry cannot enter (only 0-9 with one switch per digit).
+ *
+ * The last field is an optional formula (see Expr.h). Answers are checked against it
+ * here and again by the game when the question is loaded. A Medium or Hard answer of ?
+ * is worked out from the formula; an equation must then have exactly one solution in
+ * the answer range.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Only the file format is needed, not the FatFS reader
+#define QUESTIONBANK_FORMAT_ONLY
+#include "../QuestionBank.h"
+#include "../AnswerEntry.h"
+#include "../Expr.h"
+
+typedef struct {
+    QuestionBankRecord* records;
+    uint32_t count;
+    uint32_t capacity;
+} RecordList;
+
+static int copy_field(char* out, size_t size, const char* field, int line) {
+    if (!field || strlen(field) >= size) {
+        fprintf(stderr, "line %d: field missing or longer than %u characters\n", line, (unsigned int)size - 1);
+        return 0;
+    }
+    strcpy(out, field);
+    return 1;
+}
+
+/*
+ * Function: formula_answer
+ * Description: Works out the answer of a formula: its value, or the one x in the answer
+ *              range that satisfies an equation
+ */
+static int formula_answer(const ExprProgram* program, int32_t* answer, int line) {
+    int solutions = 0;
+
+    for (int32_t candidate = ANSWER_ENTRY_MIN; candidate <= ANSWER_ENTRY_MAX; candidate++) {
+        bool correct = false;
+        Expr_verify(program, candidate, &correct);
+        if (correct) {
+            *answer = candidate;
+            solutions++;
+        }
+        if (!program->equation && solutions) break;
+    }
+    if (solutions != 1) {
+        fprintf(stderr, "line %d: formula has %d answers from %d to %d, need exactly one\n", line,
+                solutions, ANSWER_ENTRY_MIN, ANSWER_ENTRY_MAX);
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ * Function: check_formula
+ * Description: Compiles a formula field and checks the answer against it, filling the answer in if it is unknown
+ */
+static int check_formula(QuestionBankRecord* record, const char* formula, bool answer_known, int line) {
+    ExprProgram program;
+    ExprStatus status;
+    int position = 0;
+    bool correct = false;
+
+    if (!formula) {
+        if (answer_known) return 1;
+        fprintf(stderr, "line %d: an answer of ? needs a formula\n", line);
+        return 0;
+    }
+    if (!copy_field(record->formula, sizeof(record->formula), formula, line)) return 0;
+    status = Expr_compile(formula, &program, &position);
+    if (status != EXPR_OK) {
+        fprintf(stderr, "line %d: formula %s: %s at character %d\n", line, formula, Expr_statusText(status), position + 1);
+        return 0;
+    }
+    if (!answer_known) return formula_answer(&program, &record->answer, line);
+
+    status = Expr_verify(&program, record->answer, &correct);
+    if (status != EXPR_OK) {
+        fprintf(stderr, "line %d: formula %s: %s\n", line, formula, Expr_statusText(status));
+        return 0;
+    }
+    if (!correct) {
+        fprintf(stderr, "line %d: formula %s does not give answer %d\n", line, formula, (int)record->answer);
+        return 0;
+    }
+    return 1;
+}
+
+static int parse_line(char* text, int line, RecordList lists[DIFFICULTY_COUNT]) {
+    char* fields[8] = { 0 };
+    int count = 0;
+    char* newline = strpbrk(text, "\r\n");
+    QuestionBankRecord record;
+    int difficulty;
+
+    if (newline) *newline = '\0';
+    if (text[0] == '\0' || text[0] == '#') return 1;
+
+    for (char* field = strtok(text, "\t"); field && count < 8; field = strtok(NULL, "\t")) {
+        fields[count++] = field;
+    }
+
+    switch (fields[0][0]) {
+        case 'E': difficulty = EASY; break;
+        case 'M': difficulty = MEDIUM; break;
+        case 'H': difficulty = HARD; break;
+        default:
+            fprintf(stderr, "line %d: difficulty must be E, M or H\n", line);
+            return 0;
+    }
+
+    memset(&record, 0, sizeof(record));
+    if (!copy_field(record.question, sizeof(record.question), fields[1], line)) return 0;
+
+    if (difficulty == EASY) {
+        if (count != 7 && count != 8) {
+            fprintf(stderr, "line %d: easy questions need four choices and the correct index\n", line);
+            return 0;
+        }
+        for (int i = 0; i < 4; i++) {
+            if (!copy_field(record.choices[i], sizeof(record.choices[i]), fields[2 + i], line)) return 0;
+        }
+        record.correct_choice = (uint8_t)atoi(fields[6]);
+        if (record.correct_choice > 3) {
+            fprintf(stderr, "line %d: correct choice must be 0-3\n", line);
+            return 0;
+        }
+        record.answer = atoi(fields[2 + record.correct_choice]);
+        if (!check_formula(&record, fields[7], true, line)) return 0;
+    } else {
+        bool answer_known = strcmp(fields[2] ? fields[2] : "", "?") != 0;
+        if (count != 3 && count != 4) {
+            fprintf(stderr, "line %d: medium and hard questions need one answer\n", line);
+            return 0;
+        }
+        record.answer = answer_known ? atoi(fields[2]) : 0;
+        if (!check_formula(&record, fields[3], answer_known, line)) return 0;
+        if (record.answer < ANSWER_ENTRY_MIN || record.answer > ANSWER_ENTRY_MAX) {
+            fprintf(stderr, "line %d: answer must be %d to %d\n", line, ANSWER_ENTRY_MIN, ANSWER_ENTRY_MAX);
+            return 0;
+        }
+    }
+
+    RecordList* list = &lists[difficulty];
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 64;
+        list->records = realloc(list->records, list->capacity * sizeof(QuestionBankRecord));
+        if (!list->records) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+    list->records[list->count++] = record;
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    RecordList lists[DIFFICULTY_COUNT] = { { 0 } };
+    QuestionBankHeader header;
+    char text[512];
+    int line = 0;
+    int errors = 0;
+
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s questions.txt questions.bin\n", argv[0]);
+        return 1;
+    }
+
+    FILE* input = fopen(argv[1], "r");
+    if (!input) {
+        perror(argv[1]);
+        return 1;
+    }
+    while (fgets(text, sizeof(text), input)) {
+        errors += !parse_line(text, ++line, lists);
+    }
+    fclose(input);
+    if (errors) {
+        fprintf(stderr, "%d invalid lines, no bank written\n", errors);
+        return 1;
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.magic = QUESTION_BANK_MAGIC;
+    header.version = QUESTION_BANK_VERSION;
+    header.record_size = sizeof(QuestionBankRecord);
+    uint32_t offset = sizeof(header);
+    for (int i = 0; i < DIFFICULTY_COUNT; i++) {
+        header.count[i] = lists[i].count;
+        header.offset[i] = offset;
+        offset += lists[i].count * sizeof(QuestionBankRecord);
+    }
+
+    FILE* output = fopen(argv[2], "wb");
+    if (!output) {
+        perror(argv[2]);
+        return 1;
+    }
+    fwrite(&header, sizeof(header), 1, output);
+    for (int i = 0; i < DIFFICULTY_COUNT; i++) {
+        fwrite(lists[i].records, sizeof(QuestionBankRecord), lists[i].count, output);
+        free(lists[i].records);
+    }
+    fclose(output);
+
+    printf("%s: %u easy, %u medium, %u hard, %u bytes\n", argv[2],
+           header.count[EASY], header.count[MEDIUM], header.count[HARD], offset);
+    return 0;
+}
@@ -0,0 +1,136 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Host benchmark and check for QuestionGen.c. It generates questions for every difficulty
+ * from one seed and checks each one: the formula must compile and Expr_verify must agree
+ * with the answer, a Medium or Hard answer must lie in [0, max_answer], and an Easy
+ * question's correct choice must read as its answer. Each difficulty is run with the
+ * single switch answer limit and with the largest answer the entry modes accept. Build
+ * and run on a PC:
+ *
+ *     gcc -O2 -I.. -o questiongen_benchmark questiongen_benchmark.c ../QuestionGen.c ../Expr.c
+ *     ./questiongen_benchmark [questions per run]
+ *
+ * Prints questions per second for generation alone and for generation with the formula
+ * check, and exits non-zero if any question fails a check.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../QuestionGen.h"
+#include "../Expr.h"
+#include "../AnswerEntry.h"
+
+#define BENCHMARK_QUESTIONS 2000000u
+#define BENCHMARK_SEED      0x5EEDu
+
+static const char* const level_names[DIFFICULTY_COUNT] = { "easy", "medium", "hard" };
+static unsigned long failures;
+
+/*
+ * Function: now_ns
+ * Description: Monotonic time in nanoseconds
+ */
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * Function: fail
+ * Description: Counts a failed question, printing the first few
+ */
+static void fail(const MathQuestion* question, const char* reason) {
+    if (failures++ < 10) {
+        printf("  \"%s\" (formula %s, answer %d): %s\n", question->question, question->formula,
+               question->answer, reason);
+    }
+}
+
+/*
+ * Function: check_question
+ * Description: Checks one generated question against its formula and the answer limits
+ */
+static void check_question(const MathQuestion* question, Difficulty difficulty, int max_answer) {
+    ExprProgram program;
+    ExprStatus status;
+    bool correct = false;
+
+    status = Expr_compile(question->formula, &program, 0);
+    if (status == EXPR_OK) status = Expr_verify(&program, question->answer, &correct);
+    if (status != EXPR_OK) {
+        fail(question, Expr_statusText(status));
+    } else if (!correct) {
+        fail(question, "formula disagrees with the answer");
+    }
+
+    if (difficulty == EASY) {
+        if (question->correct_choice < 0 || question->correct_choice > 3 ||
+            atoi(question->choices[question->correct_choice]) != question->answer) {
+            fail(question, "correct choice is not the answer");
+        }
+    } else if (question->answer < 0 || question->answer > max_answer) {
+        fail(question, "answer cannot be entered");
+    }
+}
+
+/*
+ * Function: run
+ * Description: Times count questions of one difficulty, generated only and then generated and
+ *              checked. Returns the checked rate in questions per second.
+ */
+static double run(Difficulty difficulty, int max_answer, uint32_t count) {
+    QuestionRng rng;
+    MathQuestion question;
+    volatile int sink = 0;
+    uint64_t start;
+    double generate_s, check_s;
+
+    QuestionRng_seed(&rng, BENCHMARK_SEED);
+    start = now_ns();
+    for (uint32_t i = 0; i < count; i++) {
+        QuestionGen_generate(&rng, difficulty, max_answer, &question);
+        sink += question.answer; // Keeps the loop from being optimised away
+    }
+    generate_s = (now_ns() - start) / 1e9;
+
+    QuestionRng_seed(&rng, BENCHMARK_SEED);
+    start = now_ns();
+    for (uint32_t i = 0; i < count; i++) {
+        QuestionGen_generate(&rng, difficulty, max_answer, &question);
+        check_question(&question, difficulty, max_answer);
+    }
+    check_s = (now_ns() - start) / 1e9;
+
+    printf("%-6s max %3d: %6.2f M questions/s generated, %6.2f M/s generated and checked\n",
+           level_names[difficulty], max_answer, count / generate_s / 1e6, count / check_s / 1e6);
+    (void)sink;
+    return count / check_s;
+}
+
+int main(int argc, char** argv) {
+    static const int max_answers[2] = { QUESTION_SWITCH_MAX_ANSWER, ANSWER_ENTRY_MAX };
+    uint32_t count = (argc > 1) ? (uint32_t)strtoul(argv[1], 0, 0) : BENCHMARK_QUESTIONS;
+    double slowest = 0;
+
+    if (count == 0) {
+        fprintf(stderr, "usage: %s [questions per run]\n", argv[0]);
+        return 2;
+    }
+
+    for (int level = EASY; level <= HARD; level++) {
+        for (int i = 0; i < 2; i++) {
+            double rate = run((Difficulty)level, max_answers[i], count);
+            if (slowest == 0 || rate < slowest) slowest = rate;
+            if (level == EASY) break; // Easy answers do not depend on max_answer
+        }
+    }
+
+    printf("%s: %lu of %lu questions failed a check, slowest %.2f M questions/s checked\n",
+           failures ? "FAILED" : "OK", failures, (unsigned long)count * 5, slowest / 1e6);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,291 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Host tool that plays the game headless in bulk. It runs many instances of the Linux
+ * build (see Hal.h) in parallel, each with the random player on its own seed and virtual
+ * time, and reports games per second, games that got stuck in one state or stopped
+ * calling into the HAL, and peak memory growth between the first and last game of an
+ * instance. Build and run on a PC:
+ *
+ *     gcc -O2 -o simulate simulate.c
+ *     ./simulate ./math_game -g 10000 -j 8
+ *
+ * Options:
+ *     -g <games>     games to play in total (default 1000)
+ *     -n <games>     games per instance before it exits (default 100)
+ *     -j <jobs>      instances run at once (default: online CPUs)
+ *     -s <seed>      first random seed, instance i uses seed + i (default 1)
+ *     -t <seconds>   wall time an instance may take before it counts as hung (default 30)
+ *     -i <image>     SD card image copied for every job slot (default sd.img)
+ *     -w <dir>       directory for the job slots (default sim)
+ *
+ * Every job slot runs its instances in its own directory with its own copy of the SD
+ * card image, so parallel instances never share a file. An instance ends when it has
+ * played its games, or earlier when the random player quits from the start menu.
+ */
+
+#define _XOPEN_SOURCE 700
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#define MAX_JOBS 256
+#define REPORT_LENGTH 160
+#define PROBLEMS_SHOWN 10
+#define FAILURE_LIMIT 10  // Instances that crash or hang before the run gives up on the build
+
+typedef struct {
+    pid_t pid;                 // 0 when the slot is free
+    int report;                // Read end of the instance's report pipe
+    unsigned long seed;
+    char directory[256];
+} JobSlot;
+
+typedef struct {
+    unsigned long instances;
+    unsigned long games;
+    unsigned long state_changes;
+    unsigned long long virtual_ms;
+    unsigned long stuck;
+    unsigned long hung;
+    unsigned long failed;
+    long peak_rss_kb;
+    long worst_growth_kb;
+    unsigned long problems_shown;
+} SimTotals;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*
+ * Function: copy_file
+ * Description: Copies the SD card image into a job slot
+ */
+static int copy_file(const char* from, const char* to) {
+    char buffer[65536];
+    ssize_t length;
+    int in = open(from, O_RDONLY);
+    int out;
+
+    if (in < 0) return -1;
+    out = open(to, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0) {
+        close(in);
+        return -1;
+    }
+    while ((length = read(in, buffer, sizeof(buffer))) > 0) {
+        if (write(out, buffer, length) != length) {
+            length = -1;
+            break;
+        }
+    }
+    close(in);
+    return (close(out) == 0 && length == 0) ? 0 : -1;
+}
+
+/*
+ * Function: launch
+ * Description: Starts one instance in a job slot, with its report written to a pipe
+ */
+static int launch(JobSlot* slot, const char* game, unsigned long seed, unsigned int games, unsigned int timeout) {
+    int pipe_fds[2];
+    char value[32];
+
+    if (pipe(pipe_fds) != 0) return -1;
+    slot->seed = seed;
+    slot->pid = fork();
+    if (slot->pid < 0) {
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        slot->pid = 0;
+        return -1;
+    }
+    if (slot->pid == 0) {
+        int null_fd = open("/dev/null", O_WRONLY);
+        close(pipe_fds[0]);
+        if (chdir(slot->directory) != 0) _exit(126);
+        if (null_fd >= 0) {
+            dup2(null_fd, STDOUT_FILENO); // The game's UART output
+            close(null_fd);
+        }
+        snprintf(value, sizeof(value), "%lu", seed);
+        setenv("HAL_RANDOM_SEED", value, 1);
+        snprintf(value, sizeof(value), "%u", games);
+        setenv("HAL_GAMES", value, 1);
+        snprintf(value, sizeof(value), "%d", pipe_fds[1]);
+        setenv("HAL_REPORT_FD", value, 1);
+        setenv("HAL_SD_IMAGE", "sd.img", 1);
+        unsetenv("HAL_INPUT");
+        alarm(timeout); // Survives exec: an instance that stops calling the HAL is killed
+        execl(game, game, (char*)0);
+        _exit(127);
+    }
+    close(pipe_fds[1]);
+    slot->report = pipe_fds[0];
+    return 0;
+}
+
+static void problem(SimTotals* totals, const JobSlot* slot, const char* what) {
+    if (totals->problems_shown++ < PROBLEMS_SHOWN) {
+        printf("  seed %lu: %s\n", slot->seed, what);
+    }
+}
+
+/*
+ * Function: collect
+ * Description: Reads a finished instance's report and adds it to the totals
+ */
+static void collect(JobSlot* slot, int status, SimTotals* totals) {
+    char line[REPORT_LENGTH] = "";
+    char text[REPORT_LENGTH + 64];
+    ssize_t length = read(slot->report, line, sizeof(line) - 1);
+    unsigned int games = 0, changes = 0;
+    unsigned long long virtual_ms = 0;
+    long rss = 0, growth = 0;
+    int stuck = -1;
+    int fields;
+
+    close(slot->report);
+    slot->pid = 0;
+    totals->instances++;
+    if (length > 0) line[length] = '\0';
+    fields = sscanf(line, "games=%u changes=%u virtual_ms=%llu rss_kb=%ld growth_kb=%ld stuck=%d",
+                    &games, &changes, &virtual_ms, &rss, &growth, &stuck);
+
+    if (WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM) {
+        totals->hung++;
+        problem(totals, slot, "hung, no progress in wall time");
+        return;
+    }
+    if (fields != 6) {
+        totals->failed++;
+        snprintf(text, sizeof(text), "no report, %s %d", WIFSIGNALED(status) ? "signal" : "exit status",
+                 WIFSIGNALED(status) ? WTERMSIG(status) : WEXITSTATUS(status));
+        problem(totals, slot, text);
+        return;
+    }
+
+    totals->games += games;
+    totals->state_changes += changes;
+    totals->virtual_ms += virtual_ms;
+    if (rss > totals->peak_rss_kb) totals->peak_rss_kb = rss;
+    if (growth > totals->worst_growth_kb) totals->worst_growth_kb = growth;
+    if (stuck >= 0) {
+        totals->stuck++;
+        snprintf(text, sizeof(text), "stuck in state %d after %u games", stuck, games);
+        problem(totals, slot, text);
+    } else if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        totals->failed++;
+        snprintf(text, sizeof(text), "exit status %d after %u games", WIFEXITED(status) ? WEXITSTATUS(status) : -1, games);
+        problem(totals, slot, text);
+    }
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: simulate <game> [-g games] [-n games per instance] [-j jobs] [-s seed] [-t seconds] [-i image] [-w dir]\n");
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    static JobSlot slots[MAX_JOBS];
+    SimTotals totals = {0};
+    unsigned long target = 1000;
+    unsigned int per_instance = 100;
+    long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned long seed = 1;
+    unsigned int timeout = 30;
+    const char* image = "sd.img";
+    const char* work = "sim";
+    char game[4096];
+    unsigned int running = 0;
+    double start, elapsed;
+
+    if (argc < 2) usage();
+    if (!realpath(argv[1], game)) {
+        fprintf(stderr, "Cannot find %s\n", argv[1]);
+        return 1;
+    }
+    for (int i = 2; i < argc; i++) {
+        if (argv[i][0] != '-' || argv[i][2] != '\0' || i + 1 >= argc) usage();
+        const char* value = argv[++i];
+        switch (argv[i - 1][1]) {
+            case 'g': target = strtoul(value, 0, 0); break;
+            case 'n': per_instance = (unsigned int)strtoul(value, 0, 0); break;
+            case 'j': jobs = strtol(value, 0, 0); break;
+            case 's': seed = strtoul(value, 0, 0); break;
+            case 't': timeout = (unsigned int)strtoul(value, 0, 0); break;
+            case 'i': image = value; break;
+            case 'w': work = value; break;
+            default: usage();
+        }
+    }
+    if (jobs < 1) jobs = 1;
+    if (jobs > MAX_JOBS) jobs = MAX_JOBS;
+    if (per_instance == 0) per_instance = 1;
+
+    if (mkdir(work, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Cannot create %s\n", work);
+        return 1;
+    }
+    for (long j = 0; j < jobs; j++) {
+        char path[300];
+        snprintf(slots[j].directory, sizeof(slots[j].directory), "%s/slot%ld", work, j);
+        if (mkdir(slots[j].directory, 0755) != 0 && errno != EEXIST) {
+            fprintf(stderr, "Cannot create %s\n", slots[j].directory);
+            return 1;
+        }
+        snprintf(path, sizeof(path), "%s/sd.img", slots[j].directory);
+        if (copy_file(image, path) != 0) {
+            fprintf(stderr, "Cannot copy %s to %s\n", image, path);
+            return 1;
+        }
+    }
+
+    printf("Simulating %lu games, %u per instance, %ld at once\n", target, per_instance, jobs);
+    start = now_seconds();
+    while (running > 0 || totals.games < target) {
+        bool launching = totals.games < target && totals.failed + totals.hung < FAILURE_LIMIT;
+
+        // Keep every slot busy until enough games have been played
+        for (long j = 0; j < jobs && launching; j++) {
+            if (slots[j].pid != 0) continue;
+            if (launch(&slots[j], game, seed++, per_instance, timeout) != 0) {
+                fprintf(stderr, "Cannot start an instance\n");
+                return 1;
+            }
+            running++;
+        }
+        if (running == 0) break;
+
+        int status;
+        pid_t pid = wait(&status);
+        if (pid < 0) break;
+        for (long j = 0; j < jobs; j++) {
+            if (slots[j].pid == pid) {
+                collect(&slots[j], status, &totals);
+                running--;
+                break;
+            }
+        }
+    }
+    elapsed = now_seconds() - start;
+
+    printf("%lu games in %lu instances, %.2f s: %.0f games/s, %.0fx real time\n", totals.games, totals.instances,
+           elapsed, totals.games / elapsed, totals.virtual_ms / 1000.0 / elapsed);
+    printf("%lu state changes, %lu stuck, %lu hung, %lu failed\n", totals.state_changes, totals.stuck, totals.hung,
+           totals.failed);
+    printf("Peak RSS %ld kB, worst growth after the first game %ld kB\n", totals.peak_rss_kb, totals.worst_growth_kb);
+    return (totals.stuck || totals.hung || totals.failed) ? 1 : 0;
+}
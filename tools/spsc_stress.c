@@ -0,0 +1,185 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Host stress test and benchmark for SpscRing.h. A producer thread and a consumer thread
+ * pass numbered items through one ring, mixing single push/pop with batch calls of every
+ * size from 1 to SPSC_STRESS_BATCH so batches keep straddling the wrap point. The consumer
+ * checks that every item arrives once and in order. Two runs are made: one with bare items
+ * for throughput, and one with a timestamp in each item for push-to-pop latency. Build and
+ * run on a PC:
+ *
+ *     gcc -O2 -pthread -I.. -o spsc_stress spsc_stress.c
+ *     ./spsc_stress [items]
+ *
+ * Prints items per second and the p50/p99/max latency, and exits non-zero if any item was
+ * lost, repeated or out of order. A side that finds the ring full or empty yields, so the
+ * test also completes on a single core, where the figures mostly measure the scheduler.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include "../SpscRing.h"
+
+#define SPSC_STRESS_CAPACITY 1024
+#define SPSC_STRESS_BATCH    64
+#define SPSC_STRESS_ITEMS    20000000u
+#define LATENCY_SAMPLE_EVERY 16          // Items between latency samples
+
+typedef struct {
+    uint32_t sequence;
+    uint32_t reserved;
+    uint64_t pushed_ns;                  // 0 in the throughput run
+} StressItem;
+
+SPSC_RING_DECLARE(StressRing, StressItem, SPSC_STRESS_CAPACITY)
+
+static StressRing ring;
+static uint32_t item_count;
+static int timestamps;
+static uint32_t errors;
+static uint64_t* latencies;
+static uint32_t latency_count;
+
+/*
+ * Function: now_ns
+ * Description: Monotonic time in nanoseconds
+ */
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * Function: producer
+ * Description: Pushes item_count numbered items, alternating single pushes and batches
+ */
+static void* producer(void* arg) {
+    StressItem batch[SPSC_STRESS_BATCH];
+    uint32_t next = 0;
+    uint32_t size = 1;
+    (void)arg;
+
+    while (next < item_count) {
+        if (size & 1) {
+            StressItem item = { next, 0, timestamps ? now_ns() : 0 };
+            if (StressRing_push(&ring, &item)) next++;
+            else sched_yield();
+        } else {
+            uint32_t count = size;
+            uint32_t pushed;
+            if (count > item_count - next) count = item_count - next;
+            uint64_t stamp = timestamps ? now_ns() : 0;
+            for (uint32_t i = 0; i < count; i++) {
+                batch[i] = (StressItem){ next + i, 0, stamp };
+            }
+            // A partial batch is fine: the rest is rebuilt from next on the following pass
+            pushed = StressRing_pushBatch(&ring, batch, count);
+            next += pushed;
+            if (pushed == 0) sched_yield();
+        }
+        size = size % SPSC_STRESS_BATCH + 1;
+    }
+    return 0;
+}
+
+/*
+ * Function: check_item
+ * Description: Checks an item is the next one expected and samples its latency
+ */
+static void check_item(const StressItem* item, uint32_t expected) {
+    if (item->sequence != expected) {
+        if (errors++ < 10) printf("  expected item %u, got %u\n", expected, item->sequence);
+    }
+    if (item->pushed_ns && expected % LATENCY_SAMPLE_EVERY == 0) {
+        latencies[latency_count++] = now_ns() - item->pushed_ns;
+    }
+}
+
+/*
+ * Function: consumer
+ * Description: Pops item_count items, alternating single pops and batches of a different rhythm
+ */
+static void* consumer(void* arg) {
+    StressItem batch[SPSC_STRESS_BATCH];
+    uint32_t next = 0;
+    uint32_t size = 1;
+    (void)arg;
+
+    while (next < item_count) {
+        if (size % 3 == 0) {
+            StressItem item;
+            if (StressRing_pop(&ring, &item)) check_item(&item, next++);
+            else sched_yield();
+        } else {
+            uint32_t popped = StressRing_popBatch(&ring, batch, size);
+            for (uint32_t i = 0; i < popped; i++) check_item(&batch[i], next++);
+            if (popped == 0) sched_yield();
+        }
+        size = size % SPSC_STRESS_BATCH + 1;
+    }
+    return 0;
+}
+
+/*
+ * Function: compare_u64
+ * Description: qsort comparison for latency samples
+ */
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * Function: run
+ * Description: Runs the producer and consumer threads once, returns the seconds taken
+ */
+static double run(int with_timestamps) {
+    pthread_t threads[2];
+    uint64_t start;
+
+    StressRing_init(&ring);
+    timestamps = with_timestamps;
+    latency_count = 0;
+    start = now_ns();
+    if (pthread_create(&threads[0], 0, consumer, 0) != 0 || pthread_create(&threads[1], 0, producer, 0) != 0) {
+        perror("pthread_create");
+        exit(1);
+    }
+    pthread_join(threads[0], 0);
+    pthread_join(threads[1], 0);
+    return (now_ns() - start) / 1e9;
+}
+
+int main(int argc, char** argv) {
+    double seconds;
+
+    item_count = (argc > 1) ? (uint32_t)strtoul(argv[1], 0, 0) : SPSC_STRESS_ITEMS;
+    latencies = malloc((item_count / LATENCY_SAMPLE_EVERY + 1) * sizeof(uint64_t));
+    if (item_count == 0 || !latencies) {
+        fprintf(stderr, "usage: %s [items]\n", argv[0]);
+        return 1;
+    }
+
+    seconds = run(0);
+    printf("Throughput: %u items in %.3f s, %.1f M items/s (capacity %d, batches up to %d)\n",
+           item_count, seconds, item_count / seconds / 1e6, SPSC_STRESS_CAPACITY, SPSC_STRESS_BATCH);
+
+    run(1);
+    qsort(latencies, latency_count, sizeof(uint64_t), compare_u64);
+    if (latency_count) {
+        printf("Latency: p50 %llu ns, p99 %llu ns, max %llu ns (%u samples)\n",
+               (unsigned long long)latencies[latency_count / 2],
+               (unsigned long long)latencies[(uint64_t)latency_count * 99 / 100],
+               (unsigned long long)latencies[latency_count - 1], latency_count);
+    }
+
+    printf("%s: %u sequence errors over two runs\n", errors ? "FAILED" : "OK", errors);
+    free(latencies);
+    return errors ? 1 : 0;
+}
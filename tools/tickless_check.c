@@ -0,0 +1,123 @@
+/*
+ * Short Description
+ * ----------------------------------
+ * Host check that tickless idle wakes exactly on timer deadlines. It runs the game's idle
+ * loop (advance the wheel, dispatch, Tickless_idle) against a virtual clock: the sleep
+ * function jumps the clock by the ticks asked for, or by fewer to stand in for a key press
+ * waking the CPU early. Every timer callback must then run on the very tick it was due,
+ * never later, however far ahead it was and whatever the sleep cap. Build and run on a PC:
+ *
+ *     gcc -I.. -o tickless_check tickless_check.c ../Tickless.c ../TimerWheel.c
+ *     ./tickless_check
+ *
+ * Exits non-zero if any deadline is missed or overslept.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../TimerWheel.h"
+#include "../Tickless.h"
+
+#define CHECK_TIMERS 9
+#define PERIODIC_FIRES 10
+
+typedef struct {
+    TimerNode node;
+    uint32_t delay;
+    uint32_t period;
+    uint32_t expected;       // Tick of the next fire
+    uint32_t fires;
+    uint32_t late;           // Fires not on the expected tick
+} CheckTimer;
+
+static TimerWheel wheel;
+static CheckTimer timers[CHECK_TIMERS];
+static uint32_t virtual_now;
+static uint32_t sleep_calls;
+static uint32_t early_every;     // Wake every n-th sleep early, 0 for never
+
+// Deadlines from the next tick to beyond the outermost wheel used, cascade edges included
+static const uint32_t delays[CHECK_TIMERS] = { 1, 7, 255, 256, 257, 300, 5000, 16384, 70000 };
+
+/*
+ * Function: virtual_sleep
+ * Description: TicklessSleep on the virtual clock, now and then cut short as if by a key press
+ */
+static uint32_t virtual_sleep(uint32_t ticks) {
+    sleep_calls++;
+    if (early_every && sleep_calls % early_every == 0 && ticks > 1) ticks /= 2;
+    virtual_now += ticks;
+    return ticks;
+}
+
+/*
+ * Function: timer_fired
+ * Description: Timer callback, checks it runs on the tick it was due
+ */
+static void timer_fired(void* arg) {
+    CheckTimer* timer = (CheckTimer*)arg;
+
+    if (virtual_now != timer->expected) {
+        printf("  timer %lu due at %lu ran at %lu\n", (unsigned long)timer->delay,
+               (unsigned long)timer->expected, (unsigned long)virtual_now);
+        timer->late++;
+    }
+    timer->fires++;
+    timer->expected += timer->period;
+    if (timer->period && timer->fires == PERIODIC_FIRES) TimerWheel_cancel(&wheel, &timer->node);
+}
+
+/*
+ * Function: run
+ * Description: Runs the idle loop until every timer is done, returns the number of failures
+ */
+static int run(const char* name, uint32_t max_sleep, uint32_t early) {
+    uint32_t passes = 0;
+    int failures = 0;
+
+    virtual_now = 1000;
+    sleep_calls = 0;
+    early_every = early;
+    TimerWheel_initialise(&wheel, virtual_now, NULL);
+    Tickless_initialise(virtual_now);
+
+    for (int i = 0; i < CHECK_TIMERS; i++) {
+        CheckTimer* timer = &timers[i];
+        timer->delay = delays[i];
+        timer->period = (i == 0) ? 1000 : 0;    // One periodic timer, like the countdown
+        timer->expected = virtual_now + timer->delay;
+        timer->fires = 0;
+        timer->late = 0;
+        TimerWheel_start(&wheel, &timer->node, timer->delay, timer->period, timer_fired, timer);
+    }
+
+    // The idle loop of main.c: poll_timers, then idle_wait
+    while (passes++ < 1000000) {
+        TimerWheel_advance(&wheel, virtual_now);
+        TimerWheel_dispatch(&wheel);
+        if (wheel.count == 0) break;
+        Tickless_idle(&wheel, max_sleep, virtual_sleep);
+    }
+
+    for (int i = 0; i < CHECK_TIMERS; i++) {
+        uint32_t wanted = timers[i].period ? PERIODIC_FIRES : 1;
+        if (timers[i].fires != wanted || timers[i].late) {
+            printf("  timer %lu: %lu of %lu fires, %lu late\n", (unsigned long)timers[i].delay,
+                   (unsigned long)timers[i].fires, (unsigned long)wanted, (unsigned long)timers[i].late);
+            failures++;
+        }
+    }
+    printf("%-28s %s, %lu wake-ups over %lu ticks\n", name, failures ? "FAILED" : "all deadlines exact",
+           (unsigned long)Tickless_stats()->sleeps, (unsigned long)(virtual_now - 1000));
+    return failures;
+}
+
+int main(void) {
+    int failures = 0;
+
+    failures += run("uncapped sleeps", UINT32_MAX, 0);
+    failures += run("sleeps capped at 50 ticks", 50, 0);
+    failures += run("every 3rd sleep woken early", UINT32_MAX, 3);
+    return failures ? 1 : 0;
+}